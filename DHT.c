@@ -1,169 +1,713 @@
 #include "DHT.h"
+#include <string.h>
 
-#define lineDown() furi_hal_gpio_write(sensor->GPIO, false)
-#define lineUp() furi_hal_gpio_write(sensor->GPIO, true)
-#define getLine() furi_hal_gpio_read(sensor->GPIO)
+/* Всё обращение драйвера к железу собрано здесь. Сборка на компьютере (host/) этот блок
+ * не меняет: модель железа подставляет регистры портов, счётчик тактов и задержки */
+#define lineDown() (*sensor->line.bsrr = sensor->line.resetMask)
+#define lineUp() (*sensor->line.bsrr = sensor->line.setMask)
+#define lineSample(idr, mask) (*(idr) & (mask))
+#define portIDR(gpio) (&(gpio)->port->IDR)
+#define portBSRR(gpio) (&(gpio)->port->BSRR)
+#define lineInit(mode) furi_hal_gpio_init(sensor->GPIO, mode, GpioPullUp, GpioSpeedVeryHigh)
+#define lineAttach(callback, context) \
+    furi_hal_gpio_add_int_callback(sensor->GPIO, callback, context)
+#define lineDetach() furi_hal_gpio_remove_int_callback(sensor->GPIO)
 #define Delay(d) furi_delay_ms(d)
+#define getTick() furi_get_tick()
+#define getCycles() (DWT->CYCCNT)
+#define cyclesPerUs() furi_hal_cortex_instructions_per_microsecond()
+#define irqDisable() __disable_irq()
+#define irqEnable() __enable_irq()
 
-DHT_data DHT_getData(DHT_sensor* sensor) {
-    DHT_data data = {-128.0f, -128.0f};
+//Время передачи ответа из 40 бит с подтверждением, мс
+#define DHT_RESPONSE_TIME 6
 
-#if DHT_POLLING_CONTROL == 1
-    /* Ограничение по частоте опроса датчика */
-    //Определение интервала опроса в зависимости от датчика
-    uint16_t pollingInterval;
-    if(sensor->type == DHT11) {
-        pollingInterval = DHT_POLLING_INTERVAL_DHT11;
+/**
+ * @brief Запись принятого бита по длительности его импульса высокого уровня
+ *
+ * @param rawData Буфер на 5 байт для принятых данных
+ * @param bit Порядковый номер бита от 0 до 39
+ * @param width Длительность импульса, мкс
+ * @param timing Статистика длительностей импульсов
+ */
+static void DHT_storeBit(uint8_t rawData[5], uint8_t bit, uint32_t width, DHT_timing* timing) {
+    if(width > 255) width = 255;
+    if(width > DHT_BIT_THRESHOLD) {
+        rawData[bit / 8] |= (1 << (7 - bit % 8));
+        if(width < timing->oneMin) timing->oneMin = width;
+        if(width > timing->oneMax) timing->oneMax = width;
     } else {
-        pollingInterval = DHT_POLLING_INTERVAL_DHT22;
+        if(width < timing->zeroMin) timing->zeroMin = width;
+        if(width > timing->zeroMax) timing->zeroMax = width;
     }
+}
 
-    //Если интервал маленький, то возврат последнего удачного значения
-    if((furi_get_tick() - sensor->lastPollingTime < pollingInterval) &&
-       sensor->lastPollingTime != 0) {
-        data.hum = sensor->lastHum;
-        data.temp = sensor->lastTemp;
-        return data;
+/**
+ * @brief Ожидание смены уровня линии с замером длительности по счётчику тактов
+ * @details Уровень читается прямо из регистра порта, поэтому один проход цикла
+ * занимает несколько тактов и длительность импульсов не грубеет на низкой частоте ядра
+ *
+ * @param idr Регистр входных данных порта
+ * @param mask Маска вывода
+ * @param level Уровень, смены которого нужно дождаться: mask или 0
+ * @param timeout Максимальная длительность уровня, такты
+ * @param width Длительность уровня, такты
+ * @return true Уровень сменился
+ * @return false Превышен таймаут
+ */
+static inline bool DHT_waitWhile(
+    volatile uint32_t* idr,
+    uint32_t mask,
+    uint32_t level,
+    uint32_t timeout,
+    uint32_t* width) {
+    uint32_t start = getCycles();
+    while(lineSample(idr, mask) == level) {
+        if(getCycles() - start > timeout) return false;
     }
-    sensor->lastPollingTime = furi_get_tick() + 1;
-#endif
+    *width = getCycles() - start;
+    return true;
+}
 
-    //Опускание линии данных на 18 мс
-    lineDown();
+/**
+ * @brief Ожидание смены уровня с записью его длительности в режиме записи ответа
+ * @details Без записи отличается от DHT_waitWhile одной проверкой между фронтами
+ *
+ * @param idr Регистр входных данных порта
+ * @param mask Маска вывода
+ * @param level Уровень, смены которого нужно дождаться: mask или 0
+ * @param timeout Максимальная длительность уровня, такты
+ * @param width Длительность уровня, такты
+ * @param wave Буфер записи ответа или NULL
+ * @param ticksPerUs Тактов в микросекунде
+ * @return true Уровень сменился
+ * @return false Превышен таймаут
+ */
+static inline bool DHT_waitRecord(
+    volatile uint32_t* idr,
+    uint32_t mask,
+    uint32_t level,
+    uint32_t timeout,
+    uint32_t* width,
+    DHT_waveform* wave,
+    uint32_t ticksPerUs) {
+    bool changed = DHT_waitWhile(idr, mask, level, timeout, width);
+    if(wave != NULL && wave->count < DHT_EDGES_MAX) {
+        uint32_t us = changed ? *width / ticksPerUs : DHT_WAVE_TIMEOUT;
+        wave->width[wave->count++] = MIN(us, (uint32_t)DHT_WAVE_TIMEOUT);
+    }
+    return changed;
+}
+
+/**
+ * @brief Приём ответа датчика опросом линии в цикле
+ *
+ * @param sensor Указатель на датчик
+ * @param rawData Буфер на 5 байт для принятых данных
+ * @param timing Статистика длительностей импульсов
+ * @return Результат приёма
+ */
+static DHT_response
+    DHT_readBusyWait(DHT_sensor* sensor, uint8_t rawData[5], DHT_timing* timing) {
+    const uint32_t ticksPerUs = cyclesPerUs();
+    volatile uint32_t* idr = sensor->line.idr;
+    const uint32_t high = sensor->line.setMask;
+    const uint32_t releaseTimeout = DHT_TIMEOUT_RELEASE * ticksPerUs;
+    const uint32_t responseTimeout = DHT_TIMEOUT_RESPONSE * ticksPerUs;
+    const uint32_t ackTimeout = DHT_TIMEOUT_ACK * ticksPerUs;
+    const uint32_t bitTimeout = DHT_TIMEOUT_BIT * ticksPerUs;
+    //Запись начинается с низкого уровня после отпускания линии
+    DHT_waveform* wave = sensor->wave;
+    if(wave != NULL) wave->firstLevel = 0;
+    uint32_t width;
+    DHT_response response = DHT_RESPONSE_ABSENT;
+    DHT_phase phase = DHT_PHASE_RELEASE;
 #ifdef DHT_IRQ_CONTROL
-    //Выключение прерываний, чтобы ничто не мешало обработке данных
-    __disable_irq();
+    //Выключение прерываний, чтобы ничто не мешало обработке данных.
+    //Стартовый импульс уже отправлен, так что прерывания выключены только на время ответа
+    irqDisable();
+    uint32_t irqStart = getCycles();
 #endif
-    Delay(18);
-
     //Подъём линии
     lineUp();
 
-    /* Ожидание ответа от датчика */
-    uint16_t timeout = 0;
-    while(!getLine()) {
-        timeout++;
-        if(timeout > DHT_TIMEOUT) {
+    do {
+        /* Ожидание ответа от датчика */
+        //Подъём линии подтяжкой
+        if(!DHT_waitRecord(idr, high, 0, releaseTimeout, &width, wave, ticksPerUs)) break;
+        //Датчик прижимает линию. Если этого не случилось, то датчика нет
+        phase = DHT_PHASE_RESPONSE;
+        if(!DHT_waitRecord(idr, high, high, responseTimeout, &width, wave, ticksPerUs)) break;
+        response = DHT_RESPONSE_BROKEN;
+        //Импульсы подтверждения
+        phase = DHT_PHASE_ACK;
+        if(!DHT_waitRecord(idr, high, 0, ackTimeout, &width, wave, ticksPerUs)) break;
+        if(!DHT_waitRecord(idr, high, high, ackTimeout, &width, wave, ticksPerUs)) break;
+
+        /* Чтение ответа от датчика */
+        phase = DHT_PHASE_DATA;
+        uint8_t bit = 0;
+        for(; bit < 40; bit++) {
+            //Низкий уровень перед каждым битом
+            if(!DHT_waitRecord(idr, high, 0, bitTimeout, &width, wave, ticksPerUs)) break;
+            //Значение бита определяет длительность высокого уровня
+            if(!DHT_waitRecord(idr, high, high, bitTimeout, &width, wave, ticksPerUs)) break;
+            DHT_storeBit(rawData, bit, width / ticksPerUs, timing);
+        }
+        if(bit == 40) response = DHT_RESPONSE_OK;
+    } while(0);
+
 #ifdef DHT_IRQ_CONTROL
-            __enable_irq();
+    //Включение прерываний после приёма данных
+    uint32_t irqTime = (getCycles() - irqStart) / ticksPerUs;
+    irqEnable();
+    if(irqTime > sensor->stats.irqMax) sensor->stats.irqMax = MIN(irqTime, UINT16_MAX);
 #endif
-            //Если датчик не отозвался, значит его точно нет
-            //Обнуление последнего удачного значения, чтобы
-            //не получать фантомные значения
-            sensor->lastHum = -128.0f;
-            sensor->lastTemp = -128.0f;
+    if(response != DHT_RESPONSE_OK) sensor->stats.timeouts[phase]++;
+    return response;
+}
+
+/**
+ * @brief Декодирование записанных фронтов в байты ответа
+ * @details Данные несут последние 40 импульсов высокого уровня, все предыдущие
+ * (подъём линии и подтверждение датчика) пропускаются
+ *
+ * @param edges Метки времени фронтов в тактах с уровнем в младшем бите
+ * @param count Количество фронтов
+ * @param rawData Буфер на 5 байт для принятых данных
+ * @param timing Статистика длительностей импульсов
+ * @return Результат приёма
+ */
+static DHT_response DHT_decodeEdges(
+    const uint32_t* edges,
+    uint8_t count,
+    uint8_t rawData[5],
+    DHT_timing* timing) {
+    //Количество импульсов высокого уровня
+    uint8_t pulses = 0;
+    for(uint8_t i = 1; i < count; i++) {
+        if((edges[i - 1] & 1) && !(edges[i] & 1)) pulses++;
+    }
+    //Без ответа датчика на линии есть только её подъём после стартового импульса
+    if(count < 3) return DHT_RESPONSE_ABSENT;
+    if(pulses < 40) return DHT_RESPONSE_BROKEN;
 
-            return data;
+    const uint32_t ticksPerUs = cyclesPerUs();
+    uint8_t skip = pulses - 40;
+    uint8_t bit = 0;
+    for(uint8_t i = 1; i < count; i++) {
+        if(!((edges[i - 1] & 1) && !(edges[i] & 1))) continue;
+        if(skip > 0) {
+            skip--;
+            continue;
         }
+        uint32_t width = (edges[i] & ~1UL) - (edges[i - 1] & ~1UL);
+        DHT_storeBit(rawData, bit++, width / ticksPerUs, timing);
     }
-    //Ожидание спада
-    while(getLine()) {
-        timeout++;
-        if(timeout > DHT_TIMEOUT) {
-#ifdef DHT_IRQ_CONTROL
-            __enable_irq();
-#endif
-            //Если датчик не отозвался, значит его точно нет
-            //Обнуление последнего удачного значения, чтобы
-            //не получать фантомные значения
-            sensor->lastHum = -128.0f;
-            sensor->lastTemp = -128.0f;
+    return DHT_RESPONSE_OK;
+}
+
+#if DHT_DECODER == DHT_DECODER_EXTI
+/* Буфер фронтов ответа датчика. Младший бит метки времени - уровень линии после фронта */
+typedef struct {
+    const DHT_line* line;
+    volatile uint8_t count;
+    uint32_t edges[DHT_EDGES_MAX];
+} DHT_capture;
+
+static DHT_capture capture;
+
+/**
+ * @brief Обработчик прерывания по фронту линии данных
+ *
+ * @param context Указатель на буфер фронтов
+ */
+static void DHT_edgeCallback(void* context) {
+    DHT_capture* cap = context;
+    uint32_t timestamp = getCycles();
+    if(cap->count < DHT_EDGES_MAX) {
+        uint32_t level = lineSample(cap->line->idr, cap->line->setMask) ? 1 : 0;
+        cap->edges[cap->count++] = (timestamp & ~1UL) | level;
+    }
+}
+
+/**
+ * @brief Приём ответа датчика по прерываниям
+ * @details Прерывания остаются включёнными, фронты записываются в буфер
+ * и декодируются после окончания передачи
+ *
+ * @param sensor Указатель на датчик
+ * @param rawData Буфер на 5 байт для принятых данных
+ * @param timing Статистика длительностей импульсов
+ * @return Результат приёма
+ */
+static DHT_response DHT_readExti(DHT_sensor* sensor, uint8_t rawData[5], DHT_timing* timing) {
+    capture.line = &sensor->line;
+    capture.count = 0;
+    lineAttach(DHT_edgeCallback, &capture);
+    //Перевод линии в режим входа отпускает её, подтяжка поднимает уровень
+    lineInit(GpioModeInterruptRiseFall);
+    Delay(DHT_EXTI_CAPTURE_TIME);
+    lineDetach();
+
+    //Возврат линии в исходное состояние
+    lineUp();
+    lineInit(GpioModeOutputOpenDrain);
 
-            return data;
+    //Запись ответа - промежутки между записанными фронтами. Уровень до первого фронта не виден
+    DHT_waveform* wave = sensor->wave;
+    if(wave != NULL && capture.count > 0) {
+        const uint32_t ticksPerUs = cyclesPerUs();
+        wave->firstLevel = capture.edges[0] & 1;
+        //Подъём линии случился до включения прерывания. Запись начинается с него же,
+        //нулевой длины, чтобы спад подтверждения датчика был виден в записи
+        if(wave->firstLevel == 0) {
+            wave->firstLevel = 1;
+            wave->width[wave->count++] = 0;
+        }
+        for(uint8_t i = 1; i < capture.count; i++) {
+            uint32_t width = (capture.edges[i] & ~1UL) - (capture.edges[i - 1] & ~1UL);
+            wave->width[wave->count++] = MIN(width / ticksPerUs, (uint32_t)DHT_WAVE_TIMEOUT);
         }
     }
-    timeout = 0;
-    //Ожидание подъёма
-    while(!getLine()) {
-        timeout++;
-        if(timeout > DHT_TIMEOUT) {
-            if(timeout > DHT_TIMEOUT) {
-#ifdef DHT_IRQ_CONTROL
-                __enable_irq();
+
+    DHT_response response = DHT_decodeEdges(capture.edges, capture.count, rawData, timing);
+    //По записанным фронтам видно только, ответил ли датчик вообще
+    if(response == DHT_RESPONSE_ABSENT) sensor->stats.timeouts[DHT_PHASE_RESPONSE]++;
+    if(response == DHT_RESPONSE_BROKEN) sensor->stats.timeouts[DHT_PHASE_DATA]++;
+    return response;
+}
 #endif
-                //Если датчик не отозвался, значит его точно нет
-                //Обнуление последнего удачного значения, чтобы
-                //не получать фантомные значения
-                sensor->lastHum = -128.0f;
-                sensor->lastTemp = -128.0f;
 
-                return data;
-            }
-        }
+DHT_response DHT_decodeWave(const DHT_waveform* wave, uint8_t rawData[5], DHT_timing* timing) {
+    //Уровни записи превращаются в фронты в начале каждого уровня
+    const uint32_t ticksPerUs = cyclesPerUs();
+    uint32_t edges[DHT_EDGES_MAX + 1];
+    uint32_t time = 0;
+    uint8_t count = 0;
+    for(; count < wave->count; count++) {
+        uint32_t level = (wave->firstLevel ^ count) & 1;
+        edges[count] = ((time * ticksPerUs) & ~1UL) | level;
+        time += wave->width[count];
     }
-    timeout = 0;
-    //Ожидание спада
-    while(getLine()) {
-        timeout++;
-        if(timeout > DHT_TIMEOUT) {
-#ifdef DHT_IRQ_CONTROL
-            __enable_irq();
+    //Законченный последний уровень завершается фронтом
+    if(count > 0 && wave->width[count - 1] != DHT_WAVE_TIMEOUT) {
+        edges[count] = ((time * ticksPerUs) & ~1UL) | ((wave->firstLevel ^ count) & 1);
+        count++;
+    }
+    return DHT_decodeEdges(edges, count, rawData, timing);
+}
+
+/**
+ * @brief Приём 40-битного ответа по однопроводной шине
+ * @details Общий для DHT11, DHT22 и совместимых с ними датчиков AOSONG
+ *
+ * @param sensor Указатель на датчик
+ * @param rawData Буфер на 5 байт для принятых данных
+ * @param timing Статистика длительностей импульсов
+ * @return Результат приёма
+ */
+static DHT_response
+    DHT_decodeSingleBus(DHT_sensor* sensor, uint8_t rawData[5], DHT_timing* timing) {
+#if DHT_DECODER == DHT_DECODER_EXTI
+    if(sensor->GPIO->pin & DHT_EXTI_RESERVED_LINES) {
+        //Линия EXTI этого порта занята, приём по старинке
+        return DHT_readBusyWait(sensor, rawData, timing);
+    }
+    return DHT_readExti(sensor, rawData, timing);
+#else
+    return DHT_readBusyWait(sensor, rawData, timing);
 #endif
-            //Если датчик не отозвался, значит его точно нет
-            //Обнуление последнего удачного значения, чтобы
-            //не получать фантомные значения
-            sensor->lastHum = -128.0f;
-            sensor->lastTemp = -128.0f;
-            return data;
+}
+
+/**
+ * @brief Перевод ответа DHT11: целые части в старших байтах, дробные в младших
+ *
+ * @param rawData Принятые 5 байт ответа
+ * @param data Показания, куда записываются значения
+ */
+static void DHT_convertDHT11(const uint8_t rawData[5], DHT_data* data) {
+    data->hum = rawData[0] * 10;
+    //DHT11 производства ASAIR имеют дробную часть в температуре
+    //А ещё температуру измеряет от -20 до +60 *С
+    //Вот прикол, да?
+    data->temp = rawData[2] * 10 + (rawData[3] & 0x7F);
+    //Проверка знака
+    if(rawData[3] & (1 << 7)) data->temp = -data->temp;
+}
+
+/**
+ * @brief Перевод ответа DHT22 и совместимых: 16-битные значения в десятых долях,
+ * знак температуры в старшем бите
+ *
+ * @param rawData Принятые 5 байт ответа
+ * @param data Показания, куда записываются значения
+ */
+static void DHT_convertDHT22(const uint8_t rawData[5], DHT_data* data) {
+    data->hum = ((uint16_t)rawData[0] << 8) | rawData[1];
+    data->temp = ((uint16_t)(rawData[2] & 0x7F) << 8) | rawData[3];
+    //Проверка на отрицательность температуры
+    if(rawData[2] & (1 << 7)) data->temp = -data->temp;
+}
+
+/* Драйверы типов датчиков. Новый тип добавляется сюда и в конец DHT_type */
+static const DHT_driver drivers[DHT_TYPES_COUNT] = {
+    //Стартовый импульс не короче 18 мс, 0.5 Гц по даташиту
+    [DHT11] =
+        {.name = "DHT11",
+         .startPulse = 18,
+         .cost = 18 + DHT_RESPONSE_TIME,
+         .minInterval = 2000,
+         .retryDelay = 2000,
+         .powerSettle = 1000,
+         .decode = DHT_decodeSingleBus,
+         .convert = DHT_convertDHT11},
+    //Стартовый импульс от 1 мс. DHT22 выдерживает 1 Гц, но AM2302 требует не менее 2 секунд
+    [DHT22] =
+        {.name = "DHT22",
+         .startPulse = 2,
+         .cost = 2 + DHT_RESPONSE_TIME,
+         .minInterval = 2000,
+         .retryDelay = 2000,
+         .powerSettle = 1000,
+         .decode = DHT_decodeSingleBus,
+         .convert = DHT_convertDHT22},
+    [AM2301] =
+        {.name = "AM2301",
+         .startPulse = 2,
+         .cost = 2 + DHT_RESPONSE_TIME,
+         .minInterval = 2000,
+         .retryDelay = 2000,
+         .powerSettle = 1000,
+         .decode = DHT_decodeSingleBus,
+         .convert = DHT_convertDHT22},
+    //Стартовый импульс от 0.8 до 20 мс
+    [AM2320] =
+        {.name = "AM2320",
+         .startPulse = 2,
+         .cost = 2 + DHT_RESPONSE_TIME,
+         .minInterval = 2000,
+         .retryDelay = 2000,
+         .powerSettle = 2000,
+         .decode = DHT_decodeSingleBus,
+         .convert = DHT_convertDHT22},
+};
+
+const DHT_driver* DHT_getDriver(uint8_t type) {
+    if(type >= DHT_TYPES_COUNT) return NULL;
+    return &drivers[type];
+}
+
+/**
+ * @brief Драйвер датчика. Неизвестный тип опрашивается как DHT11, у которого самые
+ * мягкие требования к опросу
+ *
+ * @param sensor Указатель на датчик
+ * @return Указатель на драйвер
+ */
+static inline const DHT_driver* DHT_driverOf(const DHT_sensor* sensor) {
+    return &drivers[sensor->type < DHT_TYPES_COUNT ? sensor->type : DHT11];
+}
+
+/**
+ * @brief Проверка, пора ли опрашивать датчик
+ *
+ * @param sensor Указатель на датчик
+ * @param data Показания, куда записываются последние значения, если опрашивать рано
+ * @return true Датчик нужно опросить
+ * @return false Интервал опроса ещё не истёк
+ */
+static bool DHT_isDue(DHT_sensor* sensor, DHT_data* data) {
+#if DHT_POLLING_CONTROL == 1
+    /* Ограничение по частоте опроса датчика */
+    uint32_t pollingInterval = DHT_getInterval(sensor);
+
+    //Если интервал маленький, то возврат последних показаний
+    if((getTick() - sensor->lastPollingTime < pollingInterval) &&
+       sensor->lastPollingTime != 0) {
+        *data = sensor->last;
+        if(data->status == DHT_OK) data->status = DHT_CACHED;
+        return false;
+    }
+    sensor->lastPollingTime = getTick() + 1;
+#else
+    UNUSED(sensor);
+    UNUSED(data);
+#endif
+    return true;
+}
+
+uint32_t DHT_getInterval(const DHT_sensor* sensor) {
+    //Определение интервала опроса в зависимости от датчика
+    uint32_t pollingInterval = DHT_driverOf(sensor)->minInterval;
+    //Заданный интервал не может быть меньше допустимого для датчика
+    if(sensor->pollingInterval > pollingInterval) pollingInterval = sensor->pollingInterval;
+#if DHT_POLLING_CONTROL == 1
+    //Повреждённый ответ переспрашивается, как только датчик будет к этому готов,
+    //но не чаще минимального интервала опроса
+    if(sensor->retryCount > 0) {
+        const DHT_driver* driver = DHT_driverOf(sensor);
+        return MAX(driver->minInterval, MIN(pollingInterval, driver->retryDelay));
+    }
+    //Отсутствующий датчик опрашивается всё реже, чтобы не тратить время на ожидание ответа
+    if(sensor->missCount > 0) {
+        uint8_t shift = MIN(sensor->missCount, DHT_BACKOFF_MAX_SHIFT);
+        //Ограничение проверяется до сдвига, чтобы большой интервал не переполнился
+        if(pollingInterval > DHT_BACKOFF_MAX_INTERVAL >> shift) {
+            pollingInterval = MAX(DHT_BACKOFF_MAX_INTERVAL, sensor->pollingInterval);
+        } else {
+            pollingInterval <<= shift;
         }
     }
+#endif
+    return pollingInterval;
+}
+
+void DHT_initLine(DHT_sensor* sensor, uint8_t index) {
+    sensor->line.index = index;
+    if(sensor->GPIO == NULL) {
+        sensor->line.idr = sensor->line.bsrr = NULL;
+        sensor->line.setMask = sensor->line.resetMask = 0;
+        return;
+    }
+    sensor->line.idr = portIDR(sensor->GPIO);
+    sensor->line.bsrr = portBSRR(sensor->GPIO);
+    sensor->line.setMask = sensor->GPIO->pin;
+    sensor->line.resetMask = (uint32_t)sensor->GPIO->pin << 16;
+}
+
+void DHT_resetState(DHT_sensor* sensor) {
+#if DHT_POLLING_CONTROL == 1
+    sensor->lastPollingTime = 0;
+    sensor->missCount = 0;
+    sensor->retryCount = 0;
+    sensor->last = (DHT_data){.status = DHT_NO_RESPONSE, .type = sensor->type};
+#endif
+    memset(&sensor->timing, 0, sizeof(DHT_timing));
+    memset(&sensor->stats, 0, sizeof(DHT_stats));
+}
+
+/**
+ * @brief Приём и обработка ответа датчика после стартового импульса
+ *
+ * @param sensor Указатель на датчик, линия которого прижата к земле
+ * @return Показания датчика
+ */
+static DHT_data DHT_read(DHT_sensor* sensor) {
+    DHT_data data = {
+        .temp = 0,
+        .hum = 0,
+        .tick = getTick(),
+        .status = DHT_NO_RESPONSE,
+        .type = sensor->type};
 
-    /* Чтение ответа от датчика */
     uint8_t rawData[5] = {0, 0, 0, 0, 0};
-    for(uint8_t a = 0; a < 5; a++) {
-        for(uint8_t b = 7; b != 255; b--) {
-            uint16_t hT = 0, lT = 0;
-            //Пока линия в низком уровне, инкремент переменной lT
-            while(!getLine() && lT != 65535) lT++;
-            //Пока линия в высоком уровне, инкремент переменной hT
-            timeout = 0;
-            while(getLine() && hT != 65535) hT++;
-            //Если hT больше lT, то пришла единица
-            if(hT > lT) rawData[a] |= (1 << b);
-        }
+    DHT_timing timing = {.zeroMin = 255, .zeroMax = 0, .oneMin = 255, .oneMax = 0};
+    //Заказанная запись ответа ведётся прямо во время приёма
+    DHT_waveform* wave = sensor->wave;
+    if(wave != NULL) wave->count = 0;
+    uint32_t readStart = getCycles();
+    DHT_response response = DHT_driverOf(sensor)->decode(sensor, rawData, &timing);
+    uint32_t readTime = (getCycles() - readStart) / cyclesPerUs();
+    if(wave != NULL) {
+        wave->response = response;
+        memcpy(wave->rawData, rawData, sizeof(wave->rawData));
+        wave->tick = data.tick;
+        //Запись одноразовая
+        sensor->wave = NULL;
+        wave->ready = true;
+    }
+    DHT_stats* stats = &sensor->stats;
+    stats->polls++;
+
+#if DHT_POLLING_CONTROL == 1
+    if(response == DHT_RESPONSE_ABSENT) {
+        if(sensor->missCount < 255) sensor->missCount++;
+    } else {
+        sensor->missCount = 0;
     }
-#ifdef DHT_IRQ_CONTROL
-    //Включение прерываний после приёма данных
-    __enable_irq();
 #endif
-    /* Проверка целостности данных */
-    if((uint8_t)(rawData[0] + rawData[1] + rawData[2] + rawData[3]) == rawData[4]) {
-        //Если контрольная сумма совпадает, то конвертация и возврат полученных значений
-        if(sensor->type == DHT22) {
-            data.hum = (float)(((uint16_t)rawData[0] << 8) | rawData[1]) * 0.1f;
-            //Проверка на отрицательность температуры
-            if(!(rawData[2] & (1 << 7))) {
-                data.temp = (float)(((uint16_t)rawData[2] << 8) | rawData[3]) * 0.1f;
-            } else {
-                rawData[2] &= ~(1 << 7);
-                data.temp = (float)(((uint16_t)rawData[2] << 8) | rawData[3]) * -0.1f;
+
+    if(response == DHT_RESPONSE_OK) {
+        sensor->timing = timing;
+
+        DHT_convert(sensor->type, rawData, &data);
+
+        //Длительность считается только по полным ответам, таймауты её бы исказили
+        if(readTime > UINT16_MAX) readTime = UINT16_MAX;
+        if(stats->timeMin == 0 || readTime < stats->timeMin) stats->timeMin = readTime;
+        if(readTime > stats->timeMax) stats->timeMax = readTime;
+        stats->timeSum += readTime;
+        if(data.status == DHT_OK) stats->ok++;
+        if(data.status == DHT_CHECKSUM_ERROR) stats->checksumErrors++;
+        if(data.status == DHT_OUT_OF_RANGE) stats->rangeErrors++;
+    }
+
+#if DHT_POLLING_CONTROL == 1
+    //Ответ пришёл, но с битыми битами - на длинных линиях это обычно разовая помеха
+    bool corrupted = response == DHT_RESPONSE_BROKEN || data.status == DHT_CHECKSUM_ERROR;
+    if(corrupted && sensor->retryCount < DHT_RETRY_MAX) {
+        sensor->retryCount++;
+        stats->retries++;
+        //До повторного опроса отдаются прежние показания с пометкой об устаревании
+        if(sensor->last.status == DHT_OK) sensor->last.status = DHT_STALE;
+        if(sensor->last.status == DHT_STALE) return sensor->last;
+        return data;
+    }
+    sensor->retryCount = 0;
+    //Ошибка тоже запоминается, чтобы не получать фантомные значения
+    sensor->last = data;
+#endif
+
+    return data;
+}
+
+/**
+ * @brief Ожидание наступления момента времени
+ *
+ * @param tick Момент времени в тиках системы
+ */
+static void DHT_waitUntil(uint32_t tick) {
+    int32_t delay = (int32_t)(tick - getTick());
+    if(delay > 0) Delay(delay);
+}
+
+DHT_data DHT_getData(DHT_sensor* sensor) {
+    DHT_data data;
+    if(!DHT_isDue(sensor, &data)) return data;
+
+    //Опускание линии данных на время стартового импульса. Прерывания на это время не выключаются
+    lineDown();
+    Delay(DHT_driverOf(sensor)->startPulse);
+
+    return DHT_read(sensor);
+}
+
+/**
+ * @brief Есть ли выигрыш от наложения стартовых импульсов
+ * @details Импульс следующего датчика должен перекрыть чтение ответа предыдущего с запасом.
+ * Иначе он прячется под чтением лишь частично, а запас DHT_BATCH_GUARD делает пачку
+ * медленнее опроса по очереди
+ *
+ * @param prev Драйвер датчика, ответ которого читается
+ * @param next Драйвер следующего датчика
+ * @return true Импульс следующего датчика стоит начинать до чтения предыдущего
+ */
+static bool DHT_batchOverlaps(const DHT_driver* prev, const DHT_driver* next) {
+    return next->startPulse > prev->cost - prev->startPulse + DHT_BATCH_GUARD;
+}
+
+void DHT_getDataBatch(DHT_sensor* sensors[], DHT_data data[], uint8_t count) {
+    for(uint8_t first = 0; first < count; first += DHT_BATCH_MAX) {
+        //Датчики пачки, которые пора опрашивать
+        uint8_t queue[DHT_BATCH_MAX];
+        //Моменты отпускания линий датчиков
+        uint32_t release[DHT_BATCH_MAX];
+        uint8_t queued = 0;
+        for(uint8_t i = first; i < count && i < first + DHT_BATCH_MAX; i++) {
+            if(!DHT_isDue(sensors[i], &data[i])) continue;
+            //Очередь упорядочена по убыванию стартового импульса, тогда линии
+            //отпускаются в том же порядке, в котором прижимаются
+            uint8_t pos = queued++;
+            uint8_t pulse = DHT_driverOf(sensors[i])->startPulse;
+            while(pos > 0 && DHT_driverOf(sensors[queue[pos - 1]])->startPulse < pulse) {
+                queue[pos] = queue[pos - 1];
+                pos--;
             }
+            queue[pos] = i;
         }
-        if(sensor->type == DHT11) {
-            data.hum = (float)rawData[0];
-            data.temp = (float)rawData[2];
-            //DHT11 производства ASAIR имеют дробную часть в температуре
-            //А ещё температуру измеряет от -20 до +60 *С
-            //Вот прикол, да?
-            if(rawData[3] != 0) {
-                //Проверка знака
-                if(!(rawData[3] & (1 << 7))) {
-                    //Добавление положительной дробной части
-                    data.temp += rawData[3] * 0.1f;
-                } else {
-                    //А тут делаем отрицательное значение
-                    rawData[3] &= ~(1 << 7);
-                    data.temp += rawData[3] * 0.1f;
-                    data.temp *= -1;
+
+        //Стартовые импульсы идут внахлёст, ответы читаются по очереди. Линия следующего
+        //датчика прижимается так, чтобы отпуститься после чтения ответа предыдущего с запасом
+        //DHT_BATCH_GUARD. Если ответ прочитан раньше, чем прижата следующая линия, она
+        //прижимается сразу. Импульс может затянуться до конца чтения, но не укорачивается
+        uint8_t lowered = 0, read = 0;
+        while(read < queued) {
+            if(lowered == read) {
+                DHT_sensor* sensor = sensors[queue[lowered]];
+                const DHT_driver* driver = DHT_driverOf(sensor);
+                lineDown();
+                bool overlaps = lowered + 1 < queued &&
+                                DHT_batchOverlaps(driver, DHT_driverOf(sensors[queue[lowered + 1]]));
+                if(!overlaps) {
+                    //Следующий импульс не спрятать под чтение - опрос как одиночный
+                    Delay(driver->startPulse);
+                    data[queue[read++]] = DHT_read(sensor);
+                    lowered++;
+                    continue;
+                }
+                //Запас в один тик на случай, если импульс начался под конец тика
+                release[lowered++] = getTick() + driver->startPulse + 1;
+                continue;
+            }
+            if(lowered < queued) {
+                const DHT_driver* prev = DHT_driverOf(sensors[queue[lowered - 1]]);
+                DHT_sensor* sensor = sensors[queue[lowered]];
+                const DHT_driver* next = DHT_driverOf(sensor);
+                uint32_t lowerTime = release[lowered - 1] + (prev->cost - prev->startPulse) +
+                                     DHT_BATCH_GUARD - next->startPulse - 1;
+                if(DHT_batchOverlaps(prev, next) && (int32_t)(lowerTime - release[read]) <= 0) {
+                    DHT_waitUntil(lowerTime);
+                    lineDown();
+                    release[lowered++] = getTick() + next->startPulse + 1;
+                    continue;
                 }
             }
+            DHT_waitUntil(release[read]);
+            data[queue[read]] = DHT_read(sensors[queue[read]]);
+            read++;
         }
     }
+}
 
-#if DHT_POLLING_CONTROL == 1
-    sensor->lastHum = data.hum;
-    sensor->lastTemp = data.temp;
-#endif
+void DHT_convert(DHT_type type, const uint8_t rawData[5], DHT_data* data) {
+    const DHT_driver* driver = DHT_getDriver(type);
+    if(driver == NULL) {
+        data->status = DHT_NO_RESPONSE;
+        return;
+    }
+    /* Проверка целостности данных */
+    if((uint8_t)(rawData[0] + rawData[1] + rawData[2] + rawData[3]) != rawData[4]) {
+        data->status = DHT_CHECKSUM_ERROR;
+        return;
+    }
+    //Если контрольная сумма совпадает, то конвертация в десятые доли
+    driver->convert(rawData, data);
+    //Нулевой ответ - датчик ещё не закончил первое измерение после подачи питания
+    bool zero = (rawData[0] | rawData[1] | rawData[2] | rawData[3]) == 0;
+    //Проверка попадания в диапазон измерений. Влажность DHT22 от 0x8000 после приведения к int16_t отрицательна
+    if(zero || data->hum < 0 || data->hum > 1000 || data->temp < -400 || data->temp > 800) {
+        data->status = DHT_OUT_OF_RANGE;
+    } else {
+        data->status = DHT_OK;
+    }
+}
 
-    return data;
-}
\ No newline at end of file
+uint8_t DHT_formatTenths(char* str, uint8_t size, int16_t value) {
+    //Цифры складываются в обратном порядке, начиная с десятых долей
+    char digits[8];
+    uint8_t len = 0;
+    int32_t absValue = value < 0 ? -(int32_t)value : value;
+    digits[len++] = '0' + absValue % 10;
+    digits[len++] = '.';
+    absValue /= 10;
+    do {
+        digits[len++] = '0' + absValue % 10;
+        absValue /= 10;
+    } while(absValue > 0);
+    if(value < 0) digits[len++] = '-';
+
+    if(len >= size) {
+        if(size > 0) str[0] = '\0';
+        return 0;
+    }
+    for(uint8_t i = 0; i < len; i++) {
+        str[i] = digits[len - 1 - i];
+    }
+    str[len] = '\0';
+    return len;
+}
+
+bool DHT_isValid(const DHT_data* data) {
+    return data->status == DHT_OK || data->status == DHT_CACHED || data->status == DHT_STALE;
+}
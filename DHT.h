@@ -2,39 +2,245 @@
 #define DHT_H_
 
 #include <furi_hal_resources.h>
+#include <furi_hal_cortex.h>
 
 /* Настройки */
-#define DHT_TIMEOUT 65534 //Количество итераций, после которых функция вернёт пустые значения
+#define DHT_BATCH_MAX 16 //Количество датчиков, стартовые импульсы которых идут внахлёст
+//Запас между концом чтения ответа одного датчика пачки и отпусканием линии следующего, мс
+#define DHT_BATCH_GUARD 2
+/* Таймауты фаз обмена по счётчику тактов DWT, мкс */
+#define DHT_TIMEOUT_RELEASE 50 //Подъём линии после стартового импульса
+#define DHT_TIMEOUT_RESPONSE 100 //Начало ответа датчика (по даташиту 20-40 мкс)
+#define DHT_TIMEOUT_ACK 100 //Импульсы подтверждения (по даташиту 80 мкс)
+#define DHT_TIMEOUT_BIT 100 //Импульсы бита данных (по даташиту 50 и 26-70 мкс)
 #define DHT_POLLING_CONTROL 1 //Включение проверки частоты опроса датчика
-#define DHT_POLLING_INTERVAL_DHT11 \
-    2000 //Интервал опроса DHT11 (0.5 Гц по даташиту). Можно поставить 1500, будет работать
-//Костыль, временно 2 секунды для датчика AM2302
-#define DHT_POLLING_INTERVAL_DHT22 2000 //Интервал опроса DHT22 (1 Гц по даташиту)
+//Сколько раз подряд опрашивать датчик повторно после повреждённого ответа. 0 - без повторов
+#define DHT_RETRY_MAX 2
+#define DHT_BACKOFF_MAX_SHIFT 5 //Во сколько раз (степень двойки) можно увеличить интервал опроса отсутствующего датчика
+#define DHT_BACKOFF_MAX_INTERVAL 30000 //Наибольший интервал опроса отсутствующего датчика, мс
 #define DHT_IRQ_CONTROL //Выключать прерывания во время обмена данных с датчиком
+
+/* Способ приёма ответа датчика */
+#define DHT_DECODER_BUSYWAIT 0 //Опрос линии в цикле с выключенными прерываниями
+#define DHT_DECODER_EXTI 1 //Запись фронтов по прерываниям EXTI с последующим декодированием
+//Используемый способ приёма. Может быть задан при сборке
+#ifndef DHT_DECODER
+#define DHT_DECODER DHT_DECODER_BUSYWAIT
+#endif
+//Линии EXTI, занятые кнопками Flipper Zero. На таких портах приём идёт в цикле
+#define DHT_EXTI_RESERVED_LINES \
+    ((1 << 3) | (1 << 6) | (1 << 10) | (1 << 11) | (1 << 12) | (1 << 13))
+#define DHT_EXTI_CAPTURE_TIME 6 //Время записи ответа датчика, мс
+#define DHT_EDGES_MAX 88 //Размер буфера фронтов (ответ датчика - до 85 фронтов)
+#define DHT_BIT_THRESHOLD 48 //Граница длительности единицы, мкс: 0 - 26-28 мкс, 1 - 70 мкс
+#define DHT_WAVE_TIMEOUT 255 //Длительность уровня в записи ответа, который не сменился до таймаута
+/* Состояние показаний датчика */
+typedef enum {
+    DHT_OK, //Свежие показания
+    DHT_CACHED, //Ранее полученные показания: интервал опроса ещё не истёк
+    DHT_NO_RESPONSE, //Датчик не ответил или ответ оборвался
+    DHT_CHECKSUM_ERROR, //Не совпала контрольная сумма
+    DHT_OUT_OF_RANGE, //Показания вне диапазона измерений датчика
+    DHT_STALE, //Ранее полученные показания: свежий ответ повреждён, назначен повторный опрос
+} DHT_status;
+
 /* Структура возвращаемых датчиком данных */
 typedef struct {
-    float hum;
-    float temp;
+    int16_t temp; //Температура в десятых долях градуса
+    int16_t hum; //Влажность в десятых долях процента
+    uint32_t tick; //Время получения показаний
+    uint8_t status; //Состояние показаний (DHT_status)
+    uint8_t type; //Тип датчика (DHT_type)
 } DHT_data;
 
-/* Тип используемого датчика */
-typedef enum { DHT11, DHT22 } DHT_type;
+/* Статистика длительностей импульсов бит последнего обмена, мкс */
+typedef struct {
+    uint8_t zeroMin; //Самый короткий импульс нуля
+    uint8_t zeroMax; //Самый длинный импульс нуля
+    uint8_t oneMin; //Самый короткий импульс единицы
+    uint8_t oneMax; //Самый длинный импульс единицы
+} DHT_timing;
+
+/* Фаза обмена, на которой датчик перестал отвечать */
+typedef enum {
+    DHT_PHASE_RELEASE, //Линия не поднялась после стартового импульса
+    DHT_PHASE_RESPONSE, //Датчик не прижал линию в ответ
+    DHT_PHASE_ACK, //Оборвались импульсы подтверждения
+    DHT_PHASE_DATA, //Оборвалась передача бит
+    DHT_PHASES_COUNT,
+} DHT_phase;
+
+/* Счётчики работы драйвера с датчиком. Обновляются при каждом опросе */
+typedef struct {
+    uint32_t polls; //Опросов датчика
+    uint32_t ok; //Удачных опросов
+    uint32_t checksumErrors; //Ответов с неверной контрольной суммой
+    uint32_t rangeErrors; //Ответов с показаниями вне диапазона
+    uint32_t timeouts[DHT_PHASES_COUNT]; //Таймаутов по фазам обмена
+    uint32_t retries; //Повторных опросов после повреждённых ответов
+    uint32_t timeSum; //Суммарная длительность приёма полных ответов, мкс
+    uint16_t timeMin; //Самый быстрый приём полного ответа, мкс
+    uint16_t timeMax; //Самый долгий приём полного ответа, мкс
+    uint16_t irqMax; //Самое долгое время с выключенными прерываниями, мкс
+} DHT_stats;
+
+/* Описатель линии датчика для прямого обращения к регистрам порта */
+typedef struct {
+    volatile uint32_t* idr; //Регистр входных данных порта
+    volatile uint32_t* bsrr; //Регистр установки и сброса выводов порта
+    uint32_t setMask; //Маска вывода в IDR и маска подъёма линии в BSRR
+    uint32_t resetMask; //Маска прижатия линии к земле в BSRR
+    uint8_t index; //Номер порта в таблице портов приложения
+} DHT_line;
+
+/* Тип используемого датчика. Номера хранятся в файле датчиков, новые типы добавляются в конец */
+typedef enum {
+    DHT11,
+    DHT22, //DHT22 и AM2302
+    AM2301,
+    AM2320, //AM2320 в режиме однопроводной шины
+    DHT_TYPES_COUNT, //Количество типов датчиков
+} DHT_type;
+
+/* Результат приёма ответа датчика */
+typedef enum {
+    DHT_RESPONSE_OK, //Принято 40 бит
+    DHT_RESPONSE_ABSENT, //Датчик не ответил импульсом подтверждения
+    DHT_RESPONSE_BROKEN, //Ответ оборвался посреди передачи
+} DHT_response;
+
+/* Запись ответа датчика для анализа сигнала: длительности уровней линии по порядку */
+typedef struct {
+    uint8_t width[DHT_EDGES_MAX]; //Длительности уровней, мкс. Не больше DHT_WAVE_TIMEOUT
+    uint8_t count; //Количество записанных уровней
+    uint8_t firstLevel; //Уровень линии в первой записи, дальше уровни чередуются
+    uint8_t response; //Результат приёма (DHT_response)
+    uint8_t rawData[5]; //Принятые байты ответа
+    uint32_t tick; //Время записи
+    volatile bool ready; //Запись закончена
+} DHT_waveform;
+
+/* Пороги тревоги по показаниям. Драйвер их не проверяет, они лишь хранятся вместе с датчиком */
+typedef enum {
+    DHT_ALARM_TEMP_LOW, //Температура ниже порога
+    DHT_ALARM_TEMP_HIGH, //Температура выше порога
+    DHT_ALARM_HUM_LOW, //Влажность ниже порога
+    DHT_ALARM_HUM_HIGH, //Влажность выше порога
+    DHT_ALARMS_COUNT,
+} DHT_alarm;
+
+typedef struct {
+    int16_t limit[DHT_ALARMS_COUNT]; //Пороги в десятых долях (DHT_alarm)
+    uint8_t enabled; //Битовая маска включённых порогов
+} DHT_thresholds;
 
 /* Структура объекта датчика */
 typedef struct {
     char name[11];
     const GpioPin* GPIO; //Пин датчика
-    DHT_type type; //Тип датчика (DHT11 или DHT22)
+    DHT_line line; //Регистры пина. Заполняется DHT_initLine() при смене пина
+    DHT_type type; //Тип датчика (DHT_type)
+    uint32_t pollingInterval; //Интервал опроса, мс. 0 - минимальный для типа датчика
+    DHT_thresholds thresholds; //Пороги тревоги
+    DHT_timing timing; //Длительности импульсов последнего удачного обмена
+    DHT_stats stats; //Счётчики опросов
+    DHT_waveform* wave; //Буфер записи ответа при ближайшем опросе. Обнуляется после записи
 
 //Контроль частоты опроса датчика. Значения не заполнять!
 #if DHT_POLLING_CONTROL == 1
     uint32_t lastPollingTime; //Время последнего опроса датчика
-    float lastTemp; //Последнее значение температуры
-    float lastHum; //Последнее значение влажности
+    DHT_data last; //Последние показания
+    uint8_t missCount; //Количество опросов подряд, на которые датчик не ответил
+    uint8_t retryCount; //Количество повторных опросов подряд после повреждённых ответов
 #endif
 } DHT_sensor;
 
+/* Драйвер типа датчика: всё, чем типы датчиков отличаются друг от друга */
+typedef struct {
+    const char* name; //Название типа для меню и экранов
+    uint8_t startPulse; //Длительность стартового импульса, мс
+    uint8_t cost; //Длительность опроса от начала стартового импульса до конца ответа, мс
+    uint16_t minInterval; //Минимальный интервал опроса, мс
+    uint16_t retryDelay; //Пауза перед повторным опросом после повреждённого ответа, мс. Не меньше minInterval
+    uint16_t powerSettle; //Время установления после подачи питания, мс
+    //Приём ответа после отпускания линии
+    DHT_response (*decode)(DHT_sensor* sensor, uint8_t rawData[5], DHT_timing* timing);
+    //Перевод проверенных байт ответа в десятые доли
+    void (*convert)(const uint8_t rawData[5], DHT_data* data);
+} DHT_driver;
+
 /* Прототипы функций */
 DHT_data DHT_getData(DHT_sensor* sensor); //Получить данные с датчика
+/**
+ * @brief Драйвер типа датчика
+ *
+ * @param type Тип датчика (DHT_type)
+ * @return Указатель на драйвер или NULL, если тип неизвестен
+ */
+const DHT_driver* DHT_getDriver(uint8_t type);
+/**
+ * @brief Расчёт адресов регистров и масок пина датчика
+ * @details Вызывается один раз при назначении пина, чтобы приём ответа
+ * обращался к порту напрямую, без функций HAL
+ *
+ * @param sensor Указатель на датчик
+ * @param index Номер порта в таблице портов приложения
+ */
+void DHT_initLine(DHT_sensor* sensor, uint8_t index);
+/**
+ * @brief Интервал опроса датчика с учётом его типа и отсутствия на линии
+ *
+ * @param sensor Указатель на датчик
+ * @return Интервал до следующего опроса, мс
+ */
+uint32_t DHT_getInterval(const DHT_sensor* sensor);
+/**
+ * @brief Сброс состояния опроса датчика: последних показаний, счётчика пропусков,
+ * статистики импульсов и счётчиков опросов
+ *
+ * @param sensor Указатель на датчик
+ */
+void DHT_resetState(DHT_sensor* sensor);
+/**
+ * @brief Опрос нескольких датчиков со стартовыми импульсами внахлёст
+ * @details Датчики должны быть на разных портах. Линии отпускаются по очереди так, чтобы
+ * ответ каждого датчика читался после окончания ответа предыдущего. Следующая линия
+ * прижимается заранее, только если её стартовый импульс длиннее чтения ответа (DHT11),
+ * иначе сразу после фактического окончания чтения. Пачка не медленнее опроса по очереди
+ *
+ * @param sensors Массив указателей на датчики
+ * @param data Массив для показаний датчиков
+ * @param count Количество датчиков
+ */
+void DHT_getDataBatch(DHT_sensor* sensors[], DHT_data data[], uint8_t count);
+bool DHT_isValid(const DHT_data* data); //Показания пригодны для отображения
+/**
+ * @brief Декодирование записанного ответа датчика
+ * @details Запись переводится в фронты и разбирается тем же кодом, что и ответ,
+ * принятый по прерываниям. Служит для воспроизведения записей без датчика
+ *
+ * @param wave Запись ответа
+ * @param rawData Буфер на 5 байт для принятых данных, заполненный нулями
+ * @param timing Статистика длительностей импульсов
+ * @return Результат приёма
+ */
+DHT_response DHT_decodeWave(const DHT_waveform* wave, uint8_t rawData[5], DHT_timing* timing);
+/**
+ * @brief Проверка и конвертация сырого ответа датчика в десятые доли без плавающей точки
+ *
+ * @param type Тип датчика
+ * @param rawData Принятые 5 байт ответа
+ * @param data Показания, куда записываются значения и состояние
+ */
+void DHT_convert(DHT_type type, const uint8_t rawData[5], DHT_data* data);
+/**
+ * @brief Печать значения в десятых долях в виде десятичной дроби ("-12.3")
+ *
+ * @param str Буфер для строки
+ * @param size Размер буфера
+ * @param value Значение в десятых долях
+ * @return Длина строки без терминатора, 0 если буфер мал
+ */
+uint8_t DHT_formatTenths(char* str, uint8_t size, int16_t value);
 
 #endif
@@ -0,0 +1,137 @@
+#include "quenon_dht_mon.h"
+
+/* Тревоги по порогам показаний. Проверка, сброс и изменение размера вызываются
+ * под мутексом списка датчиков, поэтому собственного мутекса у модуля нет */
+
+//Состояние тревог датчика
+typedef struct {
+    uint32_t since[DHT_ALARMS_COUNT]; //Момент, с которого держится условие смены состояния
+    uint8_t active; //Битовая маска сработавших тревог
+    uint8_t pending; //Битовая маска тревог, ожидающих смены состояния
+} DHTMon_alarmState;
+
+static DHTMon_alarmState* alarms = NULL;
+static uint16_t alarmsCapacity = 0;
+//Количество сработавших тревог всех датчиков
+static uint16_t alarmsActive = 0;
+static NotificationApp* alarmNotifications;
+
+//Гистерезис порогов по типам тревог
+static const int16_t alarmHysteresis[DHT_ALARMS_COUNT] = {
+    DHTMON_ALARM_HYST_TEMP,
+    DHTMON_ALARM_HYST_TEMP,
+    DHTMON_ALARM_HYST_HUM,
+    DHTMON_ALARM_HYST_HUM,
+};
+
+void DHTMon_alarm_init(NotificationApp* notifications) {
+    alarmNotifications = notifications;
+    alarmsActive = 0;
+}
+
+void DHTMon_alarm_free(void) {
+    //Мигание светодиода не должно пережить приложение
+    if(alarmsActive > 0) notification_message(alarmNotifications, &sequence_blink_stop);
+    free(alarms);
+    alarms = NULL;
+    alarmsCapacity = 0;
+    alarmsActive = 0;
+}
+
+size_t DHTMon_alarm_resize(uint16_t capacity) {
+    if(capacity > alarmsCapacity) {
+        alarms = realloc(alarms, capacity * sizeof(DHTMon_alarmState));
+        memset(
+            &alarms[alarmsCapacity],
+            0,
+            (capacity - alarmsCapacity) * sizeof(DHTMon_alarmState));
+        alarmsCapacity = capacity;
+    }
+    return sizeof(DHTMon_alarmState);
+}
+
+/**
+ * @brief Учёт изменения количества сработавших тревог
+ * @details Светодиод мигает, пока сработала хоть одна тревога
+ *
+ * @param before Количество тревог до изменения
+ */
+static void DHTMon_alarm_indicate(uint16_t before) {
+    if(before == 0 && alarmsActive > 0) {
+        notification_message(alarmNotifications, &sequence_blink_start_red);
+    } else if(before > 0 && alarmsActive == 0) {
+        notification_message(alarmNotifications, &sequence_blink_stop);
+    }
+}
+
+void DHTMon_alarm_reset(uint16_t index) {
+    if(index >= alarmsCapacity) return;
+    uint16_t before = alarmsActive;
+    alarmsActive -= __builtin_popcount(alarms[index].active);
+    memset(&alarms[index], 0, sizeof(DHTMon_alarmState));
+    DHTMon_alarm_indicate(before);
+}
+
+void DHTMon_alarm_resetAll(void) {
+    uint16_t before = alarmsActive;
+    if(alarms != NULL) memset(alarms, 0, alarmsCapacity * sizeof(DHTMon_alarmState));
+    alarmsActive = 0;
+    DHTMon_alarm_indicate(before);
+}
+
+void DHTMon_alarm_remove(uint16_t index) {
+    if(index >= alarmsCapacity) return;
+    //Тревоги удалённого датчика снимаются, следующие датчики сдвигаются
+    DHTMon_alarm_reset(index);
+    uint16_t tail = alarmsCapacity - index - 1;
+    memmove(&alarms[index], &alarms[index + 1], tail * sizeof(DHTMon_alarmState));
+    memset(&alarms[alarmsCapacity - 1], 0, sizeof(DHTMon_alarmState));
+}
+
+uint8_t DHTMon_alarm_check(uint16_t index, const DHT_thresholds* thresholds, const DHT_data* data) {
+    if(index >= alarmsCapacity) return 0;
+    DHTMon_alarmState* state = &alarms[index];
+    if(data->status != DHT_OK) return state->active;
+
+    uint8_t raised = 0, cleared = 0;
+    for(uint8_t alarm = 0; alarm < DHT_ALARMS_COUNT; alarm++) {
+        uint8_t bit = 1 << alarm;
+        if(!(thresholds->enabled & bit)) continue;
+        int16_t value = alarm <= DHT_ALARM_TEMP_HIGH ? data->temp : data->hum;
+        int16_t limit = thresholds->limit[alarm];
+        bool high = alarm == DHT_ALARM_TEMP_HIGH || alarm == DHT_ALARM_HUM_HIGH;
+        bool active = state->active & bit;
+        //Тревога срабатывает за порогом, а снимается только после возврата за гистерезис
+        bool wanted;
+        if(active) {
+            wanted = high ? value > limit - alarmHysteresis[alarm] :
+                            value < limit + alarmHysteresis[alarm];
+        } else {
+            wanted = high ? value > limit : value < limit;
+        }
+        if(wanted == active) {
+            state->pending &= ~bit;
+        } else if(!(state->pending & bit)) {
+            //Состояние меняется, только если условие продержалось DHTMON_ALARM_HOLD
+            state->pending |= bit;
+            state->since[alarm] = data->tick;
+        } else if(data->tick - state->since[alarm] >= DHTMON_ALARM_HOLD) {
+            state->pending &= ~bit;
+            state->active ^= bit;
+            if(wanted) {
+                raised |= bit;
+            } else {
+                cleared |= bit;
+            }
+        }
+    }
+
+    if(raised || cleared) {
+        uint16_t before = alarmsActive;
+        alarmsActive += __builtin_popcount(raised);
+        alarmsActive -= __builtin_popcount(cleared);
+        if(raised) notification_message(alarmNotifications, &sequence_audiovisual_alert);
+        DHTMon_alarm_indicate(before);
+    }
+    return state->active;
+}
@@ -0,0 +1,245 @@
+#include "quenon_dht_mon.h"
+
+//Отметка пропуска в истории: датчик не ответил
+#define DHTMON_HISTORY_GAP INT16_MIN
+//Индекс ячейки кольца по номеру отсчёта
+#define DHTMON_HISTORY_SLOT(seq) ((seq) & (DHTMON_HISTORY_LEN - 1))
+
+//Отсчёт истории: 4 байта, показания в десятых долях
+typedef struct {
+    int16_t temp;
+    int16_t hum;
+} DHTMon_sample;
+
+//Кольцо последних показаний датчика
+typedef DHTMon_sample DHTMon_ring[DHTMON_HISTORY_LEN];
+
+//Кольца последних показаний датчиков
+static DHTMon_ring* history = NULL;
+//Количество отсчётов, добавленных в кольцо датчика. Номер следующего отсчёта
+static uint32_t* historyCount = NULL;
+static uint16_t historyCapacity = 0;
+static FuriMutex* historyMutex;
+
+/* Состояние графика. Строится только для одного отображаемого датчика */
+static int32_t watchIndex = -1;
+static DHTMon_graphMode watchMode;
+//Монотонные очереди номеров отсчётов окна: в начале minDeque - минимум, maxDeque - максимум
+static uint32_t minDeque[DHTMON_HISTORY_LEN], maxDeque[DHTMON_HISTORY_LEN];
+static uint32_t minHead, minTail, maxHead, maxTail;
+//Экранные строки столбцов графика по ячейкам кольца и масштаб, по которому они посчитаны
+static uint8_t columns[DHTMON_HISTORY_LEN];
+static int16_t scaleLow, scaleHigh;
+//Уведомление об изменении графика
+static DHTMon_historyCallback watchCallback;
+static void* watchContext;
+
+void DHTMon_history_init(void) {
+    historyMutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    DHTMon_history_reset();
+}
+
+void DHTMon_history_free(void) {
+    furi_mutex_free(historyMutex);
+    free(history);
+    free(historyCount);
+    history = NULL;
+    historyCount = NULL;
+    historyCapacity = 0;
+}
+
+size_t DHTMon_history_resize(uint16_t capacity) {
+    furi_mutex_acquire(historyMutex, FuriWaitForever);
+    if(capacity > historyCapacity) {
+        history = realloc(history, capacity * sizeof(DHTMon_ring));
+        historyCount = realloc(historyCount, capacity * sizeof(uint32_t));
+        memset(&historyCount[historyCapacity], 0, (capacity - historyCapacity) * sizeof(uint32_t));
+        historyCapacity = capacity;
+    }
+    furi_mutex_release(historyMutex);
+    return sizeof(DHTMon_ring) + sizeof(uint32_t);
+}
+
+void DHTMon_history_reset(void) {
+    furi_mutex_acquire(historyMutex, FuriWaitForever);
+    if(historyCount != NULL) memset(historyCount, 0, historyCapacity * sizeof(uint32_t));
+    watchIndex = -1;
+    furi_mutex_release(historyMutex);
+}
+
+/**
+ * @brief Отображаемое на графике значение отсчёта
+ *
+ * @param seq Номер отсчёта
+ * @return Значение в десятых долях или DHTMON_HISTORY_GAP
+ */
+static inline int16_t DHTMon_history_value(uint32_t seq) {
+    const DHTMon_sample* sample = &history[watchIndex][DHTMON_HISTORY_SLOT(seq)];
+    if(sample->temp == DHTMON_HISTORY_GAP) return DHTMON_HISTORY_GAP;
+    return watchMode == DHTMON_GRAPH_TEMP ? sample->temp : sample->hum;
+}
+
+/**
+ * @brief Строка экрана для значения в текущем масштабе
+ */
+static inline uint8_t DHTMon_history_row(int16_t value) {
+    if(value == DHTMON_HISTORY_GAP) return DHTMON_GRAPH_NONE;
+    int32_t height = DHTMON_GRAPH_HEIGHT - 1;
+    return DHTMON_GRAPH_TOP + height - (value - scaleLow) * height / (scaleHigh - scaleLow);
+}
+
+/**
+ * @brief Учёт нового отсчёта в монотонных очередях
+ * @details Вытесняет вышедшие из окна и заведомо не экстремальные номера,
+ * каждый номер добавляется и удаляется не более одного раза
+ *
+ * @param seq Номер отсчёта
+ */
+static void DHTMon_history_dequePush(uint32_t seq) {
+    while(minHead != minTail &&
+          minDeque[DHTMON_HISTORY_SLOT(minHead)] + DHTMON_HISTORY_LEN <= seq) {
+        minHead++;
+    }
+    while(maxHead != maxTail &&
+          maxDeque[DHTMON_HISTORY_SLOT(maxHead)] + DHTMON_HISTORY_LEN <= seq) {
+        maxHead++;
+    }
+    int16_t value = DHTMon_history_value(seq);
+    if(value == DHTMON_HISTORY_GAP) return;
+    while(minTail != minHead &&
+          DHTMon_history_value(minDeque[DHTMON_HISTORY_SLOT(minTail - 1)]) >= value) {
+        minTail--;
+    }
+    minDeque[DHTMON_HISTORY_SLOT(minTail++)] = seq;
+    while(maxTail != maxHead &&
+          DHTMon_history_value(maxDeque[DHTMON_HISTORY_SLOT(maxTail - 1)]) <= value) {
+        maxTail--;
+    }
+    maxDeque[DHTMON_HISTORY_SLOT(maxTail++)] = seq;
+}
+
+/**
+ * @brief Пересчёт столбца нового отсчёта
+ * @details Масштаб округляется до целых единиц, поэтому обычно меняется только
+ * новый столбец. Весь график пересчитывается лишь при выходе за прежний масштаб
+ *
+ * @param seq Номер нового отсчёта
+ */
+static void DHTMon_history_column(uint32_t seq) {
+    if(minHead == minTail) {
+        columns[DHTMON_HISTORY_SLOT(seq)] = DHTMON_GRAPH_NONE;
+        return;
+    }
+    int16_t min = DHTMon_history_value(minDeque[DHTMON_HISTORY_SLOT(minHead)]);
+    int16_t max = DHTMon_history_value(maxDeque[DHTMON_HISTORY_SLOT(maxHead)]);
+    int16_t low = min >= 0 ? min / 10 * 10 : -((-min + 9) / 10 * 10);
+    int16_t high = max >= 0 ? (max + 9) / 10 * 10 : -(-max / 10 * 10);
+    if(high == low) high += 10;
+
+    if(low != scaleLow || high != scaleHigh) {
+        scaleLow = low;
+        scaleHigh = high;
+        uint32_t count = historyCount[watchIndex];
+        uint32_t first = count > DHTMON_HISTORY_LEN ? count - DHTMON_HISTORY_LEN : 0;
+        for(uint32_t i = first; i < count; i++) {
+            columns[DHTMON_HISTORY_SLOT(i)] = DHTMon_history_row(DHTMon_history_value(i));
+        }
+    } else {
+        columns[DHTMON_HISTORY_SLOT(seq)] = DHTMon_history_row(DHTMon_history_value(seq));
+    }
+}
+
+void DHTMon_history_push(uint16_t index, const DHT_data* data) {
+    bool notify = false;
+    furi_mutex_acquire(historyMutex, FuriWaitForever);
+    if(index >= historyCapacity) {
+        furi_mutex_release(historyMutex);
+        return;
+    }
+    uint32_t seq = historyCount[index]++;
+    DHTMon_sample* sample = &history[index][DHTMON_HISTORY_SLOT(seq)];
+    if(data->status == DHT_OK) {
+        sample->temp = data->temp;
+        sample->hum = data->hum;
+    } else {
+        sample->temp = sample->hum = DHTMON_HISTORY_GAP;
+    }
+    if((int32_t)index == watchIndex) {
+        DHTMon_history_dequePush(seq);
+        DHTMon_history_column(seq);
+        notify = watchCallback != NULL;
+    }
+    furi_mutex_release(historyMutex);
+
+    //Уведомление без мутекса, чтобы отрисовка могла сразу забрать график
+    if(notify) watchCallback(watchContext);
+}
+
+void DHTMon_history_watch(
+    uint16_t index,
+    DHTMon_graphMode mode,
+    DHTMon_historyCallback callback,
+    void* context) {
+    furi_mutex_acquire(historyMutex, FuriWaitForever);
+    if(index >= historyCapacity) {
+        furi_mutex_release(historyMutex);
+        return;
+    }
+    watchIndex = index;
+    watchMode = mode;
+    watchCallback = callback;
+    watchContext = context;
+    //Однократное построение очередей по уже накопленной истории
+    minHead = minTail = maxHead = maxTail = 0;
+    scaleLow = scaleHigh = 0;
+    uint32_t count = historyCount[index];
+    uint32_t first = count > DHTMON_HISTORY_LEN ? count - DHTMON_HISTORY_LEN : 0;
+    for(uint32_t i = first; i < count; i++) {
+        DHTMon_history_dequePush(i);
+    }
+    if(count > 0) DHTMon_history_column(count - 1);
+    furi_mutex_release(historyMutex);
+}
+
+void DHTMon_history_unwatch(void) {
+    furi_mutex_acquire(historyMutex, FuriWaitForever);
+    watchIndex = -1;
+    watchCallback = NULL;
+    furi_mutex_release(historyMutex);
+}
+
+bool DHTMon_history_graph(DHTMon_graph* graph) {
+    furi_mutex_acquire(historyMutex, FuriWaitForever);
+    bool valid = watchIndex >= 0 && minHead != minTail;
+    if(valid) {
+        uint32_t count = historyCount[watchIndex];
+        graph->count = MIN(count, (uint32_t)DHTMON_HISTORY_LEN);
+        graph->first = DHTMON_HISTORY_SLOT(count - graph->count);
+        memcpy(graph->columns, columns, sizeof(columns));
+        graph->min = DHTMon_history_value(minDeque[DHTMON_HISTORY_SLOT(minHead)]);
+        graph->max = DHTMon_history_value(maxDeque[DHTMON_HISTORY_SLOT(maxHead)]);
+        graph->last = DHTMon_history_value(count - 1);
+    }
+    furi_mutex_release(historyMutex);
+    return valid;
+}
+
+void DHTMon_history_remove(uint16_t index) {
+    furi_mutex_acquire(historyMutex, FuriWaitForever);
+    if(index >= historyCapacity) {
+        furi_mutex_release(historyMutex);
+        return;
+    }
+    //История следующих датчиков сдвигается вместе с ними
+    uint16_t tail = historyCapacity - index - 1;
+    memmove(history[index], history[index + 1], tail * sizeof(DHTMon_ring));
+    memmove(&historyCount[index], &historyCount[index + 1], tail * sizeof(uint32_t));
+    historyCount[historyCapacity - 1] = 0;
+    if(watchIndex == index) {
+        watchIndex = -1;
+        watchCallback = NULL;
+    } else if(watchIndex > (int32_t)index) {
+        watchIndex--;
+    }
+    furi_mutex_release(historyMutex);
+}
@@ -0,0 +1,497 @@
+#include "quenon_dht_mon.h"
+#include <furi_hal_rtc.h>
+
+/* Формат журнала
+ * Журнал - последовательность блоков, каждый блок относится к одному датчику:
+ *   0      DHTMON_LOG_MAGIC
+ *   1      Длина блока вместе с контрольной суммой, байт
+ *   2      Количество записей в блоке
+ *   3-6    Время первой записи, unix-время (LE)
+ *   7-8    Опорная температура, десятые доли (LE)
+ *   9-10   Опорная влажность, десятые доли (LE)
+ *   11     Длина имени датчика
+ *   12-... Имя датчика без терминатора
+ *   Записи
+ *   Последние 2 байта - CRC-16/CCITT всего блока (LE)
+ * Запись - varint ((шаг времени в секундах << 3) | DHT_status). Для DHT_OK за ним
+ * идут zig-zag varint разностей температуры и влажности с предыдущими удачными
+ * показаниями блока. Оборванный при сбое питания хвост не проходит проверку
+ * контрольной суммы и пропускается при чтении
+ */
+#define DHTMON_LOG_HEADER 12 //Длина заголовка блока без имени, байт
+#define DHTMON_LOG_RECORD_MAX 11 //Наибольшая длина записи: 5 + 3 + 3 байта
+#define DHTMON_LOG_STATUS_BITS 3 //Разрядов состояния в первом поле записи
+
+//Открытый блок журнала датчика
+typedef struct {
+    uint8_t data[DHTMON_LOG_BLOCK];
+    uint8_t len; //Длина заполненной части блока, 0 - блок не начат
+    uint8_t count; //Количество записей
+    uint32_t lastTime; //Время последней записи
+    int16_t lastTemp; //Последние удачные показания
+    int16_t lastHum;
+} DHTMon_logBlock;
+
+//Кольцевой буфер готовых блоков. Заполняется потоком опроса, опустошается потоком записи
+static uint8_t ring[DHTMON_LOG_BUFFER];
+//Счётчики записанных в буфер и выгруженных на SD-карту байт. Только растут
+static uint32_t ringHead = 0, ringTail = 0;
+//Открытые блоки датчиков
+static DHTMon_logBlock* blocks = NULL;
+static uint16_t blocksCapacity = 0;
+//Мутекс кольцевого буфера и открытых блоков
+static FuriMutex* ringMutex;
+static FuriThread* loggerThread;
+static Storage* loggerStorage;
+static volatile bool loggerEnabled = false;
+//Количество блоков, не поместившихся в буфер
+static uint32_t loggerDropped = 0;
+
+/**
+ * @brief Расчёт CRC-16/CCITT
+ *
+ * @param data Данные
+ * @param len Длина данных
+ * @return Контрольная сумма
+ */
+static uint16_t DHTMon_logger_crc16(const uint8_t* data, uint8_t len) {
+    uint16_t crc = 0xFFFF;
+    for(uint8_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for(uint8_t j = 0; j < 8; j++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Запись числа в формате varint (по 7 бит, старший бит - продолжение)
+ *
+ * @param dst Буфер
+ * @param value Число
+ * @return Количество записанных байт
+ */
+static uint8_t DHTMon_logger_putVarint(uint8_t* dst, uint32_t value) {
+    uint8_t len = 0;
+    while(value >= 0x80) {
+        dst[len++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    dst[len++] = value;
+    return len;
+}
+
+/**
+ * @brief Чтение числа в формате varint
+ *
+ * @param src Буфер
+ * @param end Конец буфера
+ * @param value Прочитанное число
+ * @return Количество прочитанных байт, 0 при ошибке
+ */
+static uint8_t DHTMon_logger_getVarint(const uint8_t* src, const uint8_t* end, uint32_t* value) {
+    *value = 0;
+    for(uint8_t i = 0; i < 5 && src + i < end; i++) {
+        *value |= (uint32_t)(src[i] & 0x7F) << (7 * i);
+        if(!(src[i] & 0x80)) return i + 1;
+    }
+    return 0;
+}
+
+//Zig-zag: малые по модулю разности любого знака кодируются малыми числами
+static inline uint32_t DHTMon_logger_zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static inline int32_t DHTMon_logger_unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+/**
+ * @brief Закрытие блока: запись длины, количества, контрольной суммы и перенос в буфер
+ * @details Вызывается под мутексом буфера
+ *
+ * @param block Закрываемый блок
+ * @return true Есть данные для выгрузки на SD-карту
+ */
+static bool DHTMon_logger_seal(DHTMon_logBlock* block) {
+    if(block->len == 0) return false;
+    block->data[1] = block->len + 2;
+    block->data[2] = block->count;
+    uint16_t crc = DHTMon_logger_crc16(block->data, block->len);
+    block->data[block->len++] = crc & 0xFF;
+    block->data[block->len++] = crc >> 8;
+
+    //Блок целиком или не попадает в буфер, чтобы в журнале не было обрывков
+    if(DHTMON_LOG_BUFFER - (ringHead - ringTail) < block->len) {
+        loggerDropped++;
+    } else {
+        for(uint8_t i = 0; i < block->len; i++) {
+            ring[(ringHead + i) % DHTMON_LOG_BUFFER] = block->data[i];
+        }
+        ringHead += block->len;
+    }
+    block->len = 0;
+    return true;
+}
+
+/**
+ * @brief Начало нового блока с опорными значениями из первой записи
+ *
+ * @param block Блок
+ * @param sensor Датчик
+ * @param data Показания первой записи
+ * @param time Время первой записи
+ */
+static void DHTMon_logger_begin(
+    DHTMon_logBlock* block,
+    const DHT_sensor* sensor,
+    const DHT_data* data,
+    uint32_t time) {
+    uint8_t nameLen = strnlen(sensor->name, sizeof(sensor->name) - 1);
+    int16_t temp = data->status == DHT_OK ? data->temp : 0;
+    int16_t hum = data->status == DHT_OK ? data->hum : 0;
+    block->data[0] = DHTMON_LOG_MAGIC;
+    block->data[3] = time & 0xFF;
+    block->data[4] = (time >> 8) & 0xFF;
+    block->data[5] = (time >> 16) & 0xFF;
+    block->data[6] = time >> 24;
+    block->data[7] = (uint16_t)temp & 0xFF;
+    block->data[8] = (uint16_t)temp >> 8;
+    block->data[9] = (uint16_t)hum & 0xFF;
+    block->data[10] = (uint16_t)hum >> 8;
+    block->data[11] = nameLen;
+    memcpy(&block->data[DHTMON_LOG_HEADER], sensor->name, nameLen);
+    block->len = DHTMON_LOG_HEADER + nameLen;
+    block->count = 0;
+    block->lastTime = time;
+    block->lastTemp = temp;
+    block->lastHum = hum;
+}
+
+/**
+ * @brief Закрытие всех открытых блоков
+ *
+ * @return true Есть данные для выгрузки на SD-карту
+ */
+static bool DHTMon_logger_sealAll(void) {
+    bool sealed = false;
+    furi_mutex_acquire(ringMutex, FuriWaitForever);
+    for(uint16_t i = 0; i < blocksCapacity; i++) {
+        sealed |= DHTMon_logger_seal(&blocks[i]);
+    }
+    furi_mutex_release(ringMutex);
+    return sealed;
+}
+
+/**
+ * @brief Выгрузка буфера журнала на SD-карту
+ * @details Обычно выгружается столько, чтобы файл закончился на границе сектора,
+ * тогда каждая следующая запись начинается с нового сектора
+ *
+ * @param force Выгрузить всё содержимое буфера, не дожидаясь заполнения сектора
+ */
+static void DHTMon_logger_flush(bool force) {
+    furi_mutex_acquire(ringMutex, FuriWaitForever);
+    uint32_t start = ringTail;
+    uint32_t available = ringHead - ringTail;
+    furi_mutex_release(ringMutex);
+    if(available == 0) return;
+
+    File* file = storage_file_alloc(loggerStorage);
+    if(!storage_file_open(file, DHTMON_LOG_PATH, FSAM_WRITE, FSOM_OPEN_APPEND)) {
+        //Данные остаются в буфере до следующей попытки
+        FURI_LOG_E(APP_NAME, "cannot open log file\r\n");
+        storage_file_free(file);
+        return;
+    }
+    uint64_t size = storage_file_size(file);
+
+    uint32_t toWrite = available;
+    if(!force) {
+        //Остаток, который вылез бы за границу последнего сектора
+        uint32_t tail = (size + available) % DHTMON_LOG_SECTOR;
+        toWrite = tail < available ? available - tail : 0;
+    }
+
+    //Пока поток записи выгружает данные, поток опроса не трогает эту часть буфера
+    uint32_t written = 0;
+    while(written < toWrite) {
+        uint32_t offset = (start + written) % DHTMON_LOG_BUFFER;
+        uint32_t chunk = MIN(toWrite - written, DHTMON_LOG_BUFFER - offset);
+        uint16_t result = storage_file_write(file, &ring[offset], chunk);
+        written += result;
+        if(result != chunk) {
+            FURI_LOG_E(APP_NAME, "log write failed\r\n");
+            break;
+        }
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+
+    furi_mutex_acquire(ringMutex, FuriWaitForever);
+    ringTail += written;
+    furi_mutex_release(ringMutex);
+}
+
+//Буферы выгрузки журнала в CSV. Статические, чтобы не раздувать стек потока записи
+static uint8_t exportBlock[DHTMON_LOG_BLOCK];
+static char exportOut[DHTMON_LOG_SECTOR + DHTMON_LOG_LINE];
+
+/**
+ * @brief Преобразование записей одного блока в строки CSV
+ *
+ * @param csv Файл CSV
+ * @param outLen Заполненность буфера строк
+ * @return Количество преобразованных записей
+ */
+static uint8_t DHTMon_logger_exportBlock(File* csv, uint16_t* outLen) {
+    const uint8_t* end = exportBlock + exportBlock[1] - 2;
+    uint32_t time = exportBlock[3] | (exportBlock[4] << 8) | (exportBlock[5] << 16) |
+                    ((uint32_t)exportBlock[6] << 24);
+    int16_t temp = exportBlock[7] | (exportBlock[8] << 8);
+    int16_t hum = exportBlock[9] | (exportBlock[10] << 8);
+    char name[11];
+    uint8_t nameLen = MIN(exportBlock[11], sizeof(name) - 1);
+    memcpy(name, &exportBlock[DHTMON_LOG_HEADER], nameLen);
+    name[nameLen] = '\0';
+
+    const uint8_t* p = &exportBlock[DHTMON_LOG_HEADER + exportBlock[11]];
+    uint8_t records = 0;
+    while(records < exportBlock[2]) {
+        uint32_t head, dTemp = 0, dHum = 0;
+        uint8_t len = DHTMon_logger_getVarint(p, end, &head);
+        if(len == 0) break;
+        p += len;
+        uint8_t status = head & ((1 << DHTMON_LOG_STATUS_BITS) - 1);
+        time += head >> DHTMON_LOG_STATUS_BITS;
+        if(status == DHT_OK) {
+            len = DHTMon_logger_getVarint(p, end, &dTemp);
+            if(len == 0) break;
+            p += len;
+            len = DHTMon_logger_getVarint(p, end, &dHum);
+            if(len == 0) break;
+            p += len;
+            temp += DHTMon_logger_unzigzag(dTemp);
+            hum += DHTMon_logger_unzigzag(dHum);
+        }
+
+        char tempStr[8] = "", humStr[8] = "";
+        if(status == DHT_OK) {
+            DHT_formatTenths(tempStr, sizeof(tempStr), temp);
+            DHT_formatTenths(humStr, sizeof(humStr), hum);
+        }
+        *outLen += snprintf(
+            exportOut + *outLen,
+            sizeof(exportOut) - *outLen,
+            "%lu;%s;%s;%s;%u\n",
+            time,
+            name,
+            tempStr,
+            humStr,
+            status);
+        //Выгрузка строк посекторно
+        if(*outLen >= DHTMON_LOG_SECTOR) {
+            storage_file_write(csv, exportOut, *outLen);
+            *outLen = 0;
+        }
+        records++;
+    }
+    return records;
+}
+
+/**
+ * @brief Преобразование двоичного журнала в CSV
+ * @details Блоки с неверной контрольной суммой пропускаются, чтение продолжается
+ * с ближайшего следующего заголовка
+ */
+static void DHTMon_logger_export(void) {
+    File* log = storage_file_alloc(loggerStorage);
+    File* csv = storage_file_alloc(loggerStorage);
+    if(!storage_file_open(log, DHTMON_LOG_PATH, FSAM_READ, FSOM_OPEN_EXISTING) ||
+       !storage_file_open(csv, DHTMON_LOG_CSV_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        FURI_LOG_E(APP_NAME, "cannot open log for export\r\n");
+        storage_file_close(log);
+        storage_file_close(csv);
+        storage_file_free(log);
+        storage_file_free(csv);
+        return;
+    }
+
+    uint16_t outLen = snprintf(exportOut, sizeof(exportOut), "timestamp;sensor;temp;hum;status\n");
+    uint32_t offset = 0, records = 0, broken = 0;
+    uint64_t size = storage_file_size(log);
+    while(offset + DHTMON_LOG_HEADER + 2 <= size) {
+        storage_file_seek(log, offset, true);
+        uint16_t len = storage_file_read(log, exportBlock, sizeof(exportBlock));
+        uint8_t blockLen = exportBlock[1];
+        bool valid = len >= DHTMON_LOG_HEADER + 2 && exportBlock[0] == DHTMON_LOG_MAGIC &&
+                     blockLen >= DHTMON_LOG_HEADER + 2 && blockLen <= len &&
+                     DHTMON_LOG_HEADER + exportBlock[11] + 2 <= blockLen;
+        if(valid) {
+            uint16_t crc = exportBlock[blockLen - 2] | (exportBlock[blockLen - 1] << 8);
+            valid = DHTMon_logger_crc16(exportBlock, blockLen - 2) == crc;
+        }
+        if(!valid) {
+            //Поиск следующего блока со следующего байта
+            broken++;
+            offset++;
+            continue;
+        }
+        records += DHTMon_logger_exportBlock(csv, &outLen);
+        offset += blockLen;
+    }
+    storage_file_write(csv, exportOut, outLen);
+
+    storage_file_close(log);
+    storage_file_close(csv);
+    storage_file_free(log);
+    storage_file_free(csv);
+    FURI_LOG_I(APP_NAME, "exported %lu records, %lu bytes skipped\r\n", records, broken);
+}
+
+/**
+ * @brief Поток записи журнала на SD-карту
+ *
+ * @param context Не используется
+ * @return Код завершения
+ */
+static int32_t DHTMon_logger_thread(void* context) {
+    UNUSED(context);
+    for(;;) {
+        uint32_t flags = furi_thread_flags_wait(
+            DHTMON_LOGGER_FLAG_FLUSH | DHTMON_LOGGER_FLAG_STOP | DHTMON_LOGGER_FLAG_EXPORT |
+                DHTMON_LOGGER_FLAG_SAVE | DHTMON_LOGGER_FLAG_WAVE,
+            FuriFlagWaitAny,
+            DHTMON_LOG_FLUSH_INTERVAL);
+        if(flags & FuriFlagError) {
+            //Истёк интервал выгрузки - всё накопленное уходит на карту
+            DHTMon_logger_sealAll();
+            DHTMon_logger_flush(true);
+            continue;
+        }
+        //Поток журнала - единственный, кто пишет на SD-карту, сохранение датчиков тоже здесь
+        if(flags & DHTMON_LOGGER_FLAG_SAVE) DHTMon_sensors_save();
+        if(flags & DHTMON_LOGGER_FLAG_WAVE) DHTMon_wave_save(loggerStorage);
+        if(flags & (DHTMON_LOGGER_FLAG_STOP | DHTMON_LOGGER_FLAG_EXPORT)) {
+            DHTMon_logger_sealAll();
+            DHTMon_logger_flush(true);
+            if(flags & DHTMON_LOGGER_FLAG_EXPORT) DHTMon_logger_export();
+            if(flags & DHTMON_LOGGER_FLAG_STOP) break;
+            continue;
+        }
+        if(flags & DHTMON_LOGGER_FLAG_FLUSH) {
+            if(!loggerEnabled) DHTMon_logger_sealAll();
+            DHTMon_logger_flush(!loggerEnabled);
+        }
+    }
+    return 0;
+}
+
+void DHTMon_logger_start(Storage* storage) {
+    loggerStorage = storage;
+    ringHead = ringTail = 0;
+    loggerDropped = 0;
+    ringMutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    loggerThread = furi_thread_alloc();
+    furi_thread_set_name(loggerThread, "DHTMonLogger");
+    furi_thread_set_stack_size(loggerThread, 2048);
+    furi_thread_set_priority(loggerThread, FuriThreadPriorityLow);
+    furi_thread_set_callback(loggerThread, DHTMon_logger_thread);
+    furi_thread_start(loggerThread);
+}
+
+void DHTMon_logger_stop(void) {
+    loggerEnabled = false;
+    furi_thread_flags_set(furi_thread_get_id(loggerThread), DHTMON_LOGGER_FLAG_STOP);
+    furi_thread_join(loggerThread);
+    furi_thread_free(loggerThread);
+    furi_mutex_free(ringMutex);
+    free(blocks);
+    blocks = NULL;
+    blocksCapacity = 0;
+    if(loggerDropped > 0) {
+        FURI_LOG_W(APP_NAME, "%lu log blocks dropped\r\n", loggerDropped);
+    }
+}
+
+void DHTMon_logger_enable(bool enable) {
+    loggerEnabled = enable;
+    //При выключении накопленное сразу уходит на карту
+    if(!enable) furi_thread_flags_set(furi_thread_get_id(loggerThread), DHTMON_LOGGER_FLAG_FLUSH);
+}
+
+bool DHTMon_logger_isEnabled(void) {
+    return loggerEnabled;
+}
+
+void DHTMon_logger_exportCsv(void) {
+    furi_thread_flags_set(furi_thread_get_id(loggerThread), DHTMON_LOGGER_FLAG_EXPORT);
+}
+
+void DHTMon_logger_requestSave(void) {
+    furi_thread_flags_set(furi_thread_get_id(loggerThread), DHTMON_LOGGER_FLAG_SAVE);
+}
+
+void DHTMon_logger_requestWave(void) {
+    furi_thread_flags_set(furi_thread_get_id(loggerThread), DHTMON_LOGGER_FLAG_WAVE);
+}
+
+size_t DHTMon_logger_resize(uint16_t capacity) {
+    furi_mutex_acquire(ringMutex, FuriWaitForever);
+    if(capacity > blocksCapacity) {
+        blocks = realloc(blocks, capacity * sizeof(DHTMon_logBlock));
+        //Новые блоки не начаты
+        for(uint16_t i = blocksCapacity; i < capacity; i++) {
+            blocks[i].len = 0;
+        }
+        blocksCapacity = capacity;
+    }
+    furi_mutex_release(ringMutex);
+    return sizeof(DHTMon_logBlock);
+}
+
+void DHTMon_logger_add(uint16_t index, const DHT_sensor* sensor, const DHT_data* data) {
+    if(!loggerEnabled) return;
+
+    FuriHalRtcDateTime datetime;
+    furi_hal_rtc_get_datetime(&datetime);
+    uint32_t time = furi_hal_rtc_datetime_to_timestamp(&datetime);
+
+    furi_mutex_acquire(ringMutex, FuriWaitForever);
+    if(index >= blocksCapacity) {
+        furi_mutex_release(ringMutex);
+        return;
+    }
+    DHTMon_logBlock* block = &blocks[index];
+    //Блок закрывается, если запись может не влезть, счётчик записей переполнится,
+    //время пошло назад или на этом месте списка теперь другой датчик
+    if(block->len > 0 &&
+       (block->len + DHTMON_LOG_RECORD_MAX + 2 > DHTMON_LOG_BLOCK || block->count == UINT8_MAX ||
+        (int32_t)(time - block->lastTime) < 0 ||
+        block->data[11] != strnlen(sensor->name, sizeof(sensor->name) - 1) ||
+        memcmp(&block->data[DHTMON_LOG_HEADER], sensor->name, block->data[11]) != 0)) {
+        DHTMon_logger_seal(block);
+    }
+    if(block->len == 0) DHTMon_logger_begin(block, sensor, data, time);
+
+    //Запись: шаг времени с состоянием, для удачных показаний - разности значений
+    uint32_t head = ((time - block->lastTime) << DHTMON_LOG_STATUS_BITS) | data->status;
+    block->len += DHTMon_logger_putVarint(&block->data[block->len], head);
+    if(data->status == DHT_OK) {
+        block->len += DHTMon_logger_putVarint(
+            &block->data[block->len], DHTMon_logger_zigzag(data->temp - block->lastTemp));
+        block->len += DHTMon_logger_putVarint(
+            &block->data[block->len], DHTMon_logger_zigzag(data->hum - block->lastHum));
+        block->lastTemp = data->temp;
+        block->lastHum = data->hum;
+    }
+    block->lastTime = time;
+    block->count++;
+
+    bool flush = (ringHead - ringTail) >= DHTMON_LOG_FLUSH_THRESHOLD;
+    furi_mutex_release(ringMutex);
+
+    if(flush) furi_thread_flags_set(furi_thread_get_id(loggerThread), DHTMON_LOGGER_FLAG_FLUSH);
+}
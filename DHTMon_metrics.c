@@ -0,0 +1,140 @@
+#include "quenon_dht_mon.h"
+
+/* Производные величины считаются в целых числах с фиксированной точкой Q16.
+ * По формуле Магнуса (b = 17.62, c = 243.12 *C):
+ *   g = ln(RH) + b*T/(c + T), точка росы Td = c*g/(b - g),
+ *   давление пара e = 6.112*exp(g) гПа, абсолютная влажность 216.7*e/(T + 273.15) г/м3.
+ * Логарифм и экспонента берутся из таблиц на отрезке [1, 2] с линейной интерполяцией:
+ * ошибка интерполяции не больше 1.3e-4, что даёт не более 0.01 *C точки росы
+ * и 0.02% абсолютной влажности поверх погрешности самой формулы.
+ * Индекс жары считается точно в целых числах, расхождение с расчётом в double
+ * не больше половины десятой доли градуса */
+
+#define Q16 65536
+#define METRICS_LN2_Q16 45426 //ln(2) в Q16
+#define METRICS_B_Q16 1154744 //b = 17.62 в Q16
+#define METRICS_TABLE_BITS 5 //Шаг таблиц - 1/32
+#define METRICS_TABLE_SHIFT (16 - METRICS_TABLE_BITS)
+
+//ln(1 + i/32) в Q16
+static const uint16_t lnTable[(1 << METRICS_TABLE_BITS) + 1] = {
+    0, 2017, 3973, 5873, 7719, 9515, 11262, 12965, 14624, 16242, 17821,
+    19364, 20870, 22343, 23783, 25193, 26573, 27924, 29248, 30546, 31818, 33067,
+    34292, 35494, 36675, 37835, 38975, 40095, 41196, 42280, 43345, 44394, 45426};
+
+//2^(i/32) в Q16
+static const uint32_t exp2Table[(1 << METRICS_TABLE_BITS) + 1] = {
+    65536, 66971, 68438, 69936, 71468, 73032, 74632, 76266, 77936, 79642, 81386,
+    83169, 84990, 86851, 88752, 90696, 92682, 94711, 96785, 98905, 101070, 103283,
+    105545, 107856, 110218, 112631, 115098, 117618, 120194, 122825, 125515, 128263, 131072};
+
+/**
+ * @brief Натуральный логарифм целого числа
+ *
+ * @param x Число больше нуля
+ * @return ln(x) в Q16
+ */
+static int32_t DHTMon_metrics_ln(uint32_t x) {
+    //x = 2^k * m, m в [1, 2)
+    uint8_t k = 31 - __builtin_clz(x);
+    uint32_t m = k > 16 ? x >> (k - 16) : x << (16 - k);
+    uint32_t frac = m - Q16;
+    uint32_t i = frac >> METRICS_TABLE_SHIFT;
+    uint32_t rest = frac & ((1 << METRICS_TABLE_SHIFT) - 1);
+    int32_t lnM = lnTable[i] + (((lnTable[i + 1] - lnTable[i]) * rest) >> METRICS_TABLE_SHIFT);
+    return k * METRICS_LN2_Q16 + lnM;
+}
+
+/**
+ * @brief Экспонента
+ *
+ * @param x Показатель в Q16, от -20 до 20
+ * @return exp(x) в Q16
+ */
+static uint32_t DHTMon_metrics_exp(int32_t x) {
+    //exp(x) = 2^(x / ln2) = 2^n * 2^f, f в [0, 1)
+    int32_t y = ((int64_t)x * Q16) / METRICS_LN2_Q16;
+    int32_t n = y >> 16;
+    uint32_t frac = y & (Q16 - 1);
+    uint32_t i = frac >> METRICS_TABLE_SHIFT;
+    uint32_t rest = frac & ((1 << METRICS_TABLE_SHIFT) - 1);
+    uint32_t pow =
+        exp2Table[i] + (((exp2Table[i + 1] - exp2Table[i]) * rest) >> METRICS_TABLE_SHIFT);
+    if(n >= 15) return UINT32_MAX;
+    return n >= 0 ? pow << n : pow >> -n;
+}
+
+/**
+ * @brief Целый квадратный корень
+ */
+static uint32_t DHTMon_metrics_sqrt(uint32_t x) {
+    uint32_t root = 0;
+    for(uint32_t bit = 1UL << 30; bit > 0; bit >>= 2) {
+        if(x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+    }
+    return root;
+}
+
+/**
+ * @brief Индекс жары по методике NWS: регрессия Ротфуса с поправками
+ * @details Считается в сотых долях градуса Фаренгейта, в которые десятые доли
+ * градуса Цельсия переводятся без потерь, с коэффициентами, умноженными на 1e8
+ *
+ * @param temp Температура в десятых долях *C
+ * @param hum Влажность в десятых долях процента
+ * @return Индекс жары в десятых долях *C
+ */
+static int16_t DHTMon_metrics_heatIndex(int16_t temp, int16_t hum) {
+    int64_t f = (int32_t)temp * 18 + 3200;
+    int64_t r = hum;
+    //Упрощённая формула, достаточная, пока её среднее с температурой ниже 80 *F
+    int64_t simple = 50 * f + 305000 + 60 * (f - 6800) + 47 * r;
+    int64_t hi = simple / 100;
+    if(simple + 100 * f >= 1600000) {
+        int64_t sum = -4237900000LL * 1000000 + 204901523LL * f * 10000 +
+                      1014333127LL * r * 100000 - 22475541LL * f * r * 1000 -
+                      683783LL * f * f * 100 - 5481717LL * r * r * 10000 +
+                      122874LL * f * f * r * 10 + 85282LL * f * r * r * 100 -
+                      199LL * f * f * r * r;
+        hi = sum / 1000000000000LL;
+        if(r < 130 && f >= 8000 && f <= 11200) {
+            //Сухой воздух: ((13 - RH) / 4) * sqrt((17 - |T - 95|) / 17)
+            int64_t dist = f > 9500 ? f - 9500 : 9500 - f;
+            //Корень из доли в Q30 получается в Q15
+            uint32_t root = DHTMon_metrics_sqrt((uint32_t)(((1700 - dist) << 30) / 1700));
+            hi -= ((130 - r) * 5 * root / 2) >> 15;
+        } else if(r > 850 && f >= 8000 && f <= 8700) {
+            //Влажный воздух: ((RH - 85) / 10) * ((87 - T) / 5)
+            hi += (r - 850) * (8700 - f) / 500;
+        }
+    }
+    //Обратно в десятые доли *C с округлением
+    int64_t c = hi - 3200;
+    return c >= 0 ? (c + 9) / 18 : (c - 9) / 18;
+}
+
+void DHTMon_metrics_calc(const DHT_data* data, DHTMon_metrics* metrics) {
+    metrics->valid = DHT_isValid(data) && data->hum > 0;
+    if(!metrics->valid) return;
+    int32_t t = data->temp;
+
+    //g = ln(RH / 1000) + b*t / (10*(2431.2 + t)), RH и t в десятых долях
+    int32_t lnRH = DHTMon_metrics_ln(data->hum) - DHTMon_metrics_ln(1000);
+    int32_t gammaT = ((int64_t)1762 * t * Q16) / (10 * (24312 + 10 * t));
+    int32_t gamma = lnRH + gammaT;
+
+    //Td = c*g / (b - g), в десятых долях
+    int64_t dew = (int64_t)24312 * gamma / (METRICS_B_Q16 - gamma);
+    metrics->dewPoint = (dew + (dew >= 0 ? 5 : -5)) / 10;
+
+    //AH = 216.7 * 6.112 * exp(g) / (T + 273.15), в десятых долях г/м3
+    uint64_t ah = (uint64_t)264894 * DHTMon_metrics_exp(gamma) / (2 * t + 5463);
+    metrics->absHum = (ah + Q16 / 2) / Q16;
+
+    metrics->heatIndex = DHTMon_metrics_heatIndex(data->temp, data->hum);
+}
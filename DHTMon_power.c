@@ -0,0 +1,89 @@
+#include "quenon_dht_mon.h"
+
+/* Питание датчиков от 5V. Всё, кроме переключения режима и чтения скважности,
+ * вызывается потоком опроса под мутексом списка датчиков */
+
+//Режим экономии: питание включается только на время опроса
+static volatile bool powerSaver = false;
+//Питание включено этим модулем
+static volatile bool powerOn = false;
+//Момент включения питания
+static uint32_t powerOnTick;
+//Питание уже было подано до включения, датчики не нужно ждать
+static bool powerSettled;
+//Время работы датчиков в режиме экономии и момент его включения, мс
+static volatile uint32_t powerOnTime, powerSince;
+
+/**
+ * @brief Установка уровня линий данных всех датчиков
+ * @details Без питания линии прижимаются к земле, иначе датчик запитывается
+ * через подтяжку линии данных
+ *
+ * @param sensors Список датчиков
+ * @param count Количество датчиков
+ * @param level Уровень линий
+ */
+static void DHTMon_power_lines(DHT_sensor* sensors, uint16_t count, bool level) {
+    for(uint16_t i = 0; i < count; i++) {
+        furi_hal_gpio_write(sensors[i].GPIO, level);
+    }
+}
+
+void DHTMon_power_setSaver(bool saver) {
+    if(saver && !powerSaver) {
+        powerOnTime = 0;
+        powerSince = furi_get_tick();
+        //Питание уже включено: время работы считается с момента включения режима
+        if(powerOn) powerOnTick = powerSince;
+    }
+    powerSaver = saver;
+}
+
+bool DHTMon_power_isSaver(void) {
+    return powerSaver;
+}
+
+bool DHTMon_power_isOn(void) {
+    return powerOn;
+}
+
+void DHTMon_power_on(DHT_sensor* sensors, uint16_t count) {
+    bool enabled = furi_hal_power_is_otg_enabled();
+    if(powerOn && enabled) return;
+    powerSettled = enabled;
+    if(!enabled) furi_hal_power_enable_otg();
+    DHTMon_power_lines(sensors, count, true);
+    powerOn = true;
+    powerOnTick = furi_get_tick();
+}
+
+void DHTMon_power_off(DHT_sensor* sensors, uint16_t count) {
+    if(!powerOn) return;
+    DHTMon_power_lines(sensors, count, false);
+    furi_hal_power_disable_otg();
+    powerOn = false;
+    powerOnTime += furi_get_tick() - powerOnTick;
+}
+
+uint32_t DHTMon_power_readyTick(DHT_sensor* sensors, uint16_t count) {
+    if(powerSettled) return powerOnTick;
+    return powerOnTick + DHTMon_power_settle(sensors, count);
+}
+
+uint32_t DHTMon_power_settle(DHT_sensor* sensors, uint16_t count) {
+    uint32_t settle = 0;
+    for(uint16_t i = 0; i < count; i++) {
+        const DHT_driver* driver = DHT_getDriver(sensors[i].type);
+        if(driver != NULL && driver->powerSettle > settle) settle = driver->powerSettle;
+    }
+    return settle;
+}
+
+uint16_t DHTMon_power_duty(void) {
+    if(!powerSaver) return 1000;
+    uint32_t now = furi_get_tick();
+    uint32_t total = now - powerSince;
+    uint32_t on = powerOnTime + (powerOn ? now - powerOnTick : 0);
+    if(total == 0) return 1000;
+    return MIN((uint64_t)on * 1000 / total, 1000);
+}
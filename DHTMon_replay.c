@@ -0,0 +1,238 @@
+#include "quenon_dht_mon.h"
+
+/* Воспроизведение эталонных ответов через декодер и конвертацию драйвера без датчика.
+ * Ответы, для которых известен правильный результат, прогоняются по кругу,
+ * чтобы заодно замерить скорость разбора. Ответы составлены по даташитам и форматам
+ * датчиков, осциллограммы построены из длительностей импульсов, а не сняты с линии */
+
+//Ответ датчика: 5 байт и ожидаемый результат конвертации
+typedef struct {
+    const char* name;
+    uint8_t type; //Тип датчика (DHT_type)
+    uint8_t rawData[5];
+    uint8_t status; //Ожидаемое состояние (DHT_status)
+    int16_t temp; //Ожидаемая температура, если status - DHT_OK
+    int16_t hum; //Ожидаемая влажность
+} DHTMon_replayFrame;
+
+//Осциллограмма ответа: байты ответа, переданные импульсами заданной длительности
+typedef struct {
+    const char* name;
+    uint8_t type; //Тип датчика (DHT_type)
+    uint8_t rawData[5]; //Передаваемые байты
+    uint8_t zero; //Импульс нуля, мкс
+    uint8_t one; //Импульс единицы, мкс
+    uint8_t low; //Низкий уровень перед битом, мкс
+    uint8_t bits; //Сколько бит передано до обрыва. 0 - датчик не ответил
+    uint8_t response; //Ожидаемый результат приёма (DHT_response)
+    uint8_t status; //Ожидаемое состояние показаний, если ответ принят
+    int16_t temp;
+    int16_t hum;
+} DHTMon_replayTrace;
+
+static const DHTMon_replayFrame frames[] = {
+    {"DHT11", DHT11, {0x37, 0x00, 0x18, 0x00, 0x4F}, DHT_OK, 240, 550},
+    //ASAIR DHT11 передаёт десятые доли температуры и знак в старшем бите
+    {"ASAIR tenths", DHT11, {0x30, 0x00, 0x17, 0x07, 0x4E}, DHT_OK, 237, 480},
+    {"ASAIR negative", DHT11, {0x23, 0x00, 0x0C, 0x83, 0xB2}, DHT_OK, -123, 350},
+    {"ASAIR -20.0", DHT11, {0x14, 0x00, 0x14, 0x80, 0xA8}, DHT_OK, -200, 200},
+    //Клоны, считающие сумму только по целым частям, не проходят проверку
+    {"DHT11 clone sum", DHT11, {0x37, 0x03, 0x18, 0x05, 0x4F}, DHT_CHECKSUM_ERROR, 0, 0},
+    {"DHT22", DHT22, {0x02, 0x8C, 0x01, 0x5F, 0xEE}, DHT_OK, 351, 652},
+    {"DHT22 negative", DHT22, {0x01, 0xF4, 0x80, 0x65, 0xDA}, DHT_OK, -101, 500},
+    {"DHT22 -0.1", DHT22, {0x03, 0x20, 0x80, 0x01, 0xA4}, DHT_OK, -1, 800},
+    //Сумма переполняет байт
+    {"DHT22 limits", DHT22, {0x03, 0xE8, 0x81, 0x90, 0xFC}, DHT_OK, -400, 1000},
+    {"AM2301 +80.0", AM2301, {0x00, 0x64, 0x03, 0x20, 0x87}, DHT_OK, 800, 100},
+    {"DHT22 hum>100", DHT22, {0x04, 0x00, 0x00, 0xFA, 0xFE}, DHT_OUT_OF_RANGE, 0, 0},
+    {"DHT22 hum 0x8000", DHT22, {0x80, 0x00, 0x00, 0xC8, 0x48}, DHT_OUT_OF_RANGE, 0, 0},
+    {"DHT22 t<-40", DHT22, {0x01, 0xF4, 0x81, 0x91, 0x07}, DHT_OUT_OF_RANGE, 0, 0},
+    {"DHT22 sum+1", DHT22, {0x02, 0x8C, 0x01, 0x5F, 0xEF}, DHT_CHECKSUM_ERROR, 0, 0},
+    //Нули с верной суммой отдаёт датчик, не закончивший первое измерение после подачи питания.
+    //Прижатая к земле линия сюда не доходит: приём обрывается по таймауту
+    {"All zeros", DHT22, {0x00, 0x00, 0x00, 0x00, 0x00}, DHT_OUT_OF_RANGE, 0, 0},
+    {"DHT11 zeros", DHT11, {0x00, 0x00, 0x00, 0x00, 0x00}, DHT_OUT_OF_RANGE, 0, 0},
+    {"All ones", DHT22, {0xFF, 0xFF, 0xFF, 0xFF, 0xFF}, DHT_CHECKSUM_ERROR, 0, 0},
+    {"Unknown type", DHT_TYPES_COUNT, {0x02, 0x8C, 0x01, 0x5F, 0xEE}, DHT_NO_RESPONSE, 0, 0},
+};
+
+static const DHTMon_replayTrace traces[] = {
+    {"DHT22 nominal",
+     DHT22,
+     {0x02, 0x8C, 0x01, 0x5F, 0xEE},
+     26,
+     70,
+     50,
+     40,
+     DHT_RESPONSE_OK,
+     DHT_OK,
+     351,
+     652},
+    //Длинный кабель: фронты затянуты, импульсы нулей удлиняются, единиц - укорачиваются
+    {"DHT22 long cable",
+     DHT22,
+     {0x01, 0xF4, 0x80, 0x65, 0xDA},
+     40,
+     56,
+     62,
+     40,
+     DHT_RESPONSE_OK,
+     DHT_OK,
+     -101,
+     500},
+    {"ASAIR negative",
+     DHT11,
+     {0x23, 0x00, 0x0C, 0x83, 0xB2},
+     27,
+     71,
+     54,
+     40,
+     DHT_RESPONSE_OK,
+     DHT_OK,
+     -123,
+     350},
+    //Нули за порогом декодируются единицами, спасает только контрольная сумма
+    {"Zero over threshold",
+     DHT22,
+     {0x02, 0x8C, 0x01, 0x5F, 0xEE},
+     50,
+     70,
+     50,
+     40,
+     DHT_RESPONSE_OK,
+     DHT_CHECKSUM_ERROR,
+     0,
+     0},
+    {"Broken at bit 20",
+     DHT22,
+     {0x02, 0x8C, 0x01, 0x5F, 0xEE},
+     26,
+     70,
+     50,
+     20,
+     DHT_RESPONSE_BROKEN,
+     0,
+     0,
+     0},
+    {"No response",
+     DHT22,
+     {0x00, 0x00, 0x00, 0x00, 0x00},
+     0,
+     0,
+     0,
+     0,
+     DHT_RESPONSE_ABSENT,
+     0,
+     0,
+     0},
+};
+
+#define FRAMES_COUNT (sizeof(frames) / sizeof(frames[0]))
+#define TRACES_COUNT (sizeof(traces) / sizeof(traces[0]))
+
+//Записи, построенные по осциллограммам. Не на стеке: экран меню работает на стеке приложения
+static DHT_waveform waves[TRACES_COUNT];
+
+/**
+ * @brief Построение записи ответа в том виде, в каком её пишет приём опросом линии
+ *
+ * @param trace Осциллограмма
+ * @param wave Запись ответа
+ */
+static void DHTMon_replay_buildWave(const DHTMon_replayTrace* trace, DHT_waveform* wave) {
+    memset(wave, 0, sizeof(DHT_waveform));
+    wave->firstLevel = 0;
+    //Подъём линии подтяжкой, затем ожидание ответа датчика
+    wave->width[wave->count++] = 5;
+    if(trace->bits == 0) {
+        wave->width[wave->count++] = DHT_WAVE_TIMEOUT;
+        return;
+    }
+    wave->width[wave->count++] = 30;
+    //Импульсы подтверждения
+    wave->width[wave->count++] = 80;
+    wave->width[wave->count++] = 80;
+    for(uint8_t bit = 0; bit < trace->bits; bit++) {
+        bool one = trace->rawData[bit / 8] & (1 << (7 - bit % 8));
+        wave->width[wave->count++] = trace->low;
+        wave->width[wave->count++] = one ? trace->one : trace->zero;
+    }
+    //Оборванный ответ: датчик прижал линию перед следующим битом и больше не отпустил
+    if(trace->bits < 40) {
+        wave->width[wave->count++] = trace->low;
+        wave->width[wave->count++] = DHT_WAVE_TIMEOUT;
+    }
+}
+
+/**
+ * @brief Проверка показаний по ожидаемому результату
+ */
+static bool DHTMon_replay_match(const DHT_data* data, uint8_t status, int16_t temp, int16_t hum) {
+    if(data->status != status) return false;
+    return status != DHT_OK || (data->temp == temp && data->hum == hum);
+}
+
+/**
+ * @brief Перевод количества разборов за такты в разборы в секунду
+ */
+static uint32_t DHTMon_replay_rate(uint32_t count, uint32_t cycles) {
+    if(cycles == 0) return 0;
+    return (uint64_t)count * 1000000 * furi_hal_cortex_instructions_per_microsecond() / cycles;
+}
+
+void DHTMon_replay_run(DHTMon_replayResult* result) {
+    memset(result, 0, sizeof(DHTMon_replayResult));
+    result->frames = FRAMES_COUNT;
+    result->traces = TRACES_COUNT;
+    result->failed = NULL;
+
+    //Проверка результатов
+    for(uint8_t i = 0; i < FRAMES_COUNT; i++) {
+        DHT_data data = {.status = DHT_NO_RESPONSE};
+        DHT_convert(frames[i].type, frames[i].rawData, &data);
+        if(DHTMon_replay_match(&data, frames[i].status, frames[i].temp, frames[i].hum)) {
+            result->framesPassed++;
+        } else if(result->failed == NULL) {
+            result->failed = frames[i].name;
+        }
+    }
+    for(uint8_t i = 0; i < TRACES_COUNT; i++) {
+        const DHTMon_replayTrace* trace = &traces[i];
+        DHTMon_replay_buildWave(trace, &waves[i]);
+        uint8_t rawData[5] = {0, 0, 0, 0, 0};
+        DHT_timing timing = {.zeroMin = 255, .zeroMax = 0, .oneMin = 255, .oneMax = 0};
+        DHT_response response = DHT_decodeWave(&waves[i], rawData, &timing);
+        bool passed = response == trace->response;
+        if(passed && response == DHT_RESPONSE_OK) {
+            DHT_data data = {.status = DHT_NO_RESPONSE};
+            DHT_convert(trace->type, rawData, &data);
+            passed = DHTMon_replay_match(&data, trace->status, trace->temp, trace->hum);
+        }
+        if(passed) {
+            result->tracesPassed++;
+        } else if(result->failed == NULL) {
+            result->failed = trace->name;
+        }
+    }
+
+    //Замер скорости: тот же разбор по кругу
+    uint32_t start = DWT->CYCCNT;
+    for(uint16_t round = 0; round < DHTMON_REPLAY_ROUNDS; round++) {
+        for(uint8_t i = 0; i < FRAMES_COUNT; i++) {
+            DHT_data data;
+            DHT_convert(frames[i].type, frames[i].rawData, &data);
+        }
+    }
+    result->frameRate =
+        DHTMon_replay_rate(FRAMES_COUNT * DHTMON_REPLAY_ROUNDS, DWT->CYCCNT - start);
+    start = DWT->CYCCNT;
+    for(uint16_t round = 0; round < DHTMON_REPLAY_ROUNDS; round++) {
+        for(uint8_t i = 0; i < TRACES_COUNT; i++) {
+            uint8_t rawData[5] = {0, 0, 0, 0, 0};
+            DHT_timing timing = {.zeroMin = 255, .zeroMax = 0, .oneMin = 255, .oneMax = 0};
+            DHT_decodeWave(&waves[i], rawData, &timing);
+        }
+    }
+    result->traceRate =
+        DHTMon_replay_rate(TRACES_COUNT * DHTMON_REPLAY_ROUNDS, DWT->CYCCNT - start);
+}
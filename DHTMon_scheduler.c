@@ -0,0 +1,146 @@
+#include "quenon_dht_mon.h"
+
+//Элемент очереди опроса
+typedef struct {
+    uint32_t due; //Время, когда датчик нужно опросить
+    uint16_t index; //Индекс датчика в списке
+} DHTMon_pollItem;
+
+//Очередь опроса - двоичная куча по времени опроса, на вершине ближайший датчик
+static DHTMon_pollItem* heap = NULL;
+static uint16_t heapSize = 0;
+static uint16_t heapCapacity = 0;
+
+/**
+ * @brief Сравнение моментов времени с учётом переполнения счётчика тиков
+ *
+ * @return true Момент a наступает раньше момента b
+ */
+static inline bool DHTMon_scheduler_before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+static void DHTMon_scheduler_swap(uint16_t a, uint16_t b) {
+    DHTMon_pollItem tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+}
+
+static void DHTMon_scheduler_siftUp(uint16_t i) {
+    while(i > 0) {
+        uint16_t parent = (i - 1) / 2;
+        if(!DHTMon_scheduler_before(heap[i].due, heap[parent].due)) break;
+        DHTMon_scheduler_swap(i, parent);
+        i = parent;
+    }
+}
+
+static void DHTMon_scheduler_siftDown(uint16_t i) {
+    for(;;) {
+        uint16_t smallest = i;
+        uint32_t left = 2 * i + 1, right = 2 * i + 2;
+        if(left < heapSize && DHTMon_scheduler_before(heap[left].due, heap[smallest].due)) {
+            smallest = left;
+        }
+        if(right < heapSize && DHTMon_scheduler_before(heap[right].due, heap[smallest].due)) {
+            smallest = right;
+        }
+        if(smallest == i) break;
+        DHTMon_scheduler_swap(i, smallest);
+        i = smallest;
+    }
+}
+
+uint32_t DHTMon_scheduler_jitter(void) {
+    return furi_hal_random_get() % (DHTMON_POLL_JITTER + 1);
+}
+
+size_t DHTMon_scheduler_resize(uint16_t capacity) {
+    if(capacity > heapCapacity) {
+        heap = realloc(heap, capacity * sizeof(DHTMon_pollItem));
+        heapCapacity = capacity;
+    }
+    return sizeof(DHTMon_pollItem);
+}
+
+void DHTMon_scheduler_free(void) {
+    free(heap);
+    heap = NULL;
+    heapSize = heapCapacity = 0;
+}
+
+void DHTMon_scheduler_reset(uint16_t count) {
+    heapSize = 0;
+    uint32_t now = furi_get_tick();
+    //Первый опрос сразу, но с разбросом, чтобы датчики не просыпались на одном тике
+    for(uint16_t i = 0; i < count; i++) {
+        DHTMon_scheduler_push(i, now + DHTMon_scheduler_jitter());
+    }
+}
+
+void DHTMon_scheduler_push(uint16_t index, uint32_t due) {
+    if(heapSize >= heapCapacity) return;
+    heap[heapSize].due = due;
+    heap[heapSize].index = index;
+    DHTMon_scheduler_siftUp(heapSize++);
+}
+
+bool DHTMon_scheduler_peek(uint32_t* due) {
+    if(heapSize == 0) return false;
+    *due = heap[0].due;
+    return true;
+}
+
+bool DHTMon_scheduler_popDue(uint32_t now, uint16_t* index) {
+    if(heapSize == 0 || DHTMon_scheduler_before(now, heap[0].due)) return false;
+    *index = heap[0].index;
+    heap[0] = heap[--heapSize];
+    DHTMon_scheduler_siftDown(0);
+    return true;
+}
+
+/**
+ * @brief Поиск датчика в очереди
+ *
+ * @param index Индекс датчика в списке
+ * @return Позиция в куче, -1 если датчика в очереди нет
+ */
+static int32_t DHTMon_scheduler_find(uint16_t index) {
+    for(uint16_t i = 0; i < heapSize; i++) {
+        if(heap[i].index == index) return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Восстановление порядка кучи после изменения элемента
+ */
+static void DHTMon_scheduler_fix(uint16_t i) {
+    if(i > 0 && DHTMon_scheduler_before(heap[i].due, heap[(i - 1) / 2].due)) {
+        DHTMon_scheduler_siftUp(i);
+    } else {
+        DHTMon_scheduler_siftDown(i);
+    }
+}
+
+void DHTMon_scheduler_update(uint16_t index, uint32_t due) {
+    int32_t i = DHTMon_scheduler_find(index);
+    if(i < 0) {
+        DHTMon_scheduler_push(index, due);
+        return;
+    }
+    heap[i].due = due;
+    DHTMon_scheduler_fix(i);
+}
+
+void DHTMon_scheduler_remove(uint16_t index) {
+    int32_t i = DHTMon_scheduler_find(index);
+    if(i >= 0) {
+        heap[i] = heap[--heapSize];
+        if(i < heapSize) DHTMon_scheduler_fix(i);
+    }
+    //Датчики после удалённого сдвигаются в списке на одну позицию, порядок кучи не меняется
+    for(uint16_t j = 0; j < heapSize; j++) {
+        if(heap[j].index > index) heap[j].index--;
+    }
+}
@@ -0,0 +1,179 @@
+#include "quenon_dht_mon.h"
+
+/* Запись ответа датчика для анализа сигнала. Заказывается с экрана диагностики,
+ * записывается драйвером при ближайшем опросе датчика, разбирается потоком опроса
+ * и сохраняется на SD-карту потоком журнала. Одновременно ведётся одна запись */
+
+static DHT_waveform wave;
+static volatile DHTMon_waveState waveState = DHTMON_WAVE_IDLE;
+static DHTMon_waveReport waveReport;
+//Датчик, ответ которого записывается
+static char waveName[11];
+static uint8_t waveType;
+static const GpioPin* waveGPIO;
+
+/**
+ * @brief Уровень линии записи
+ *
+ * @param waveform Запись ответа
+ * @param index Номер записи
+ * @return 0 или 1
+ */
+static inline uint8_t DHTMon_wave_level(const DHT_waveform* waveform, uint8_t index) {
+    return (waveform->firstLevel ^ index) & 1;
+}
+
+/**
+ * @brief Поиск низкого уровня подтверждения датчика
+ * @details Приём опросом начинает запись с низкого уровня до подъёма линии, приём по
+ * прерываниям - с подъёма линии, поэтому подтверждение - первый спад после высокого уровня
+ *
+ * @param waveform Запись ответа
+ * @return Номер записи или waveform->count, если датчик не ответил
+ */
+static uint8_t DHTMon_wave_findAck(const DHT_waveform* waveform) {
+    for(uint8_t i = 1; i < waveform->count; i++) {
+        if(DHTMon_wave_level(waveform, i - 1) == 1 && DHTMon_wave_level(waveform, i) == 0) {
+            return i;
+        }
+    }
+    return waveform->count;
+}
+
+void DHTMon_wave_analyze(const DHT_waveform* waveform, DHTMon_waveReport* report) {
+    memset(report, 0, sizeof(DHTMon_waveReport));
+    report->zeroMin = report->oneMin = report->lowMin = UINT8_MAX;
+
+    uint8_t ack = DHTMon_wave_findAck(waveform);
+    if(ack + 1 < waveform->count) {
+        report->ackLow = waveform->width[ack];
+        report->ackHigh = waveform->width[ack + 1];
+    }
+    uint8_t longest = 0;
+    for(uint8_t i = ack + 2; i < waveform->count; i++) {
+        uint8_t width = waveform->width[i];
+        //Незаконченный уровень - это таймаут, а не импульс
+        if(width == DHT_WAVE_TIMEOUT) break;
+        if(width > longest) longest = width;
+        if(DHTMon_wave_level(waveform, i) == 0) {
+            report->lowMin = MIN(report->lowMin, width);
+            report->lowMax = MAX(report->lowMax, width);
+            continue;
+        }
+        if(report->bits == 40) break;
+        report->bits++;
+        if(width > DHT_BIT_THRESHOLD) {
+            report->oneMin = MIN(report->oneMin, width);
+            report->oneMax = MAX(report->oneMax, width);
+        } else {
+            report->zeroMin = MIN(report->zeroMin, width);
+            report->zeroMax = MAX(report->zeroMax, width);
+        }
+    }
+    //Запас - на сколько импульс может вырасти или укоротиться до неверного решения
+    report->zeroMargin = report->zeroMax > 0 ? DHT_BIT_THRESHOLD - report->zeroMax : 0;
+    report->oneMargin = report->oneMax > 0 ? report->oneMin - DHT_BIT_THRESHOLD : 0;
+    report->timeoutMargin = DHT_TIMEOUT_BIT - longest;
+}
+
+bool DHTMon_wave_arm(DHT_sensor* sensors, uint16_t count, DHT_sensor* sensor) {
+    //Прежняя запись ещё сохраняется
+    if(waveState == DHTMON_WAVE_CAPTURED) return false;
+    //Запись заказывается только одному датчику
+    for(uint16_t i = 0; i < count; i++) {
+        sensors[i].wave = NULL;
+    }
+    memcpy(waveName, sensor->name, sizeof(waveName));
+    waveType = sensor->type;
+    waveGPIO = sensor->GPIO;
+    wave.ready = false;
+    waveState = DHTMON_WAVE_ARMED;
+    sensor->wave = &wave;
+    return true;
+}
+
+bool DHTMon_wave_collect(void) {
+    if(waveState != DHTMON_WAVE_ARMED || !wave.ready) return false;
+    DHTMon_wave_analyze(&wave, &waveReport);
+    waveState = DHTMON_WAVE_CAPTURED;
+    return true;
+}
+
+DHTMon_waveState DHTMon_wave_state(void) {
+    return waveState;
+}
+
+const char* DHTMon_wave_sensorName(void) {
+    return waveName;
+}
+
+bool DHTMon_wave_report(DHTMon_waveReport* report) {
+    if(waveState != DHTMON_WAVE_SAVED && waveState != DHTMON_WAVE_FAILED) return false;
+    *report = waveReport;
+    return true;
+}
+
+/**
+ * @brief Название результата приёма для файла записи
+ */
+static const char* DHTMon_wave_responseName(uint8_t response) {
+    switch(response) {
+    case DHT_RESPONSE_OK:
+        return "ok";
+    case DHT_RESPONSE_ABSENT:
+        return "absent";
+    default:
+        return "broken";
+    }
+}
+
+void DHTMon_wave_save(Storage* storage) {
+    if(waveState != DHTMON_WAVE_CAPTURED) return;
+    const DHTMon_waveReport* report = &waveReport;
+    const DHT_driver* driver = DHT_getDriver(waveType);
+    Stream* stream = file_stream_alloc(storage);
+    bool written = false;
+    //Отчёт в комментариях, дальше уровни линии с временем от начала записи
+    if(file_stream_open(stream, DHTMON_WAVE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        written = stream_write_format(
+                      stream,
+                      "#DHT monitor waveform\n#Sensor: %s, %s, GPIO %s\n"
+                      "#Result: %s, data %02X %02X %02X %02X %02X\n"
+                      "#Bits: %u, ack %u/%u us\n"
+                      "#Zero: %u-%u us, margin %d us to %u us threshold\n"
+                      "#One: %u-%u us, margin %d us\n#Bit low: %u-%u us\n"
+                      "#Timeout margin: %d us to %u us\ntime_us;level;width_us\n",
+                      waveName,
+                      driver != NULL ? driver->name : "?",
+                      DHTMon_GPIO_getName(waveGPIO),
+                      DHTMon_wave_responseName(wave.response),
+                      wave.rawData[0],
+                      wave.rawData[1],
+                      wave.rawData[2],
+                      wave.rawData[3],
+                      wave.rawData[4],
+                      report->bits,
+                      report->ackLow,
+                      report->ackHigh,
+                      report->zeroMax > 0 ? report->zeroMin : 0,
+                      report->zeroMax,
+                      report->zeroMargin,
+                      DHT_BIT_THRESHOLD,
+                      report->oneMax > 0 ? report->oneMin : 0,
+                      report->oneMax,
+                      report->oneMargin,
+                      report->lowMax > 0 ? report->lowMin : 0,
+                      report->lowMax,
+                      report->timeoutMargin,
+                      DHT_TIMEOUT_BIT) > 0;
+        uint32_t time = 0;
+        for(uint8_t i = 0; i < wave.count && written; i++) {
+            written = stream_write_format(
+                          stream, "%lu;%u;%u\n", time, DHTMon_wave_level(&wave, i), wave.width[i]) > 0;
+            time += wave.width[i];
+        }
+    }
+    stream_free(stream);
+    if(!written) FURI_LOG_E(APP_NAME, "cannot write waveform file\r\n");
+    waveState = written ? DHTMON_WAVE_SAVED : DHTMON_WAVE_FAILED;
+}
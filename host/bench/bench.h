@@ -0,0 +1,25 @@
+#pragma once
+/* Замеры на компьютере: время компьютера для разбора и модельное время ядра 64 МГц
+ * для обмена по линии. Количество повторов задаётся первым аргументом */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+/**
+ * @brief Время компьютера, нс
+ */
+static inline uint64_t bench_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Количество повторов из первого аргумента
+ */
+static inline uint32_t bench_rounds(int argc, char** argv, uint32_t fallback) {
+    if(argc < 2) return fallback;
+    long rounds = strtol(argv[1], NULL, 10);
+    return rounds > 0 ? (uint32_t)rounds : fallback;
+}
@@ -0,0 +1,50 @@
+/* Время загрузки и сохранения файла датчиков в зависимости от количества датчиков */
+#include "bench.h"
+#include "fake_hal.h"
+#include "fake_app.h"
+#include "fake_storage.h"
+
+static const uint16_t sizes[] = {16, 256, 4096};
+
+int main(int argc, char** argv) {
+    uint32_t rounds = bench_rounds(argc, argv, 5);
+    fakeHal_reset(1);
+    char root[] = "/tmp/dhtmon_bench_XXXXXX";
+    if(mkdtemp(root) == NULL) return 1;
+    PluginData* app = fakeApp_start(root);
+    char path[512];
+    fakeStorage_hostPath(APP_FILEPATH, path, sizeof(path));
+    bool passed = true;
+
+    for(uint8_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        //Файл датчиков со всеми полями, в том числе порогами
+        FILE* fp = fopen(path, "wb");
+        if(fp == NULL) return 1;
+        fputs("#DHT monitor sensors file\n", fp);
+        for(uint16_t i = 0; i < sizes[s]; i++) {
+            fprintf(fp, "S%u %u %u %u -%u %u - %u\n", i, i % 4, 2 + i % 6, i % 600, i % 40, i % 80, i % 100);
+        }
+        fclose(fp);
+
+        uint64_t start = bench_ns();
+        for(uint32_t i = 0; i < rounds; i++) DHTMon_sensors_load();
+        uint64_t loadNs = (bench_ns() - start) / rounds;
+        passed &= app->sensors_count == sizes[s];
+
+        start = bench_ns();
+        uint16_t saved = 0;
+        for(uint32_t i = 0; i < rounds; i++) saved = DHTMon_sensors_save();
+        uint64_t saveNs = (bench_ns() - start) / rounds;
+        passed &= saved == sizes[s];
+
+        printf(
+            "config: %u sensors load %llu us (%llu ns per sensor), save %llu us, %u bytes per sensor\n",
+            sizes[s],
+            (unsigned long long)(loadNs / 1000),
+            (unsigned long long)(loadNs / sizes[s]),
+            (unsigned long long)(saveNs / 1000),
+            (unsigned)app->sensor_memory);
+    }
+    fakeApp_stop();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,55 @@
+/* Задержка приёма и разбора ответа: модельная длительность обмена по линии
+ * и время компьютера на приём, декодирование записи и конвертацию */
+#include "bench.h"
+#include "fake_hal.h"
+
+int main(int argc, char** argv) {
+    uint32_t rounds = bench_rounds(argc, argv, 2000);
+    fakeHal_reset(1);
+    FakeSensorTiming timing = fakeSensor_defaultTiming(DHT22);
+    timing.jitter = 3;
+    fakeSensor_attach(&gpio_ext_pa7, &timing);
+    uint8_t rawData[5];
+    fakeSensor_encode(DHT22, 235, 481, rawData);
+    fakeSensor_setFrame(&gpio_ext_pa7, rawData);
+
+    DHT_sensor sensor = {.name = "Bench", .GPIO = &gpio_ext_pa7, .type = DHT22};
+    DHT_initLine(&sensor, 0);
+    DHT_resetState(&sensor);
+    furi_hal_gpio_write(sensor.GPIO, true);
+    furi_hal_gpio_init(sensor.GPIO, GpioModeOutputOpenDrain, GpioPullUp, GpioSpeedVeryHigh);
+
+    //Приём через модель линии. Контроль частоты опроса сбрасывается перед каждым опросом
+    static DHT_waveform wave;
+    uint32_t ok = 0;
+    uint64_t start = bench_ns();
+    for(uint32_t i = 0; i < rounds; i++) {
+        sensor.lastPollingTime = 0;
+        if(i == rounds - 1) sensor.wave = &wave;
+        DHT_data data = DHT_getData(&sensor);
+        if(data.status == DHT_OK && data.temp == 235 && data.hum == 481) ok++;
+    }
+    uint64_t pollNs = (bench_ns() - start) / rounds;
+
+    //Разбор уже записанного ответа без модели линии
+    uint8_t decoded[5];
+    DHT_data data;
+    start = bench_ns();
+    for(uint32_t i = 0; i < rounds * 10; i++) {
+        memset(decoded, 0, sizeof(decoded));
+        DHT_timing pulses = {.zeroMin = 255, .oneMin = 255};
+        DHT_decodeWave(&wave, decoded, &pulses);
+        DHT_convert(DHT22, decoded, &data);
+    }
+    uint64_t decodeNs = (bench_ns() - start) / (rounds * 10);
+
+    printf("decode: %u/%u polls ok\n", ok, rounds);
+    printf(
+        "decode: modeled read %u-%u us, avg %u us\n",
+        sensor.stats.timeMin,
+        sensor.stats.timeMax,
+        sensor.stats.ok ? sensor.stats.timeSum / sensor.stats.ok : 0);
+    printf("decode: host poll through line model %llu ns\n", (unsigned long long)pollNs);
+    printf("decode: host decodeWave+convert %llu ns\n", (unsigned long long)decodeNs);
+    return ok == rounds && data.status == DHT_OK ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+/* Стоимость производных величин на одно показание: целочисленный расчёт приложения
+ * против тех же формул во float с libm */
+#include <math.h>
+#include "bench.h"
+#include "fake_hal.h"
+#include "quenon_dht_mon.h"
+
+#define SAMPLES 4096
+
+static DHT_data samples[SAMPLES];
+
+/**
+ * @brief Те же величины во float, как их считали бы в кадре
+ */
+static void bench_floatCalc(const DHT_data* data, DHTMon_metrics* metrics) {
+    float t = data->temp / 10.0f, rh = data->hum / 10.0f;
+    float gamma = logf(rh / 100.0f) + 17.62f * t / (243.12f + t);
+    metrics->dewPoint = lroundf(243.12f * gamma / (17.62f - gamma) * 10.0f);
+    metrics->absHum = lroundf(216.7f * 6.112f * expf(gamma) / (t + 273.15f) * 10.0f);
+    float f = t * 1.8f + 32.0f;
+    float hi = 0.5f * (f + 61.0f + (f - 68.0f) * 1.2f + rh * 0.094f);
+    if((hi + f) / 2 >= 80.0f) {
+        hi = -42.379f + 2.04901523f * f + 10.14333127f * rh - 0.22475541f * f * rh -
+             0.00683783f * f * f - 0.05481717f * rh * rh + 0.00122874f * f * f * rh +
+             0.00085282f * f * rh * rh - 0.00000199f * f * f * rh * rh;
+    }
+    metrics->heatIndex = lroundf((hi - 32.0f) / 1.8f * 10.0f);
+    metrics->valid = true;
+}
+
+int main(int argc, char** argv) {
+    uint32_t rounds = bench_rounds(argc, argv, 1000);
+    fakeHal_reset(1);
+    //Показания вразброс по всему диапазону датчиков
+    uint32_t rng = 1;
+    for(uint32_t i = 0; i < SAMPLES; i++) {
+        rng = rng * 1103515245 + 12345;
+        samples[i].temp = -400 + (int16_t)((rng >> 8) % 1201);
+        samples[i].hum = 1 + (int16_t)((rng >> 20) % 1000);
+        samples[i].status = DHT_OK;
+    }
+
+    //Сумма результатов не даёт компилятору выбросить расчёт
+    DHTMon_metrics metrics;
+    int64_t sum = 0;
+    uint32_t valid = 0;
+    uint64_t start = bench_ns();
+    for(uint32_t r = 0; r < rounds; r++) {
+        for(uint32_t i = 0; i < SAMPLES; i++) {
+            DHTMon_metrics_calc(&samples[i], &metrics);
+            sum += metrics.dewPoint + metrics.absHum + metrics.heatIndex;
+            valid += metrics.valid;
+        }
+    }
+    uint64_t fixedNs = bench_ns() - start;
+
+    int64_t floatSum = 0;
+    start = bench_ns();
+    for(uint32_t r = 0; r < rounds; r++) {
+        for(uint32_t i = 0; i < SAMPLES; i++) {
+            bench_floatCalc(&samples[i], &metrics);
+            floatSum += metrics.dewPoint + metrics.absHum + metrics.heatIndex;
+        }
+    }
+    uint64_t floatNs = bench_ns() - start;
+
+    uint64_t count = (uint64_t)rounds * SAMPLES;
+    printf(
+        "metrics: %u samples x %u rounds, checksum %lld/%lld\n",
+        SAMPLES,
+        rounds,
+        (long long)sum,
+        (long long)floatSum);
+    printf("metrics: host fixed point %.1f ns per sample\n", (double)fixedNs / count);
+    printf("metrics: host float with libm %.1f ns per sample\n", (double)floatNs / count);
+    return valid == count ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/* Цена таймаутов: сколько модельного времени ядра 64 МГц уходит на опрос
+ * отсутствующего датчика и на оборванный ответ, пачка датчиков против опроса по очереди */
+#include "bench.h"
+#include "fake_hal.h"
+
+static const GpioPin* const pins[] = {&gpio_ext_pa7, &gpio_ext_pa6, &gpio_ext_pa4, &gpio_ext_pb3};
+#define PINS_COUNT (sizeof(pins) / sizeof(pins[0]))
+
+static void bench_initSensor(DHT_sensor* sensor, const GpioPin* gpio, DHT_type type) {
+    memset(sensor, 0, sizeof(DHT_sensor));
+    strcpy(sensor->name, "Bench");
+    sensor->GPIO = gpio;
+    sensor->type = type;
+    DHT_initLine(sensor, 0);
+    DHT_resetState(sensor);
+    furi_hal_gpio_write(gpio, true);
+    furi_hal_gpio_init(gpio, GpioModeOutputOpenDrain, GpioPullUp, GpioSpeedVeryHigh);
+}
+
+/**
+ * @brief Модельная длительность опроса за вычетом стартового импульса, мкс
+ */
+static uint32_t bench_poll(DHT_sensor* sensor, uint8_t* status) {
+    sensor->lastPollingTime = 0;
+    uint64_t start = fakeHal_now();
+    DHT_data data = DHT_getData(sensor);
+    *status = data.status;
+    uint64_t cycles = fakeHal_now() - start;
+    cycles -= DHT_getDriver(sensor->type)->startPulse * FAKE_HAL_CYCLES_PER_MS;
+    return cycles / FAKE_HAL_CPU_MHZ;
+}
+
+/**
+ * @brief Опрос датчиков одного типа пачкой и по очереди
+ *
+ * @param present Датчики подключены и отвечают
+ * @param batchUs Модельное время опроса пачки, мкс
+ * @param singleUs Модельное время опроса тех же датчиков по очереди, мкс
+ * @return Показания пачки и опроса по очереди совпали с ожидаемыми
+ */
+static bool bench_batch(
+    DHT_type type,
+    bool present,
+    uint32_t rounds,
+    uint64_t* batchUs,
+    uint64_t* singleUs) {
+    DHT_sensor sensors[PINS_COUNT];
+    DHT_sensor* batch[PINS_COUNT];
+    DHT_data data[PINS_COUNT];
+    FakeSensorTiming timing = fakeSensor_defaultTiming(type);
+    uint8_t rawData[5];
+    fakeSensor_encode(type, 235, 481, rawData);
+    uint8_t expected = present ? DHT_OK : DHT_NO_RESPONSE;
+    for(uint8_t i = 0; i < PINS_COUNT; i++) {
+        if(present) {
+            fakeSensor_attach(pins[i], &timing);
+            fakeSensor_setFrame(pins[i], rawData);
+        }
+        bench_initSensor(&sensors[i], pins[i], type);
+        batch[i] = &sensors[i];
+    }
+    bool passed = true;
+    uint64_t batchCycles = 0, singleCycles = 0;
+    for(uint32_t i = 0; i < rounds; i++) {
+        for(uint8_t s = 0; s < PINS_COUNT; s++) sensors[s].lastPollingTime = 0;
+        uint64_t start = fakeHal_now();
+        DHT_getDataBatch(batch, data, PINS_COUNT);
+        batchCycles += fakeHal_now() - start;
+        for(uint8_t s = 0; s < PINS_COUNT; s++) passed &= data[s].status == expected;
+
+        for(uint8_t s = 0; s < PINS_COUNT; s++) sensors[s].lastPollingTime = 0;
+        start = fakeHal_now();
+        for(uint8_t s = 0; s < PINS_COUNT; s++) data[s] = DHT_getData(&sensors[s]);
+        singleCycles += fakeHal_now() - start;
+        for(uint8_t s = 0; s < PINS_COUNT; s++) passed &= data[s].status == expected;
+    }
+    if(present) {
+        for(uint8_t i = 0; i < PINS_COUNT; i++) fakeSensor_detach(pins[i]);
+    }
+    *batchUs = batchCycles / rounds / FAKE_HAL_CPU_MHZ;
+    *singleUs = singleCycles / rounds / FAKE_HAL_CPU_MHZ;
+    return passed;
+}
+
+int main(int argc, char** argv) {
+    uint32_t rounds = bench_rounds(argc, argv, 200);
+    fakeHal_reset(1);
+    DHT_sensor sensor;
+    uint8_t status;
+    bool passed = true;
+
+    //Датчика нет: линия поднимается подтяжкой и ждёт ответа до таймаута
+    bench_initSensor(&sensor, &gpio_ext_pa7, DHT22);
+    uint64_t absent = 0;
+    for(uint32_t i = 0; i < rounds; i++) {
+        absent += bench_poll(&sensor, &status);
+        passed &= status == DHT_NO_RESPONSE;
+    }
+    passed &= sensor.stats.timeouts[DHT_PHASE_RESPONSE] == rounds;
+
+    //Ответ обрывается на 20-м бите, линия остаётся прижатой до таймаута бита
+    FakeSensorTiming timing = fakeSensor_defaultTiming(DHT22);
+    timing.bits = 20;
+    fakeSensor_attach(&gpio_ext_pa7, &timing);
+    uint8_t rawData[5];
+    fakeSensor_encode(DHT22, 235, 481, rawData);
+    fakeSensor_setFrame(&gpio_ext_pa7, rawData);
+    bench_initSensor(&sensor, &gpio_ext_pa7, DHT22);
+    uint64_t broken = 0;
+    for(uint32_t i = 0; i < rounds; i++) {
+        DHT_resetState(&sensor);
+        broken += bench_poll(&sensor, &status);
+    }
+    passed &= sensor.stats.timeouts[DHT_PHASE_DATA] == 1;
+
+    //Полный ответ для сравнения
+    timing.bits = 40;
+    fakeSensor_setTiming(&gpio_ext_pa7, &timing);
+    uint64_t full = 0;
+    for(uint32_t i = 0; i < rounds; i++) {
+        full += bench_poll(&sensor, &status);
+        passed &= status == DHT_OK;
+    }
+    fakeSensor_detach(&gpio_ext_pa7);
+
+    printf("timeout: absent sensor %llu us per poll\n", (unsigned long long)(absent / rounds));
+    printf("timeout: broken at bit 20 %llu us per poll\n", (unsigned long long)(broken / rounds));
+    printf("timeout: full response %llu us per poll\n", (unsigned long long)(full / rounds));
+
+    //Пачка против опроса по очереди: у DHT11 стартовые импульсы прячутся под чтение
+    //ответов, у DHT22 выигрыша нет, но и проигрыша быть не должно
+    static const DHT_type types[] = {DHT11, DHT22};
+    for(uint8_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+        for(uint8_t present = 0; present < 2; present++) {
+            uint64_t batchUs, singleUs;
+            passed &= bench_batch(types[t], present, rounds, &batchUs, &singleUs);
+            //Запас на тик, прибавляемый к импульсу в пачке
+            passed &= batchUs <= singleUs + 1000;
+            //Отвечающие DHT11 в пачке укладываются заметно быстрее суммы одиночных опросов
+            if(types[t] == DHT11 && present) passed &= batchUs * 10 < singleUs * 6;
+            printf(
+                "timeout: %s batch of %u %s sensors %llu us, one by one %llu us\n",
+                DHT_getDriver(types[t])->name,
+                (unsigned)PINS_COUNT,
+                present ? "present" : "absent",
+                (unsigned long long)batchUs,
+                (unsigned long long)singleUs);
+        }
+    }
+    return passed ? 0 : 1;
+}
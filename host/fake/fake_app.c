@@ -0,0 +1,54 @@
+/* Данные плагина статические, поэтому приложение собирается прямо в этот файл */
+#include <gui/gui.h>
+//Обработчик кнопок главного экрана принимает очередь вместо void*, как и в прошивке
+#define view_port_input_callback_set(view_port, callback, context) \
+    view_port_input_callback_set(view_port, (ViewPortInputCallback)(callback), context)
+#include "../../quenon_dht_mon.c"
+#include "fake_app.h"
+#include "fake_gui.h"
+#include "fake_storage.h"
+
+PluginData* fakeApp_start(const char* root) {
+    fakeStorage_setRoot(root);
+    furi_check(DHTMon_alloc());
+    app->last_OTG_State = furi_hal_power_is_otg_enabled();
+    DHTMon_logger_start(app->storage);
+    return app;
+}
+
+void fakeApp_stop(void) {
+    DHTMon_poller_stop();
+    DHTMon_logger_stop();
+    DHTMon_sensors_deinit();
+    DHTMon_free();
+    app = NULL;
+}
+
+void fakeApp_publish(uint16_t index, const DHT_data* data, uint8_t alarms) {
+    furi_mutex_acquire(app->readings_mutex, FuriWaitForever);
+    DHTMon_reading* reading = &app->readings[index];
+    reading->data = *data;
+    reading->alarms = alarms;
+    if(data->status == DHT_OK) {
+        DHTMon_metrics_calc(data, &reading->metrics);
+    } else if(!DHT_isValid(data)) {
+        reading->metrics.valid = false;
+    }
+    furi_mutex_release(app->readings_mutex);
+}
+
+void fakeApp_draw(void) {
+    fakeGui_drawViewPort(app->view_port);
+}
+
+void fakeApp_exportLog(const char* logPath, const char* csvPath) {
+    fakeStorage_map(DHTMON_LOG_PATH, logPath);
+    fakeStorage_map(DHTMON_LOG_CSV_PATH, csvPath);
+    //Остановка потока выполняется после запрошенного преобразования
+    DHTMon_logger_exportCsv();
+    DHTMon_logger_stop();
+    DHTMon_logger_start(app->storage);
+    DHTMon_logger_resize(app->sensors_capacity);
+    fakeStorage_map(DHTMON_LOG_PATH, NULL);
+    fakeStorage_map(DHTMON_LOG_CSV_PATH, NULL);
+}
@@ -0,0 +1,36 @@
+#pragma once
+/* Приложение на модели: данные плагина без цикла событий и потока опроса.
+ * Поток журнала работает по-настоящему, показания публикуются прямо из проверок */
+#include "quenon_dht_mon.h"
+
+/**
+ * @brief Выделение данных плагина и запуск потока журнала
+ *
+ * @param root Каталог компьютера, в который отображается /ext
+ * @return Данные плагина
+ */
+PluginData* fakeApp_start(const char* root);
+/**
+ * @brief Остановка потоков, освобождение портов и данных плагина
+ */
+void fakeApp_stop(void);
+/**
+ * @brief Публикация показаний датчика в снимок для отрисовки, как это делает поток опроса
+ *
+ * @param index Индекс датчика в списке
+ * @param data Показания
+ * @param alarms Битовая маска сработавших тревог
+ */
+void fakeApp_publish(uint16_t index, const DHT_data* data, uint8_t alarms);
+/**
+ * @brief Отрисовка главного экрана на холст модели
+ */
+void fakeApp_draw(void);
+/**
+ * @brief Преобразование журнала в CSV потоком журнала, как по команде из меню
+ * @details Дожидается окончания преобразования: поток журнала останавливается и запускается снова
+ *
+ * @param logPath Двоичный журнал на компьютере или NULL - журнал в каталоге модели
+ * @param csvPath Файл CSV на компьютере или NULL - файл в каталоге модели
+ */
+void fakeApp_exportLog(const char* logPath, const char* csvPath);
@@ -0,0 +1,8 @@
+#pragma once
+/* Подключается к каждому файлу приложения ключом -include. На Flipper Zero uint32_t -
+ * это unsigned long, и приложение печатает его через %lu. snprintf приложения идёт через
+ * fakeHal_snprintf, который заменяет %lu на %u так же, как журнал и потоки модели */
+#include <stdio.h>
+
+int fakeHal_snprintf(char* str, size_t size, const char* format, ...);
+#define snprintf fakeHal_snprintf
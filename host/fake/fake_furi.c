@@ -0,0 +1,309 @@
+#include "fake_hal.h"
+#include <notification/notification_messages.h>
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+
+/* Ядро furi поверх pthreads. Ожидания с таймаутом идут по часам компьютера:
+ * потоки приложения ждут событий от других потоков, а не от модели линии */
+
+struct FuriMutex {
+    pthread_mutex_t mutex;
+};
+
+struct FuriThread {
+    pthread_t handle;
+    const char* name;
+    FuriThreadCallback callback;
+    void* context;
+    int32_t result;
+    bool started;
+    uint32_t flags;
+    pthread_mutex_t flagsMutex;
+    pthread_cond_t flagsCond;
+};
+
+struct FuriMessageQueue {
+    uint8_t* data;
+    uint32_t size;
+    uint32_t capacity;
+    uint32_t head, count;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+};
+
+struct NotificationSequence {
+    const char* name;
+};
+
+const NotificationSequence sequence_display_backlight_enforce_on = {"backlight on"};
+const NotificationSequence sequence_display_backlight_enforce_auto = {"backlight auto"};
+const NotificationSequence sequence_audiovisual_alert = {"alert"};
+const NotificationSequence sequence_blink_start_red = {"blink red"};
+const NotificationSequence sequence_blink_stop = {"blink stop"};
+
+static __thread FuriThread* currentThread = NULL;
+static const NotificationSequence* lastNotification = NULL;
+static uint32_t notificationCount = 0;
+
+/**
+ * @brief Момент через timeout мс по часам компьютера
+ */
+static struct timespec fakeFuri_deadline(uint32_t timeout) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (long)(timeout % 1000) * 1000000L;
+    if(deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return deadline;
+}
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    FuriMutex* instance = malloc(sizeof(FuriMutex));
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(
+        &attr, type == FuriMutexTypeRecursive ? PTHREAD_MUTEX_RECURSIVE : PTHREAD_MUTEX_NORMAL);
+    pthread_mutex_init(&instance->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return instance;
+}
+
+void furi_mutex_free(FuriMutex* instance) {
+    pthread_mutex_destroy(&instance->mutex);
+    free(instance);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* instance, uint32_t timeout) {
+    if(timeout == FuriWaitForever) {
+        return pthread_mutex_lock(&instance->mutex) == 0 ? FuriStatusOk : FuriStatusError;
+    }
+    struct timespec deadline = fakeFuri_deadline(timeout);
+    int result = pthread_mutex_timedlock(&instance->mutex, &deadline);
+    if(result == ETIMEDOUT) return FuriStatusErrorTimeout;
+    return result == 0 ? FuriStatusOk : FuriStatusError;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* instance) {
+    return pthread_mutex_unlock(&instance->mutex) == 0 ? FuriStatusOk : FuriStatusError;
+}
+
+/**
+ * @brief Описатель потока, который не создавался через furi_thread_alloc (основной)
+ */
+static FuriThread* fakeFuri_current(void) {
+    if(currentThread == NULL) {
+        currentThread = furi_thread_alloc();
+        currentThread->name = "main";
+    }
+    return currentThread;
+}
+
+FuriThread* furi_thread_alloc(void) {
+    FuriThread* thread = calloc(1, sizeof(FuriThread));
+    pthread_mutex_init(&thread->flagsMutex, NULL);
+    pthread_cond_init(&thread->flagsCond, NULL);
+    return thread;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    pthread_mutex_destroy(&thread->flagsMutex);
+    pthread_cond_destroy(&thread->flagsCond);
+    free(thread);
+}
+
+void furi_thread_set_name(FuriThread* thread, const char* name) {
+    thread->name = name;
+}
+
+void furi_thread_set_stack_size(FuriThread* thread, size_t stack_size) {
+    UNUSED(thread);
+    UNUSED(stack_size);
+}
+
+void furi_thread_set_context(FuriThread* thread, void* context) {
+    thread->context = context;
+}
+
+void furi_thread_set_callback(FuriThread* thread, FuriThreadCallback callback) {
+    thread->callback = callback;
+}
+
+void furi_thread_set_priority(FuriThread* thread, FuriThreadPriority priority) {
+    UNUSED(thread);
+    UNUSED(priority);
+}
+
+static void* fakeFuri_threadBody(void* arg) {
+    FuriThread* thread = arg;
+    currentThread = thread;
+    thread->result = thread->callback(thread->context);
+    return NULL;
+}
+
+void furi_thread_start(FuriThread* thread) {
+    thread->started = pthread_create(&thread->handle, NULL, fakeFuri_threadBody, thread) == 0;
+    furi_check(thread->started);
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    if(!thread->started) return false;
+    pthread_join(thread->handle, NULL);
+    thread->started = false;
+    return true;
+}
+
+FuriThreadId furi_thread_get_id(FuriThread* thread) {
+    return thread;
+}
+
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags) {
+    pthread_mutex_lock(&thread_id->flagsMutex);
+    thread_id->flags |= flags;
+    uint32_t result = thread_id->flags;
+    pthread_cond_broadcast(&thread_id->flagsCond);
+    pthread_mutex_unlock(&thread_id->flagsMutex);
+    return result;
+}
+
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    FuriThread* thread = fakeFuri_current();
+    struct timespec deadline = fakeFuri_deadline(timeout);
+    uint32_t result = FuriFlagErrorTimeout;
+    pthread_mutex_lock(&thread->flagsMutex);
+    for(;;) {
+        uint32_t ready = thread->flags & flags;
+        bool done = (options & FuriFlagWaitAll) ? ready == flags : ready != 0;
+        if(done) {
+            result = ready;
+            if(!(options & FuriFlagNoClear)) thread->flags &= ~ready;
+            break;
+        }
+        if(timeout == 0) break;
+        if(timeout == FuriWaitForever) {
+            pthread_cond_wait(&thread->flagsCond, &thread->flagsMutex);
+        } else if(
+            pthread_cond_timedwait(&thread->flagsCond, &thread->flagsMutex, &deadline) ==
+            ETIMEDOUT) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&thread->flagsMutex);
+    return result;
+}
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size) {
+    FuriMessageQueue* instance = calloc(1, sizeof(FuriMessageQueue));
+    instance->data = malloc(msg_count * msg_size);
+    instance->size = msg_size;
+    instance->capacity = msg_count;
+    pthread_mutex_init(&instance->mutex, NULL);
+    pthread_cond_init(&instance->cond, NULL);
+    return instance;
+}
+
+void furi_message_queue_free(FuriMessageQueue* instance) {
+    pthread_mutex_destroy(&instance->mutex);
+    pthread_cond_destroy(&instance->cond);
+    free(instance->data);
+    free(instance);
+}
+
+/**
+ * @brief Ожидание условия очереди под её мутексом
+ *
+ * @return true Условие выполнено до таймаута
+ */
+static bool fakeFuri_queueWait(FuriMessageQueue* instance, bool forPut, uint32_t timeout) {
+    struct timespec deadline = fakeFuri_deadline(timeout);
+    for(;;) {
+        bool ready = forPut ? instance->count < instance->capacity : instance->count > 0;
+        if(ready) return true;
+        if(timeout == 0) return false;
+        if(timeout == FuriWaitForever) {
+            pthread_cond_wait(&instance->cond, &instance->mutex);
+        } else if(pthread_cond_timedwait(&instance->cond, &instance->mutex, &deadline) == ETIMEDOUT) {
+            return false;
+        }
+    }
+}
+
+FuriStatus furi_message_queue_put(FuriMessageQueue* instance, const void* msg, uint32_t timeout) {
+    pthread_mutex_lock(&instance->mutex);
+    FuriStatus status = FuriStatusErrorTimeout;
+    if(fakeFuri_queueWait(instance, true, timeout)) {
+        uint32_t slot = (instance->head + instance->count) % instance->capacity;
+        memcpy(&instance->data[slot * instance->size], msg, instance->size);
+        instance->count++;
+        pthread_cond_broadcast(&instance->cond);
+        status = FuriStatusOk;
+    }
+    pthread_mutex_unlock(&instance->mutex);
+    return status;
+}
+
+FuriStatus furi_message_queue_get(FuriMessageQueue* instance, void* msg, uint32_t timeout) {
+    pthread_mutex_lock(&instance->mutex);
+    FuriStatus status = FuriStatusErrorTimeout;
+    if(fakeFuri_queueWait(instance, false, timeout)) {
+        memcpy(msg, &instance->data[instance->head * instance->size], instance->size);
+        instance->head = (instance->head + 1) % instance->capacity;
+        instance->count--;
+        pthread_cond_broadcast(&instance->cond);
+        status = FuriStatusOk;
+    }
+    pthread_mutex_unlock(&instance->mutex);
+    return status;
+}
+
+void* furi_record_open(const char* name) {
+    //Записи модели ничего не хранят, важно только, что они не NULL
+    return (void*)name;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+bool init_mutex(ValueMutex* valuemutex, void* value, size_t size) {
+    UNUSED(size);
+    valuemutex->value = value;
+    valuemutex->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    return valuemutex->mutex != NULL;
+}
+
+bool delete_mutex(ValueMutex* valuemutex) {
+    furi_mutex_free(valuemutex->mutex);
+    return true;
+}
+
+void* acquire_mutex(ValueMutex* valuemutex, uint32_t timeout) {
+    if(furi_mutex_acquire(valuemutex->mutex, timeout) != FuriStatusOk) return NULL;
+    return valuemutex->value;
+}
+
+void* acquire_mutex_block(ValueMutex* valuemutex) {
+    return acquire_mutex(valuemutex, FuriWaitForever);
+}
+
+bool release_mutex(ValueMutex* valuemutex, const void* value) {
+    if(value != valuemutex->value) return false;
+    return furi_mutex_release(valuemutex->mutex) == FuriStatusOk;
+}
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence) {
+    UNUSED(app);
+    lastNotification = sequence;
+    notificationCount++;
+}
+
+const char* fakeHal_lastNotification(void) {
+    return lastNotification != NULL ? lastNotification->name : NULL;
+}
+
+uint32_t fakeHal_notifications(void) {
+    return notificationCount;
+}
@@ -0,0 +1,535 @@
+#include "fake_gui.h"
+#include <gui/elements.h>
+#include <gui/modules/text_input.h>
+
+#define FAKE_GUI_ITEMS 32
+#define FAKE_GUI_VIEWS 16
+#define FAKE_GUI_TEXT 2048
+
+struct Canvas {
+    uint32_t calls;
+    char text[FAKE_GUI_TEXT];
+    size_t textLen;
+};
+
+struct ViewPort {
+    ViewPortDrawCallback draw;
+    void* drawContext;
+    ViewPortInputCallback input;
+    void* inputContext;
+    bool enabled;
+};
+
+typedef enum {
+    FakeViewPlain,
+    FakeViewItemList,
+    FakeViewWidget,
+    FakeViewTextInput,
+} FakeViewKind;
+
+struct View {
+    ViewDrawCallback draw;
+    ViewInputCallback input;
+    ViewNavigationCallback previous;
+    ViewCallback exit;
+    void* context;
+    void* model;
+    FakeViewKind kind;
+    void* owner;
+};
+
+struct ViewDispatcher {
+    uint32_t ids[FAKE_GUI_VIEWS];
+    View* views[FAKE_GUI_VIEWS];
+    uint8_t count;
+    uint32_t current;
+};
+
+struct VariableItem {
+    char label[32];
+    char text[32];
+    uint8_t values;
+    uint8_t index;
+    VariableItemChangeCallback change;
+    void* context;
+};
+
+struct VariableItemList {
+    View view;
+    VariableItem items[FAKE_GUI_ITEMS];
+    uint8_t count;
+    uint8_t selected;
+    VariableItemListEnterCallback enter;
+    void* enterContext;
+};
+
+struct Widget {
+    View view;
+    char text[FAKE_GUI_TEXT];
+    size_t textLen;
+};
+
+struct TextInput {
+    View view;
+    TextInputCallback callback;
+    void* callbackContext;
+    char* buffer;
+    size_t bufferSize;
+};
+
+static Canvas canvas;
+
+/**
+ * @brief Добавление строки к тексту через перевод строки
+ */
+static void fakeGui_append(char* text, size_t* len, size_t size, const char* str) {
+    int written = snprintf(&text[*len], size - *len, "%s\n", str);
+    if(written > 0) *len = MIN(*len + written, size - 1);
+}
+
+void fakeGui_canvasReset(void) {
+    canvas.calls = 0;
+    canvas.text[0] = '\0';
+    canvas.textLen = 0;
+}
+
+uint32_t fakeGui_canvasCalls(void) {
+    return canvas.calls;
+}
+
+const char* fakeGui_canvasText(void) {
+    return canvas.text;
+}
+
+void canvas_clear(Canvas* canvas) {
+    canvas->calls++;
+}
+
+void canvas_set_color(Canvas* canvas, Color color) {
+    UNUSED(color);
+    canvas->calls++;
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    UNUSED(font);
+    canvas->calls++;
+}
+
+void canvas_draw_str(Canvas* canvas, uint8_t x, uint8_t y, const char* str) {
+    UNUSED(x);
+    UNUSED(y);
+    canvas->calls++;
+    fakeGui_append(canvas->text, &canvas->textLen, sizeof(canvas->text), str);
+}
+
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical,
+    const char* str) {
+    UNUSED(horizontal);
+    UNUSED(vertical);
+    canvas_draw_str(canvas, x, y, str);
+}
+
+void canvas_draw_box(Canvas* canvas, uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(width);
+    UNUSED(height);
+    canvas->calls++;
+}
+
+void canvas_draw_line(Canvas* canvas, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
+    UNUSED(x1);
+    UNUSED(y1);
+    UNUSED(x2);
+    UNUSED(y2);
+    canvas->calls++;
+}
+
+void canvas_draw_dot(Canvas* canvas, uint8_t x, uint8_t y) {
+    UNUSED(x);
+    UNUSED(y);
+    canvas->calls++;
+}
+
+void elements_scrollbar_pos(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t height,
+    uint16_t pos,
+    uint16_t total) {
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(height);
+    UNUSED(pos);
+    UNUSED(total);
+    canvas->calls++;
+}
+
+ViewPort* view_port_alloc(void) {
+    ViewPort* view_port = calloc(1, sizeof(ViewPort));
+    view_port->enabled = true;
+    return view_port;
+}
+
+void view_port_free(ViewPort* view_port) {
+    free(view_port);
+}
+
+void view_port_update(ViewPort* view_port) {
+    UNUSED(view_port);
+}
+
+void view_port_enabled_set(ViewPort* view_port, bool enabled) {
+    view_port->enabled = enabled;
+}
+
+void view_port_draw_callback_set(ViewPort* view_port, ViewPortDrawCallback callback, void* context) {
+    view_port->draw = callback;
+    view_port->drawContext = context;
+}
+
+void view_port_input_callback_set(
+    ViewPort* view_port,
+    ViewPortInputCallback callback,
+    void* context) {
+    view_port->input = callback;
+    view_port->inputContext = context;
+}
+
+void gui_add_view_port(Gui* gui, ViewPort* view_port, GuiLayer layer) {
+    UNUSED(gui);
+    UNUSED(view_port);
+    UNUSED(layer);
+}
+
+void gui_remove_view_port(Gui* gui, ViewPort* view_port) {
+    UNUSED(gui);
+    UNUSED(view_port);
+}
+
+void fakeGui_drawViewPort(ViewPort* view_port) {
+    fakeGui_canvasReset();
+    if(view_port->draw != NULL) view_port->draw(&canvas, view_port->drawContext);
+}
+
+static void fakeGui_initView(View* view, FakeViewKind kind, void* owner) {
+    memset(view, 0, sizeof(View));
+    view->kind = kind;
+    view->owner = owner;
+}
+
+View* view_alloc(void) {
+    View* view = malloc(sizeof(View));
+    fakeGui_initView(view, FakeViewPlain, NULL);
+    return view;
+}
+
+void view_free(View* view) {
+    free(view->model);
+    free(view);
+}
+
+void view_set_draw_callback(View* view, ViewDrawCallback callback) {
+    view->draw = callback;
+}
+
+void view_set_input_callback(View* view, ViewInputCallback callback) {
+    view->input = callback;
+}
+
+void view_set_previous_callback(View* view, ViewNavigationCallback callback) {
+    view->previous = callback;
+}
+
+void view_set_exit_callback(View* view, ViewCallback callback) {
+    view->exit = callback;
+}
+
+void view_set_context(View* view, void* context) {
+    view->context = context;
+}
+
+void view_allocate_model(View* view, ViewModelType type, size_t size) {
+    UNUSED(type);
+    view->model = calloc(1, size);
+}
+
+void* view_get_model(View* view) {
+    return view->model;
+}
+
+void view_commit_model(View* view, bool update) {
+    UNUSED(view);
+    UNUSED(update);
+}
+
+void fakeGui_drawView(View* view) {
+    fakeGui_canvasReset();
+    if(view->draw != NULL) view->draw(&canvas, view->model);
+}
+
+ViewDispatcher* view_dispatcher_alloc(void) {
+    ViewDispatcher* view_dispatcher = calloc(1, sizeof(ViewDispatcher));
+    view_dispatcher->current = VIEW_NONE;
+    return view_dispatcher;
+}
+
+void view_dispatcher_free(ViewDispatcher* view_dispatcher) {
+    free(view_dispatcher);
+}
+
+void view_dispatcher_enable_queue(ViewDispatcher* view_dispatcher) {
+    UNUSED(view_dispatcher);
+}
+
+void view_dispatcher_attach_to_gui(
+    ViewDispatcher* view_dispatcher,
+    Gui* gui,
+    ViewDispatcherType type) {
+    UNUSED(view_dispatcher);
+    UNUSED(gui);
+    UNUSED(type);
+}
+
+void view_dispatcher_add_view(ViewDispatcher* view_dispatcher, uint32_t view_id, View* view) {
+    furi_check(view_dispatcher->count < FAKE_GUI_VIEWS);
+    view_dispatcher->ids[view_dispatcher->count] = view_id;
+    view_dispatcher->views[view_dispatcher->count] = view;
+    view_dispatcher->count++;
+}
+
+void view_dispatcher_remove_view(ViewDispatcher* view_dispatcher, uint32_t view_id) {
+    for(uint8_t i = 0; i < view_dispatcher->count; i++) {
+        if(view_dispatcher->ids[i] != view_id) continue;
+        view_dispatcher->count--;
+        view_dispatcher->ids[i] = view_dispatcher->ids[view_dispatcher->count];
+        view_dispatcher->views[i] = view_dispatcher->views[view_dispatcher->count];
+        break;
+    }
+}
+
+void view_dispatcher_switch_to_view(ViewDispatcher* view_dispatcher, uint32_t view_id) {
+    view_dispatcher->current = view_id;
+}
+
+void view_dispatcher_run(ViewDispatcher* view_dispatcher) {
+    UNUSED(view_dispatcher);
+}
+
+View* fakeGui_dispatcherView(ViewDispatcher* view_dispatcher, uint32_t view_id) {
+    for(uint8_t i = 0; i < view_dispatcher->count; i++) {
+        if(view_dispatcher->ids[i] == view_id) return view_dispatcher->views[i];
+    }
+    return NULL;
+}
+
+uint32_t fakeGui_currentViewId(ViewDispatcher* view_dispatcher) {
+    return view_dispatcher->current;
+}
+
+VariableItemList* variable_item_list_alloc(void) {
+    VariableItemList* list = calloc(1, sizeof(VariableItemList));
+    fakeGui_initView(&list->view, FakeViewItemList, list);
+    return list;
+}
+
+void variable_item_list_free(VariableItemList* variable_item_list) {
+    free(variable_item_list);
+}
+
+void variable_item_list_reset(VariableItemList* variable_item_list) {
+    variable_item_list->count = 0;
+    variable_item_list->selected = 0;
+}
+
+View* variable_item_list_get_view(VariableItemList* variable_item_list) {
+    return &variable_item_list->view;
+}
+
+VariableItem* variable_item_list_add(
+    VariableItemList* variable_item_list,
+    const char* label,
+    uint8_t values_count,
+    VariableItemChangeCallback change_callback,
+    void* context) {
+    furi_check(variable_item_list->count < FAKE_GUI_ITEMS);
+    VariableItem* item = &variable_item_list->items[variable_item_list->count++];
+    memset(item, 0, sizeof(VariableItem));
+    snprintf(item->label, sizeof(item->label), "%s", label);
+    item->values = values_count;
+    item->change = change_callback;
+    item->context = context;
+    return item;
+}
+
+void variable_item_list_set_enter_callback(
+    VariableItemList* variable_item_list,
+    VariableItemListEnterCallback callback,
+    void* context) {
+    variable_item_list->enter = callback;
+    variable_item_list->enterContext = context;
+}
+
+void variable_item_list_set_selected_item(VariableItemList* variable_item_list, uint8_t index) {
+    variable_item_list->selected = index;
+}
+
+void variable_item_set_current_value_index(VariableItem* item, uint8_t current_value_index) {
+    item->index = current_value_index;
+}
+
+void variable_item_set_current_value_text(VariableItem* item, const char* current_value_text) {
+    snprintf(item->text, sizeof(item->text), "%s", current_value_text);
+}
+
+uint8_t variable_item_get_current_value_index(VariableItem* item) {
+    return item->index;
+}
+
+void* variable_item_get_context(VariableItem* item) {
+    return item->context;
+}
+
+VariableItemList* fakeGui_viewItemList(View* view) {
+    if(view == NULL || view->kind != FakeViewItemList) return NULL;
+    return view->owner;
+}
+
+uint8_t fakeGui_itemCount(VariableItemList* list) {
+    return list->count;
+}
+
+VariableItem* fakeGui_item(VariableItemList* list, uint8_t index) {
+    return index < list->count ? &list->items[index] : NULL;
+}
+
+const char* fakeGui_itemLabel(VariableItem* item) {
+    return item->label;
+}
+
+const char* fakeGui_itemText(VariableItem* item) {
+    return item->text;
+}
+
+uint8_t fakeGui_itemValues(VariableItem* item) {
+    return item->values;
+}
+
+void fakeGui_itemSelect(VariableItem* item, uint8_t index) {
+    furi_check(index < item->values);
+    item->index = index;
+    if(item->change != NULL) item->change(item);
+}
+
+void fakeGui_itemEnter(VariableItemList* list, uint8_t index) {
+    list->selected = index;
+    if(list->enter != NULL) list->enter(list->enterContext, index);
+}
+
+Widget* widget_alloc(void) {
+    Widget* widget = calloc(1, sizeof(Widget));
+    fakeGui_initView(&widget->view, FakeViewWidget, widget);
+    return widget;
+}
+
+void widget_free(Widget* widget) {
+    free(widget);
+}
+
+void widget_reset(Widget* widget) {
+    widget->text[0] = '\0';
+    widget->textLen = 0;
+}
+
+View* widget_get_view(Widget* widget) {
+    return &widget->view;
+}
+
+void widget_add_button_element(
+    Widget* widget,
+    GuiButtonType button_type,
+    const char* text,
+    ButtonCallback callback,
+    void* context) {
+    UNUSED(button_type);
+    UNUSED(callback);
+    UNUSED(context);
+    fakeGui_append(widget->text, &widget->textLen, sizeof(widget->text), text);
+}
+
+void widget_add_text_box_element(
+    Widget* widget,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height,
+    Align horizontal,
+    Align vertical,
+    const char* text,
+    bool strip_to_dots) {
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(width);
+    UNUSED(height);
+    UNUSED(horizontal);
+    UNUSED(vertical);
+    UNUSED(strip_to_dots);
+    fakeGui_append(widget->text, &widget->textLen, sizeof(widget->text), text);
+}
+
+void widget_add_text_scroll_element(
+    Widget* widget,
+    uint8_t x,
+    uint8_t y,
+    uint8_t width,
+    uint8_t height,
+    const char* text) {
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(width);
+    UNUSED(height);
+    fakeGui_append(widget->text, &widget->textLen, sizeof(widget->text), text);
+}
+
+const char* fakeGui_widgetText(Widget* widget) {
+    return widget->text;
+}
+
+TextInput* text_input_alloc(void) {
+    TextInput* text_input = calloc(1, sizeof(TextInput));
+    fakeGui_initView(&text_input->view, FakeViewTextInput, text_input);
+    return text_input;
+}
+
+void text_input_free(TextInput* text_input) {
+    free(text_input);
+}
+
+View* text_input_get_view(TextInput* text_input) {
+    return &text_input->view;
+}
+
+void text_input_set_header_text(TextInput* text_input, const char* text) {
+    UNUSED(text_input);
+    UNUSED(text);
+}
+
+void text_input_set_result_callback(
+    TextInput* text_input,
+    TextInputCallback callback,
+    void* callback_context,
+    char* text_buffer,
+    size_t text_buffer_size,
+    bool clear_default_text) {
+    UNUSED(clear_default_text);
+    text_input->callback = callback;
+    text_input->callbackContext = callback_context;
+    text_input->buffer = text_buffer;
+    text_input->bufferSize = text_buffer_size;
+}
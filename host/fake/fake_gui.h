@@ -0,0 +1,45 @@
+#pragma once
+/* Экран модели: холст считает вызовы отрисовки и собирает напечатанные строки,
+ * списки хранят пункты, чтобы проверки могли выбирать варианты и нажимать пункты */
+#include <gui/gui.h>
+#include <gui/view_dispatcher.h>
+#include <gui/modules/variable_item_list.h>
+#include <gui/modules/widget.h>
+
+/**
+ * @brief Отрисовка вьюпорта на холст модели. Холст предварительно очищается
+ */
+void fakeGui_drawViewPort(ViewPort* view_port);
+/**
+ * @brief Отрисовка вида на холст модели. Холст предварительно очищается
+ */
+void fakeGui_drawView(View* view);
+void fakeGui_canvasReset(void); //Обнуление счётчика вызовов и строк холста
+uint32_t fakeGui_canvasCalls(void); //Вызовов отрисовки с последнего обнуления
+const char* fakeGui_canvasText(void); //Напечатанные строки через перевод строки
+
+/**
+ * @brief Вид, добавленный в диспетчер под номером
+ */
+View* fakeGui_dispatcherView(ViewDispatcher* view_dispatcher, uint32_t view_id);
+uint32_t fakeGui_currentViewId(ViewDispatcher* view_dispatcher); //Номер показанного вида
+/**
+ * @brief Список, которому принадлежит вид, или NULL
+ */
+VariableItemList* fakeGui_viewItemList(View* view);
+
+uint8_t fakeGui_itemCount(VariableItemList* list);
+VariableItem* fakeGui_item(VariableItemList* list, uint8_t index);
+const char* fakeGui_itemLabel(VariableItem* item);
+const char* fakeGui_itemText(VariableItem* item); //Текст текущего варианта
+uint8_t fakeGui_itemValues(VariableItem* item); //Количество вариантов
+/**
+ * @brief Выбор варианта пункта, как кнопками влево-вправо
+ */
+void fakeGui_itemSelect(VariableItem* item, uint8_t index);
+/**
+ * @brief Нажатие на пункт списка
+ */
+void fakeGui_itemEnter(VariableItemList* list, uint8_t index);
+
+const char* fakeGui_widgetText(Widget* widget); //Тексты элементов через перевод строки
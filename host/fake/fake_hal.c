@@ -0,0 +1,618 @@
+#include "fake_hal.h"
+#include <furi_hal_rtc.h>
+#include <pthread.h>
+
+/* Модель железа: часы в тактах ядра, порты GPIO с подтяжкой линий и датчики,
+ * отвечающие по сценарию. Все обращения к модели идут под одним рекурсивным
+ * мутексом, поэтому модель можно трогать из потоков приложения */
+
+#define FAKE_LINES (FAKE_HAL_PORTS * 16)
+#define FAKE_SCRIPT_MAX 96
+#define FAKE_UNIX_BASE 1700000000UL //Модельное unix-время в момент сброса
+#define FAKE_NEVER UINT64_MAX
+
+GPIO_TypeDef fakeHal_ports[FAKE_HAL_PORTS];
+
+const GpioPin gpio_ext_pa7 = {.port = GPIOA, .pin = LL_GPIO_PIN_7};
+const GpioPin gpio_ext_pa6 = {.port = GPIOA, .pin = LL_GPIO_PIN_6};
+const GpioPin gpio_ext_pa4 = {.port = GPIOA, .pin = LL_GPIO_PIN_4};
+const GpioPin gpio_ext_pb3 = {.port = GPIOB, .pin = LL_GPIO_PIN_3};
+const GpioPin gpio_ext_pb2 = {.port = GPIOB, .pin = LL_GPIO_PIN_2};
+const GpioPin gpio_ext_pc3 = {.port = GPIOC, .pin = LL_GPIO_PIN_3};
+const GpioPin gpio_ext_pc1 = {.port = GPIOC, .pin = LL_GPIO_PIN_1};
+const GpioPin gpio_ext_pc0 = {.port = GPIOC, .pin = LL_GPIO_PIN_0};
+const GpioPin ibutton_gpio = {.port = GPIOB, .pin = LL_GPIO_PIN_14};
+
+//Линия данных: как её держит хост, датчик на ней и обработчик прерывания по фронту
+typedef struct {
+    GpioMode mode;
+    bool hostLow; //Хост прижимает линию к земле
+    uint64_t lowSince; //Момент, с которого хост прижимает линию
+    bool level; //Уровень линии
+    GpioExtiCallback callback;
+    void* context;
+    uint64_t armedAt; //Момент включения прерывания по фронту
+    bool pending; //Фронт пришёл во время обработчика и ждёт его окончания
+
+    bool attached; //На линии есть датчик
+    FakeSensorTiming timing;
+    uint8_t rawData[5];
+    bool useWave; //Отвечать по записи вместо байт
+    DHT_waveform wave;
+    //Сценарий текущего ответа: длительности уровней, начиная с scriptFirst
+    uint32_t script[FAKE_SCRIPT_MAX];
+    uint8_t scriptCount;
+    uint8_t scriptIndex;
+    uint8_t scriptFirst;
+    uint8_t scriptHold; //Уровень после конца сценария
+    bool scriptActive;
+    uint64_t segmentEnd; //Конец текущего уровня сценария
+    uint32_t responses;
+    uint64_t lastStart;
+} FakeLine;
+
+static pthread_mutex_t lock;
+static pthread_once_t lockOnce = PTHREAD_ONCE_INIT;
+static FakeLine lines[FAKE_LINES];
+static uint64_t activeLines = 0; //Линии, на которых идёт ответ датчика
+static DWT_Type dwt;
+static uint64_t now;
+static uint32_t loopCycles = 8;
+static uint32_t irqLatency = 40;
+static uint32_t irqArmDelay = 0;
+static bool irqDisabled = false;
+static bool inIrq = false;
+static bool otg = false;
+static uint32_t rng = 1;
+static uint32_t gpioAccesses = 0;
+static FuriLogLevel logLevel = FuriLogLevelNone;
+
+static void fakeHal_initLock(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+static void fakeHal_lock(void) {
+    pthread_once(&lockOnce, fakeHal_initLock);
+    pthread_mutex_lock(&lock);
+}
+
+static void fakeHal_unlock(void) {
+    pthread_mutex_unlock(&lock);
+}
+
+static uint32_t fakeHal_random(void) {
+    //xorshift32
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static uint8_t fakeHal_portIndex(const GPIO_TypeDef* port) {
+    return port - fakeHal_ports;
+}
+
+static FakeLine* fakeHal_line(const GpioPin* gpio) {
+    uint8_t pin = __builtin_ctz(gpio->pin);
+    return &lines[fakeHal_portIndex(gpio->port) * 16 + pin];
+}
+
+static void fakeSensor_setActive(FakeLine* line, bool active) {
+    line->scriptActive = active;
+    uint64_t bit = 1ULL << (line - lines);
+    activeLines = active ? activeLines | bit : activeLines & ~bit;
+}
+
+/**
+ * @brief Уровень, который датчик держит на линии в текущий момент
+ */
+static bool fakeSensor_level(FakeLine* line) {
+    if(!line->scriptActive) return true;
+    while(line->scriptIndex < line->scriptCount && now >= line->segmentEnd) {
+        line->scriptIndex++;
+        if(line->scriptIndex < line->scriptCount) {
+            line->segmentEnd += line->script[line->scriptIndex];
+        }
+    }
+    if(line->scriptIndex >= line->scriptCount) {
+        //Датчик, отпустивший линию, больше на неё не влияет
+        if(line->scriptHold) fakeSensor_setActive(line, false);
+        return line->scriptHold;
+    }
+    return (line->scriptFirst ^ line->scriptIndex) & 1;
+}
+
+/**
+ * @brief Пересчёт уровня линии и регистра IDR
+ *
+ * @return true Уровень изменился
+ */
+static bool fakeHal_refreshLine(uint8_t index) {
+    FakeLine* line = &lines[index];
+    bool level = fakeSensor_level(line) && !line->hostLow;
+    GPIO_TypeDef* port = &fakeHal_ports[index / 16];
+    uint32_t mask = 1UL << (index % 16);
+    if(level) {
+        port->IDR |= mask;
+    } else {
+        port->IDR &= ~mask;
+    }
+    bool changed = level != line->level;
+    line->level = level;
+    return changed;
+}
+
+/**
+ * @brief Вызов обработчика прерывания по фронту с задержкой входа в прерывание
+ * @details Фронт во время обработчика не теряется, а ждёт его окончания, как
+ * отложенное прерывание NVIC
+ */
+static void fakeHal_edge(uint8_t index) {
+    FakeLine* line = &lines[index];
+    if(line->callback == NULL || irqDisabled) return;
+    if(line->mode < GpioModeInterruptRise) return;
+    if(inIrq) {
+        line->pending = true;
+        return;
+    }
+    //Фронт до подключения обработчика теряется
+    if(now < line->armedAt + irqArmDelay) return;
+    do {
+        line->pending = false;
+        now += irqLatency;
+        fakeHal_refreshLine(index);
+        inIrq = true;
+        line->callback(line->context);
+        inIrq = false;
+    } while(line->pending && line->callback != NULL);
+}
+
+/**
+ * @brief Сценарий ответа датчика из байт и длительностей
+ */
+static void fakeSensor_buildFrame(FakeLine* line, bool triggered) {
+    const FakeSensorTiming* t = &line->timing;
+    uint8_t n = 0;
+    //Длительность уровня с разбросом, не короче 1 мкс
+    const int32_t jitter = t->jitter * FAKE_HAL_CPU_MHZ;
+#define FAKE_WIDTH(us)                                                                  \
+    ({                                                                                  \
+        int32_t w = (int32_t)(us)*FAKE_HAL_CPU_MHZ;                                     \
+        if(jitter > 0) w += (int32_t)(fakeHal_random() % (2 * jitter + 1)) - jitter;    \
+        (uint32_t)(w < FAKE_HAL_CPU_MHZ ? FAKE_HAL_CPU_MHZ : w);                        \
+    })
+    line->scriptFirst = 0;
+    line->script[n++] = t->rise * FAKE_HAL_CPU_MHZ;
+    if(!triggered) {
+        line->scriptCount = n;
+        line->scriptHold = 1;
+        return;
+    }
+    line->script[n++] = FAKE_WIDTH(t->response);
+    line->script[n++] = FAKE_WIDTH(t->ackLow);
+    line->script[n++] = FAKE_WIDTH(t->ackHigh);
+    uint8_t bits = MIN(t->bits, 40);
+    if(t->dropPercent > 0 && fakeHal_random() % 100 < t->dropPercent) {
+        bits = fakeHal_random() % 40;
+    }
+    for(uint8_t bit = 0; bit < bits; bit++) {
+        bool one = line->rawData[bit / 8] & (1 << (7 - bit % 8));
+        line->script[n++] = FAKE_WIDTH(t->bitLow);
+        line->script[n++] = FAKE_WIDTH(one ? t->one : t->zero);
+    }
+#undef FAKE_WIDTH
+    if(bits == 40 || t->dropHoldLow) {
+        //Низкий уровень после последнего бита. Оборванный ответ так и остаётся прижатым
+        line->script[n++] = t->bitLow * FAKE_HAL_CPU_MHZ;
+        line->scriptHold = bits == 40 ? 1 : 0;
+    } else {
+        line->scriptHold = 1;
+    }
+    line->scriptCount = n;
+}
+
+/**
+ * @brief Сценарий ответа по записанной осциллограмме
+ */
+static void fakeSensor_buildWave(FakeLine* line) {
+    const DHT_waveform* wave = &line->wave;
+    uint8_t n = 0;
+    line->scriptFirst = wave->firstLevel & 1;
+    uint8_t i = 0;
+    for(; i < wave->count && n < FAKE_SCRIPT_MAX; i++) {
+        if(wave->width[i] == DHT_WAVE_TIMEOUT && i == wave->count - 1) {
+            //Незаконченный уровень держится до конца
+            line->scriptHold = (wave->firstLevel ^ i) & 1;
+            line->scriptCount = n;
+            return;
+        }
+        line->script[n++] = wave->width[i] * FAKE_HAL_CPU_MHZ;
+    }
+    //Последний записанный уровень закончился фронтом. После спада датчик, как и в ответе
+    //из байт, держит низкий уровень бита и отпускает линию
+    line->scriptHold = 1;
+    if(((wave->firstLevel ^ i) & 1) == 0 && n < FAKE_SCRIPT_MAX) {
+        line->script[n++] = line->timing.bitLow * FAKE_HAL_CPU_MHZ;
+    }
+    line->scriptCount = n;
+}
+
+/**
+ * @brief Пересчёт того, как хост держит линию, с запуском ответа датчика
+ * после отпускания линии
+ */
+static void fakeHal_driveLine(uint8_t index) {
+    FakeLine* line = &lines[index];
+    GPIO_TypeDef* port = &fakeHal_ports[index / 16];
+    bool output = line->mode == GpioModeOutputOpenDrain || line->mode == GpioModeOutputPushPull;
+    bool hostLow = output && !(port->ODR & (1UL << (index % 16)));
+    if(hostLow != line->hostLow) {
+        line->hostLow = hostLow;
+        if(hostLow) {
+            line->lowSince = now;
+            //Хост перебил ответ, датчик его бросает
+            fakeSensor_setActive(line, false);
+        } else if(line->attached) {
+            bool triggered = now - line->lowSince >=
+                             (uint64_t)line->timing.startMin * FAKE_HAL_CPU_MHZ;
+            if(triggered && line->useWave) {
+                fakeSensor_buildWave(line);
+            } else {
+                fakeSensor_buildFrame(line, triggered);
+            }
+            if(triggered) {
+                line->responses++;
+                line->lastStart = now;
+            }
+            line->scriptIndex = 0;
+            line->segmentEnd = now + (line->scriptCount > 0 ? line->script[0] : 0);
+            fakeSensor_setActive(line, true);
+        }
+    }
+    if(fakeHal_refreshLine(index)) fakeHal_edge(index);
+}
+
+/**
+ * @brief Обновление линий, на которых идёт ответ датчика. На остальных уровень
+ * меняется только вместе с тем, как линию держит хост
+ */
+static void fakeHal_refreshActive(void) {
+    for(uint64_t active = activeLines; active != 0; active &= active - 1) {
+        uint8_t i = __builtin_ctzll(active);
+        if(fakeHal_refreshLine(i)) fakeHal_edge(i);
+    }
+}
+
+/**
+ * @brief Применение записей в BSRR и обновление IDR
+ */
+static void fakeHal_sync(void) {
+    for(uint8_t p = 0; p < FAKE_HAL_PORTS; p++) {
+        GPIO_TypeDef* port = &fakeHal_ports[p];
+        uint32_t bsrr = port->BSRR;
+        if(bsrr == 0) continue;
+        port->BSRR = 0;
+        gpioAccesses++;
+        port->ODR = (port->ODR & ~(bsrr >> 16)) | (bsrr & 0xFFFF);
+        for(uint8_t pin = 0; pin < 16; pin++) {
+            if(bsrr & (0x10001UL << pin)) fakeHal_driveLine(p * 16 + pin);
+        }
+    }
+    fakeHal_refreshActive();
+}
+
+void fakeHal_advance(uint64_t cycles) {
+    fakeHal_lock();
+    uint64_t target = now + cycles;
+    //Фронты на линиях с прерыванием обрабатываются по порядку, как настоящие прерывания
+    while(!inIrq) {
+        uint64_t next = FAKE_NEVER;
+        int16_t nextLine = -1;
+        for(uint64_t active = activeLines; active != 0; active &= active - 1) {
+            uint8_t i = __builtin_ctzll(active);
+            FakeLine* line = &lines[i];
+            if(line->callback == NULL) continue;
+            if(line->scriptIndex >= line->scriptCount) continue;
+            if(line->segmentEnd < next) {
+                next = line->segmentEnd;
+                nextLine = i;
+            }
+        }
+        if(nextLine < 0 || next > target) break;
+        if(next > now) now = next;
+        if(fakeHal_refreshLine(nextLine)) fakeHal_edge(nextLine);
+    }
+    if(now < target) now = target;
+    fakeHal_refreshActive();
+    fakeHal_unlock();
+}
+
+DWT_Type* fakeHal_dwt(void) {
+    fakeHal_lock();
+    fakeHal_sync();
+    fakeHal_advance(loopCycles);
+    dwt.CYCCNT = (uint32_t)now;
+    fakeHal_unlock();
+    return &dwt;
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return FAKE_HAL_CPU_MHZ;
+}
+
+void __disable_irq(void) {
+    irqDisabled = true;
+}
+
+void __enable_irq(void) {
+    irqDisabled = false;
+}
+
+uint32_t furi_get_tick(void) {
+    fakeHal_lock();
+    fakeHal_sync();
+    uint32_t tick = now / FAKE_HAL_CYCLES_PER_MS;
+    fakeHal_unlock();
+    return tick;
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    fakeHal_lock();
+    fakeHal_sync();
+    fakeHal_advance(milliseconds * FAKE_HAL_CYCLES_PER_MS);
+    fakeHal_unlock();
+}
+
+void furi_delay_us(uint32_t microseconds) {
+    fakeHal_lock();
+    fakeHal_sync();
+    fakeHal_advance((uint64_t)microseconds * FAKE_HAL_CPU_MHZ);
+    fakeHal_unlock();
+}
+
+void furi_hal_gpio_init(const GpioPin* gpio, GpioMode mode, GpioPull pull, GpioSpeed speed) {
+    UNUSED(pull);
+    UNUSED(speed);
+    fakeHal_lock();
+    fakeHal_sync();
+    gpioAccesses++;
+    FakeLine* line = fakeHal_line(gpio);
+    if(mode >= GpioModeInterruptRise && line->mode < GpioModeInterruptRise) line->armedAt = now;
+    line->mode = mode;
+    fakeHal_driveLine(line - lines);
+    fakeHal_unlock();
+}
+
+void furi_hal_gpio_write(const GpioPin* gpio, bool state) {
+    fakeHal_lock();
+    fakeHal_sync();
+    gpioAccesses++;
+    if(state) {
+        gpio->port->ODR |= gpio->pin;
+    } else {
+        gpio->port->ODR &= ~(uint32_t)gpio->pin;
+    }
+    fakeHal_driveLine(fakeHal_line(gpio) - lines);
+    fakeHal_unlock();
+}
+
+bool furi_hal_gpio_read(const GpioPin* gpio) {
+    fakeHal_lock();
+    fakeHal_sync();
+    gpioAccesses++;
+    bool level = fakeHal_line(gpio)->level;
+    fakeHal_unlock();
+    return level;
+}
+
+void furi_hal_gpio_add_int_callback(const GpioPin* gpio, GpioExtiCallback cb, void* ctx) {
+    fakeHal_lock();
+    gpioAccesses++;
+    FakeLine* line = fakeHal_line(gpio);
+    line->callback = cb;
+    line->context = ctx;
+    fakeHal_unlock();
+}
+
+void furi_hal_gpio_remove_int_callback(const GpioPin* gpio) {
+    fakeHal_lock();
+    gpioAccesses++;
+    fakeHal_line(gpio)->callback = NULL;
+    fakeHal_unlock();
+}
+
+bool furi_hal_power_is_otg_enabled(void) {
+    return otg;
+}
+
+void furi_hal_power_enable_otg(void) {
+    otg = true;
+}
+
+void furi_hal_power_disable_otg(void) {
+    otg = false;
+}
+
+bool fakeHal_isOtgEnabled(void) {
+    return otg;
+}
+
+uint32_t furi_hal_random_get(void) {
+    fakeHal_lock();
+    uint32_t value = fakeHal_random();
+    fakeHal_unlock();
+    return value;
+}
+
+void furi_hal_rtc_get_datetime(FuriHalRtcDateTime* datetime) {
+    memset(datetime, 0, sizeof(FuriHalRtcDateTime));
+    datetime->timestamp = FAKE_UNIX_BASE + furi_get_tick() / 1000;
+}
+
+uint32_t furi_hal_rtc_datetime_to_timestamp(FuriHalRtcDateTime* datetime) {
+    return datetime->timestamp;
+}
+
+void fakeHal_fixFormat(const char* format, char* fixed, size_t size) {
+    size_t len = 0;
+    for(const char* p = format; *p && len < size - 1; p++) {
+        fixed[len++] = *p;
+        if(p[0] == '%' && p[1] == 'l') p++;
+    }
+    fixed[len] = '\0';
+}
+
+int fakeHal_snprintf(char* str, size_t size, const char* format, ...) {
+    char fixed[strlen(format) + 1];
+    fakeHal_fixFormat(format, fixed, sizeof(fixed));
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(str, size, fixed, args);
+    va_end(args);
+    return len;
+}
+
+void fakeHal_log(FuriLogLevel level, const char* tag, const char* format, ...) {
+    if(level > logLevel) return;
+    char fixed[256];
+    fakeHal_fixFormat(format, fixed, sizeof(fixed));
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "[%s] ", tag);
+    vfprintf(stderr, fixed, args);
+    va_end(args);
+}
+
+void fakeHal_setLogLevel(FuriLogLevel level) {
+    logLevel = level;
+}
+
+void fakeHal_reset(uint32_t seed) {
+    fakeHal_lock();
+    memset(lines, 0, sizeof(lines));
+    activeLines = 0;
+    memset(fakeHal_ports, 0, sizeof(fakeHal_ports));
+    for(uint8_t i = 0; i < FAKE_LINES; i++) {
+        lines[i].mode = GpioModeAnalog;
+        lines[i].level = true;
+        fakeHal_ports[i / 16].IDR |= 1UL << (i % 16);
+    }
+    now = 0;
+    loopCycles = 8;
+    irqLatency = 40;
+    irqArmDelay = 0;
+    irqDisabled = false;
+    inIrq = false;
+    otg = false;
+    rng = seed != 0 ? seed : 1;
+    gpioAccesses = 0;
+    fakeHal_unlock();
+}
+
+void fakeHal_setLoopCycles(uint32_t cycles) {
+    loopCycles = cycles;
+}
+
+void fakeHal_setIrqLatency(uint32_t cycles) {
+    irqLatency = cycles;
+}
+
+void fakeHal_setIrqArmDelay(uint32_t cycles) {
+    irqArmDelay = cycles;
+}
+
+uint64_t fakeHal_now(void) {
+    fakeHal_lock();
+    uint64_t value = now;
+    fakeHal_unlock();
+    return value;
+}
+
+uint32_t fakeHal_gpioAccesses(void) {
+    return gpioAccesses;
+}
+
+FakeSensorTiming fakeSensor_defaultTiming(uint8_t type) {
+    FakeSensorTiming timing = {
+        .startMin = type == DHT11 ? 18000 : 1000,
+        .rise = 2,
+        .response = 30,
+        .ackLow = 80,
+        .ackHigh = 80,
+        .bitLow = 50,
+        .zero = 26,
+        .one = 70,
+        .jitter = 0,
+        .bits = 40,
+        .dropPercent = 0,
+        .dropHoldLow = true,
+    };
+    return timing;
+}
+
+void fakeSensor_attach(const GpioPin* gpio, const FakeSensorTiming* timing) {
+    fakeHal_lock();
+    FakeLine* line = fakeHal_line(gpio);
+    line->attached = true;
+    line->timing = *timing;
+    line->useWave = false;
+    fakeSensor_setActive(line, false);
+    line->responses = 0;
+    fakeHal_unlock();
+}
+
+void fakeSensor_detach(const GpioPin* gpio) {
+    fakeHal_lock();
+    FakeLine* line = fakeHal_line(gpio);
+    line->attached = false;
+    fakeSensor_setActive(line, false);
+    fakeHal_unlock();
+}
+
+void fakeSensor_setTiming(const GpioPin* gpio, const FakeSensorTiming* timing) {
+    fakeHal_lock();
+    fakeHal_line(gpio)->timing = *timing;
+    fakeHal_unlock();
+}
+
+void fakeSensor_setFrame(const GpioPin* gpio, const uint8_t rawData[5]) {
+    fakeHal_lock();
+    memcpy(fakeHal_line(gpio)->rawData, rawData, 5);
+    fakeHal_unlock();
+}
+
+void fakeSensor_setWave(const GpioPin* gpio, const DHT_waveform* wave) {
+    fakeHal_lock();
+    FakeLine* line = fakeHal_line(gpio);
+    line->useWave = wave != NULL;
+    if(wave != NULL) line->wave = *wave;
+    fakeHal_unlock();
+}
+
+void fakeSensor_encode(uint8_t type, int16_t temp, int16_t hum, uint8_t rawData[5]) {
+    uint16_t absTemp = temp < 0 ? -temp : temp;
+    if(type == DHT11) {
+        rawData[0] = hum / 10;
+        rawData[1] = 0;
+        rawData[2] = absTemp / 10;
+        rawData[3] = (absTemp % 10) | (temp < 0 ? 0x80 : 0);
+    } else {
+        rawData[0] = (uint16_t)hum >> 8;
+        rawData[1] = hum & 0xFF;
+        rawData[2] = (absTemp >> 8) | (temp < 0 ? 0x80 : 0);
+        rawData[3] = absTemp & 0xFF;
+    }
+    rawData[4] = rawData[0] + rawData[1] + rawData[2] + rawData[3];
+}
+
+uint32_t fakeSensor_responses(const GpioPin* gpio) {
+    return fakeHal_line(gpio)->responses;
+}
+
+uint64_t fakeSensor_lastStart(const GpioPin* gpio) {
+    return fakeHal_line(gpio)->lastStart;
+}
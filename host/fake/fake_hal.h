@@ -0,0 +1,99 @@
+#pragma once
+/* Управление моделью железа из проверок и замеров: модельные часы, линии данных
+ * и датчики на них. Датчик отвечает, когда хост отпускает линию после стартового
+ * импульса, по сценарию из байт ответа с заданными длительностями, разбросом
+ * и обрывами или по записанной осциллограмме */
+#include <furi.h>
+#include <furi_hal.h>
+#include "DHT.h"
+
+#define FAKE_HAL_CYCLES_PER_MS (FAKE_HAL_CPU_MHZ * 1000ULL)
+
+/* Длительности ответа датчика, мкс */
+typedef struct {
+    uint16_t startMin; //Самый короткий стартовый импульс, на который датчик отвечает
+    uint8_t rise; //Подъём линии подтяжкой после отпускания (ёмкость кабеля)
+    uint8_t response; //Задержка ответа после подъёма линии, по даташиту 20-40
+    uint8_t ackLow, ackHigh; //Импульсы подтверждения, 80/80
+    uint8_t bitLow; //Низкий уровень перед битом, 50
+    uint8_t zero, one; //Импульсы нуля и единицы, 26-28/70
+    uint8_t jitter; //Наибольший случайный сдвиг каждого уровня в обе стороны
+    uint8_t bits; //Сколько бит передаётся до обрыва. 40 - полный ответ
+    uint8_t dropPercent; //Вероятность обрыва ответа на случайном бите, %
+    bool dropHoldLow; //После обрыва линия остаётся прижатой, иначе отпускается
+} FakeSensorTiming;
+
+/**
+ * @brief Сброс модели: часы в ноль, линии отпущены, датчики сняты, питание выключено
+ *
+ * @param seed Начальное значение генератора разброса и обрывов
+ */
+void fakeHal_reset(uint32_t seed);
+/**
+ * @brief Длительность одного прохода цикла опроса линии: на столько тактов
+ * продвигается время при каждом чтении DWT. По умолчанию 8
+ */
+void fakeHal_setLoopCycles(uint32_t cycles);
+/**
+ * @brief Задержка входа в обработчик прерывания по фронту, такты. По умолчанию 40
+ */
+void fakeHal_setIrqLatency(uint32_t cycles);
+/**
+ * @brief Время после включения прерывания по фронту, в течение которого фронты
+ * теряются (обработчик ещё не подключён), такты. По умолчанию 0
+ */
+void fakeHal_setIrqArmDelay(uint32_t cycles);
+uint64_t fakeHal_now(void); //Модельное время, такты
+void fakeHal_advance(uint64_t cycles); //Продвижение модельного времени с обработкой фронтов
+void fakeHal_setLogLevel(FuriLogLevel level);
+bool fakeHal_isOtgEnabled(void); //Подано ли 5V
+
+/**
+ * @brief Длительности ответа по даташиту
+ *
+ * @param type Тип датчика (DHT_type)
+ * @return Длительности
+ */
+FakeSensorTiming fakeSensor_defaultTiming(uint8_t type);
+/**
+ * @brief Подключение датчика к линии
+ *
+ * @param gpio Линия
+ * @param timing Длительности ответа
+ */
+void fakeSensor_attach(const GpioPin* gpio, const FakeSensorTiming* timing);
+void fakeSensor_detach(const GpioPin* gpio);
+void fakeSensor_setTiming(const GpioPin* gpio, const FakeSensorTiming* timing);
+/**
+ * @brief Байты, которые датчик передаёт в следующих ответах
+ */
+void fakeSensor_setFrame(const GpioPin* gpio, const uint8_t rawData[5]);
+/**
+ * @brief Байты ответа с показаниями в десятых долях и верной контрольной суммой
+ *
+ * @param type Тип датчика (DHT_type). DHT11 передаёт десятые доли по-ASAIR
+ * @param temp Температура
+ * @param hum Влажность
+ * @param rawData Байты ответа
+ */
+void fakeSensor_encode(uint8_t type, int16_t temp, int16_t hum, uint8_t rawData[5]);
+/**
+ * @brief Ответ по записанной осциллограмме вместо сценария из байт. Уровни записи
+ * проигрываются с момента отпускания линии, последний незаконченный уровень держится.
+ * После законченного последнего уровня датчик, как в ответе из байт, отпускает линию
+ *
+ * @param gpio Линия
+ * @param wave Запись или NULL - вернуться к ответу из байт
+ */
+void fakeSensor_setWave(const GpioPin* gpio, const DHT_waveform* wave);
+uint32_t fakeSensor_responses(const GpioPin* gpio); //Сколько раз датчик начал ответ
+uint64_t fakeSensor_lastStart(const GpioPin* gpio); //Момент начала последнего ответа, такты
+uint32_t fakeHal_gpioAccesses(void); //Обращений к линиям через HAL и регистры
+/**
+ * @brief Формат printf приложения для компьютера: на Flipper Zero long 32-битный,
+ * поэтому %lu в приложении печатает uint32_t и на компьютере заменяется на %u
+ */
+void fakeHal_fixFormat(const char* format, char* fixed, size_t size);
+int fakeHal_snprintf(char* str, size_t size, const char* format, ...); //snprintf с заменой %lu
+const char* fakeHal_lastNotification(void); //Имя последнего поданного уведомления или NULL
+uint32_t fakeHal_notifications(void); //Сколько уведомлений подано
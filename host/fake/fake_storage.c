@@ -0,0 +1,228 @@
+#include "fake_storage.h"
+#include "fake_hal.h"
+#include <toolbox/stream/file_stream.h>
+#include <sys/stat.h>
+#include <errno.h>
+
+#define FAKE_STORAGE_MAPS 8
+#define FAKE_STORAGE_PATH 512
+
+struct File {
+    FILE* fp;
+};
+
+struct Stream {
+    File file;
+};
+
+typedef struct {
+    char path[FAKE_STORAGE_PATH];
+    char hostPath[FAKE_STORAGE_PATH];
+} FakeStorageMap;
+
+static char storageRoot[FAKE_STORAGE_PATH] = ".";
+static FakeStorageMap maps[FAKE_STORAGE_MAPS];
+
+/**
+ * @brief Создание каталога со всеми родительскими каталогами
+ */
+static bool fakeStorage_mkdirs(const char* dir) {
+    char path[FAKE_STORAGE_PATH];
+    snprintf(path, sizeof(path), "%s", dir);
+    for(char* p = path + 1; *p; p++) {
+        if(*p != '/') continue;
+        *p = '\0';
+        if(mkdir(path, 0755) != 0 && errno != EEXIST) return false;
+        *p = '/';
+    }
+    return mkdir(path, 0755) == 0 || errno == EEXIST;
+}
+
+void fakeStorage_setRoot(const char* root) {
+    snprintf(storageRoot, sizeof(storageRoot), "%s", root);
+    fakeStorage_mkdirs(storageRoot);
+    memset(maps, 0, sizeof(maps));
+}
+
+void fakeStorage_map(const char* path, const char* hostPath) {
+    FakeStorageMap* slot = NULL;
+    for(uint8_t i = 0; i < FAKE_STORAGE_MAPS; i++) {
+        if(strcmp(maps[i].path, path) == 0) {
+            slot = &maps[i];
+            break;
+        }
+        if(slot == NULL && maps[i].path[0] == '\0') slot = &maps[i];
+    }
+    furi_check(slot != NULL);
+    if(hostPath == NULL) {
+        memset(slot, 0, sizeof(FakeStorageMap));
+        return;
+    }
+    snprintf(slot->path, sizeof(slot->path), "%s", path);
+    snprintf(slot->hostPath, sizeof(slot->hostPath), "%s", hostPath);
+}
+
+void fakeStorage_hostPath(const char* path, char* hostPath, size_t size) {
+    for(uint8_t i = 0; i < FAKE_STORAGE_MAPS; i++) {
+        if(maps[i].path[0] != '\0' && strcmp(maps[i].path, path) == 0) {
+            snprintf(hostPath, size, "%s", maps[i].hostPath);
+            return;
+        }
+    }
+    if(strncmp(path, "/ext", 4) == 0) path += 4;
+    snprintf(hostPath, size, "%s%s", storageRoot, path);
+}
+
+static bool fakeStorage_exists(const char* hostPath) {
+    struct stat st;
+    return stat(hostPath, &st) == 0;
+}
+
+FS_Error storage_common_mkdir(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char hostPath[FAKE_STORAGE_PATH];
+    fakeStorage_hostPath(path, hostPath, sizeof(hostPath));
+    if(fakeStorage_exists(hostPath)) return FSE_EXIST;
+    return fakeStorage_mkdirs(hostPath) ? FSE_OK : FSE_INTERNAL;
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char hostPath[FAKE_STORAGE_PATH];
+    fakeStorage_hostPath(path, hostPath, sizeof(hostPath));
+    if(!fakeStorage_exists(hostPath)) return FSE_NOT_EXIST;
+    return remove(hostPath) == 0 ? FSE_OK : FSE_INTERNAL;
+}
+
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    UNUSED(storage);
+    char oldHost[FAKE_STORAGE_PATH], newHost[FAKE_STORAGE_PATH];
+    fakeStorage_hostPath(old_path, oldHost, sizeof(oldHost));
+    fakeStorage_hostPath(new_path, newHost, sizeof(newHost));
+    if(!fakeStorage_exists(oldHost)) return FSE_NOT_EXIST;
+    //Как и FatFs, переименование не заменяет существующий файл
+    if(fakeStorage_exists(newHost)) return FSE_EXIST;
+    return rename(oldHost, newHost) == 0 ? FSE_OK : FSE_INTERNAL;
+}
+
+bool storage_file_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char hostPath[FAKE_STORAGE_PATH];
+    fakeStorage_hostPath(path, hostPath, sizeof(hostPath));
+    return fakeStorage_exists(hostPath);
+}
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    return calloc(1, sizeof(File));
+}
+
+void storage_file_free(File* file) {
+    storage_file_close(file);
+    free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode) {
+    char hostPath[FAKE_STORAGE_PATH];
+    fakeStorage_hostPath(path, hostPath, sizeof(hostPath));
+    bool exists = fakeStorage_exists(hostPath);
+    const char* mode;
+    switch(open_mode) {
+    case FSOM_OPEN_EXISTING:
+        if(!exists) return false;
+        mode = access_mode == FSAM_READ ? "rb" : "r+b";
+        break;
+    case FSOM_OPEN_ALWAYS:
+        mode = exists ? "r+b" : "w+b";
+        break;
+    case FSOM_OPEN_APPEND:
+        mode = "a+b";
+        break;
+    case FSOM_CREATE_NEW:
+        if(exists) return false;
+        mode = "w+b";
+        break;
+    default:
+        mode = "w+b";
+        break;
+    }
+    file->fp = fopen(hostPath, mode);
+    return file->fp != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(file->fp == NULL) return false;
+    fclose(file->fp);
+    file->fp = NULL;
+    return true;
+}
+
+uint16_t storage_file_read(File* file, void* buff, uint16_t bytes_to_read) {
+    if(file->fp == NULL) return 0;
+    return fread(buff, 1, bytes_to_read, file->fp);
+}
+
+uint16_t storage_file_write(File* file, const void* buff, uint16_t bytes_to_write) {
+    if(file->fp == NULL) return 0;
+    return fwrite(buff, 1, bytes_to_write, file->fp);
+}
+
+uint64_t storage_file_size(File* file) {
+    if(file->fp == NULL) return 0;
+    long position = ftell(file->fp);
+    fseek(file->fp, 0, SEEK_END);
+    long size = ftell(file->fp);
+    fseek(file->fp, position, SEEK_SET);
+    return size;
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    if(file->fp == NULL) return false;
+    return fseek(file->fp, offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+Stream* file_stream_alloc(Storage* storage) {
+    UNUSED(storage);
+    return calloc(1, sizeof(Stream));
+}
+
+bool file_stream_open(Stream* stream, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode) {
+    return storage_file_open(&stream->file, path, access_mode, open_mode);
+}
+
+void stream_free(Stream* stream) {
+    storage_file_close(&stream->file);
+    free(stream);
+}
+
+size_t stream_read(Stream* stream, uint8_t* data, size_t size) {
+    if(stream->file.fp == NULL) return 0;
+    return fread(data, 1, size, stream->file.fp);
+}
+
+size_t stream_write(Stream* stream, const uint8_t* data, size_t size) {
+    if(stream->file.fp == NULL) return 0;
+    return fwrite(data, 1, size, stream->file.fp);
+}
+
+size_t stream_write_format(Stream* stream, const char* format, ...) {
+    //Как и FuriString в прошивке, ни формат, ни строка не ограничены по длине
+    size_t size = strlen(format) + 1;
+    char* fixed = malloc(size);
+    fakeHal_fixFormat(format, fixed, size);
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(NULL, 0, fixed, args);
+    va_end(args);
+    size_t written = 0;
+    if(len > 0) {
+        char* text = malloc(len + 1);
+        va_start(args, format);
+        vsnprintf(text, len + 1, fixed, args);
+        va_end(args);
+        written = stream_write(stream, (const uint8_t*)text, len);
+        free(text);
+    }
+    free(fixed);
+    return written;
+}
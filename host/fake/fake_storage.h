@@ -0,0 +1,26 @@
+#pragma once
+/* Хранилище модели: пути приложения "/ext/..." отображаются в каталог компьютера */
+#include <storage/storage.h>
+
+/**
+ * @brief Каталог компьютера, в который отображается /ext. Создаётся при необходимости
+ *
+ * @param root Каталог
+ */
+void fakeStorage_setRoot(const char* root);
+/**
+ * @brief Отображение отдельного файла приложения в произвольный файл компьютера
+ * @details Нужно утилитам, которые работают с файлами пользователя, а не с каталогом модели
+ *
+ * @param path Путь в приложении, например DHTMON_LOG_PATH
+ * @param hostPath Путь на компьютере или NULL - снять отображение
+ */
+void fakeStorage_map(const char* path, const char* hostPath);
+/**
+ * @brief Путь на компьютере, в который отображается путь приложения
+ *
+ * @param path Путь в приложении
+ * @param hostPath Буфер для пути на компьютере
+ * @param size Размер буфера
+ */
+void fakeStorage_hostPath(const char* path, char* hostPath, size_t size);
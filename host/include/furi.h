@@ -0,0 +1,120 @@
+#pragma once
+/* Заглушка ядра furi для сборки на компьютере. Объявлено ровно то, чем пользуется
+ * приложение, реализация - в host/fake */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <assert.h>
+
+#define UNUSED(x) (void)(x)
+#define COUNT_OF(x) (sizeof(x) / sizeof(x[0]))
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+#define CLAMP(x, upper, lower) (MIN(upper, MAX(x, lower)))
+#define furi_assert(x) assert(x)
+//Как и в прошивке, furi_check проверяется и без отладки: в условии бывают вызовы
+#define furi_check(x)                                                                    \
+    do {                                                                                 \
+        if(!(x)) {                                                                       \
+            fprintf(stderr, "%s:%d: furi_check failed: %s\n", __FILE__, __LINE__, #x); \
+            abort();                                                                     \
+        }                                                                                \
+    } while(0)
+
+/* Журнал. Печатается в stderr, если уровень не ниже заданного fakeHal_setLogLevel() */
+typedef enum {
+    FuriLogLevelNone,
+    FuriLogLevelError,
+    FuriLogLevelWarn,
+    FuriLogLevelInfo,
+    FuriLogLevelDebug,
+} FuriLogLevel;
+void fakeHal_log(FuriLogLevel level, const char* tag, const char* format, ...);
+#define FURI_LOG_E(tag, ...) fakeHal_log(FuriLogLevelError, tag, __VA_ARGS__)
+#define FURI_LOG_W(tag, ...) fakeHal_log(FuriLogLevelWarn, tag, __VA_ARGS__)
+#define FURI_LOG_I(tag, ...) fakeHal_log(FuriLogLevelInfo, tag, __VA_ARGS__)
+#define FURI_LOG_D(tag, ...) fakeHal_log(FuriLogLevelDebug, tag, __VA_ARGS__)
+
+#define FuriWaitForever 0xFFFFFFFFU
+typedef enum {
+    FuriStatusOk = 0,
+    FuriStatusError = -1,
+    FuriStatusErrorTimeout = -2,
+} FuriStatus;
+typedef enum {
+    FuriFlagWaitAny = 0,
+    FuriFlagWaitAll = 1,
+    FuriFlagNoClear = 2,
+    FuriFlagError = 0x80000000U,
+    FuriFlagErrorTimeout = 0xFFFFFFFEU,
+} FuriFlag;
+
+typedef struct FuriMessageQueue FuriMessageQueue;
+typedef struct FuriMutex FuriMutex;
+typedef struct FuriThread FuriThread;
+typedef FuriThread* FuriThreadId;
+typedef int32_t (*FuriThreadCallback)(void* context);
+typedef enum {
+    FuriMutexTypeNormal,
+    FuriMutexTypeRecursive,
+} FuriMutexType;
+typedef enum {
+    FuriThreadPriorityNone = 0,
+    FuriThreadPriorityIdle = 1,
+    FuriThreadPriorityLowest = 14,
+    FuriThreadPriorityLow = 15,
+    FuriThreadPriorityNormal = 16,
+    FuriThreadPriorityHigh = 17,
+    FuriThreadPriorityHighest = 18,
+} FuriThreadPriority;
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size);
+void furi_message_queue_free(FuriMessageQueue* instance);
+FuriStatus furi_message_queue_put(FuriMessageQueue* instance, const void* msg, uint32_t timeout);
+FuriStatus furi_message_queue_get(FuriMessageQueue* instance, void* msg, uint32_t timeout);
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type);
+void furi_mutex_free(FuriMutex* instance);
+FuriStatus furi_mutex_acquire(FuriMutex* instance, uint32_t timeout);
+FuriStatus furi_mutex_release(FuriMutex* instance);
+
+FuriThread* furi_thread_alloc(void);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_set_name(FuriThread* thread, const char* name);
+void furi_thread_set_stack_size(FuriThread* thread, size_t stack_size);
+void furi_thread_set_context(FuriThread* thread, void* context);
+void furi_thread_set_callback(FuriThread* thread, FuriThreadCallback callback);
+void furi_thread_set_priority(FuriThread* thread, FuriThreadPriority priority);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+FuriThreadId furi_thread_get_id(FuriThread* thread);
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags);
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout);
+
+/* Время идёт по модельным часам host/fake, а не по часам компьютера */
+uint32_t furi_get_tick(void);
+void furi_delay_ms(uint32_t milliseconds);
+void furi_delay_us(uint32_t microseconds);
+
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+typedef struct {
+    void* value;
+    FuriMutex* mutex;
+} ValueMutex;
+bool init_mutex(ValueMutex* valuemutex, void* value, size_t size);
+bool delete_mutex(ValueMutex* valuemutex);
+void* acquire_mutex(ValueMutex* valuemutex, uint32_t timeout);
+void* acquire_mutex_block(ValueMutex* valuemutex);
+bool release_mutex(ValueMutex* valuemutex, const void* value);
+
+#include <furi_hal.h>
@@ -0,0 +1,6 @@
+#pragma once
+#include <furi_hal_resources.h>
+#include <furi_hal_power.h>
+#include <furi_hal_cortex.h>
+
+uint32_t furi_hal_random_get(void);
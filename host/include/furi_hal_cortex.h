@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+
+/* Частота ядра модели, как у Flipper Zero */
+#define FAKE_HAL_CPU_MHZ 64
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
+
+/* Счётчик тактов DWT. Каждое чтение DWT продвигает модельное время на длительность
+ * одного прохода цикла опроса линии (см. fakeHal_setLoopCycles), поэтому циклы
+ * ожидания драйвера идут в модели так же, как на железе */
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+DWT_Type* fakeHal_dwt(void);
+#define DWT (fakeHal_dwt())
+
+void __disable_irq(void);
+void __enable_irq(void);
@@ -0,0 +1,6 @@
+#pragma once
+#include <stdbool.h>
+
+bool furi_hal_power_is_otg_enabled(void);
+void furi_hal_power_enable_otg(void);
+void furi_hal_power_disable_otg(void);
@@ -0,0 +1,78 @@
+#pragma once
+#include <furi.h>
+#include <furi_hal_cortex.h>
+
+/* Регистры портов модели. Запись в BSRR применяется при ближайшем обращении к модели
+ * (чтении DWT, тика, задержке), IDR обновляется там же */
+typedef struct {
+    volatile uint32_t MODER;
+    volatile uint32_t IDR;
+    volatile uint32_t ODR;
+    volatile uint32_t BSRR;
+} GPIO_TypeDef;
+
+#define FAKE_HAL_PORTS 3
+extern GPIO_TypeDef fakeHal_ports[FAKE_HAL_PORTS];
+#define GPIOA (&fakeHal_ports[0])
+#define GPIOB (&fakeHal_ports[1])
+#define GPIOC (&fakeHal_ports[2])
+
+#define LL_GPIO_PIN_0 (1U << 0)
+#define LL_GPIO_PIN_1 (1U << 1)
+#define LL_GPIO_PIN_2 (1U << 2)
+#define LL_GPIO_PIN_3 (1U << 3)
+#define LL_GPIO_PIN_4 (1U << 4)
+#define LL_GPIO_PIN_5 (1U << 5)
+#define LL_GPIO_PIN_6 (1U << 6)
+#define LL_GPIO_PIN_7 (1U << 7)
+#define LL_GPIO_PIN_8 (1U << 8)
+#define LL_GPIO_PIN_9 (1U << 9)
+#define LL_GPIO_PIN_10 (1U << 10)
+#define LL_GPIO_PIN_11 (1U << 11)
+#define LL_GPIO_PIN_12 (1U << 12)
+#define LL_GPIO_PIN_13 (1U << 13)
+#define LL_GPIO_PIN_14 (1U << 14)
+#define LL_GPIO_PIN_15 (1U << 15)
+
+typedef struct {
+    GPIO_TypeDef* port;
+    uint16_t pin;
+} GpioPin;
+
+typedef enum {
+    GpioModeInput,
+    GpioModeOutputPushPull,
+    GpioModeOutputOpenDrain,
+    GpioModeAnalog,
+    GpioModeInterruptRise,
+    GpioModeInterruptFall,
+    GpioModeInterruptRiseFall,
+} GpioMode;
+typedef enum {
+    GpioPullNo,
+    GpioPullUp,
+    GpioPullDown,
+} GpioPull;
+typedef enum {
+    GpioSpeedLow,
+    GpioSpeedMedium,
+    GpioSpeedHigh,
+    GpioSpeedVeryHigh,
+} GpioSpeed;
+typedef void (*GpioExtiCallback)(void* ctx);
+
+void furi_hal_gpio_init(const GpioPin* gpio, GpioMode mode, GpioPull pull, GpioSpeed speed);
+void furi_hal_gpio_write(const GpioPin* gpio, bool state);
+bool furi_hal_gpio_read(const GpioPin* gpio);
+void furi_hal_gpio_add_int_callback(const GpioPin* gpio, GpioExtiCallback cb, void* ctx);
+void furi_hal_gpio_remove_int_callback(const GpioPin* gpio);
+
+extern const GpioPin gpio_ext_pa7;
+extern const GpioPin gpio_ext_pa6;
+extern const GpioPin gpio_ext_pa4;
+extern const GpioPin gpio_ext_pb3;
+extern const GpioPin gpio_ext_pb2;
+extern const GpioPin gpio_ext_pc3;
+extern const GpioPin gpio_ext_pc1;
+extern const GpioPin gpio_ext_pc0;
+extern const GpioPin ibutton_gpio;
@@ -0,0 +1,17 @@
+#pragma once
+#include <stdint.h>
+
+/* Дата и время модели. Кроме полей настоящей структуры хранит готовое unix-время */
+typedef struct {
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t day;
+    uint8_t month;
+    uint16_t year;
+    uint8_t weekday;
+    uint32_t timestamp;
+} FuriHalRtcDateTime;
+
+void furi_hal_rtc_get_datetime(FuriHalRtcDateTime* datetime);
+uint32_t furi_hal_rtc_datetime_to_timestamp(FuriHalRtcDateTime* datetime);
@@ -0,0 +1,10 @@
+#pragma once
+#include <gui/gui.h>
+
+void elements_scrollbar_pos(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    uint8_t height,
+    uint16_t pos,
+    uint16_t total);
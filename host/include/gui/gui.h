@@ -0,0 +1,63 @@
+#pragma once
+#include <furi.h>
+#include <input/input.h>
+
+/* Экран модели ничего не рисует, а только считает вызовы отрисовки (см. fake_gui.h) */
+typedef struct Canvas Canvas;
+typedef struct ViewPort ViewPort;
+typedef struct Gui Gui;
+typedef enum {
+    ColorWhite,
+    ColorBlack,
+    ColorXOR,
+} Color;
+typedef enum {
+    FontPrimary,
+    FontSecondary,
+    FontKeyboard,
+    FontBigNumbers,
+} Font;
+typedef enum {
+    AlignLeft,
+    AlignRight,
+    AlignTop,
+    AlignBottom,
+    AlignCenter,
+} Align;
+typedef enum {
+    GuiLayerDesktop,
+    GuiLayerWindow,
+    GuiLayerFullscreen,
+} GuiLayer;
+#define RECORD_GUI "gui"
+
+typedef void (*ViewPortDrawCallback)(Canvas* canvas, void* context);
+typedef void (*ViewPortInputCallback)(InputEvent* event, void* context);
+ViewPort* view_port_alloc(void);
+void view_port_free(ViewPort* view_port);
+void view_port_update(ViewPort* view_port);
+void view_port_enabled_set(ViewPort* view_port, bool enabled);
+void view_port_draw_callback_set(ViewPort* view_port, ViewPortDrawCallback callback, void* context);
+void view_port_input_callback_set(
+    ViewPort* view_port,
+    ViewPortInputCallback callback,
+    void* context);
+void gui_add_view_port(Gui* gui, ViewPort* view_port, GuiLayer layer);
+void gui_remove_view_port(Gui* gui, ViewPort* view_port);
+
+void canvas_clear(Canvas* canvas);
+void canvas_set_color(Canvas* canvas, Color color);
+void canvas_set_font(Canvas* canvas, Font font);
+void canvas_draw_str(Canvas* canvas, uint8_t x, uint8_t y, const char* str);
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    uint8_t x,
+    uint8_t y,
+    Align horizontal,
+    Align vertical,
+    const char* str);
+void canvas_draw_box(Canvas* canvas, uint8_t x, uint8_t y, uint8_t width, uint8_t height);
+void canvas_draw_line(Canvas* canvas, uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2);
+void canvas_draw_dot(Canvas* canvas, uint8_t x, uint8_t y);
+
+#include <gui/view.h>
@@ -0,0 +1,26 @@
+#pragma once
+#include <gui/gui.h>
+
+typedef struct View View;
+#define VIEW_NONE 0xFFFFFFFF
+#define VIEW_IGNORE 0xFFFFFFFE
+typedef void (*ViewDrawCallback)(Canvas* canvas, void* model);
+typedef bool (*ViewInputCallback)(InputEvent* event, void* context);
+typedef uint32_t (*ViewNavigationCallback)(void* context);
+typedef void (*ViewCallback)(void* context);
+typedef enum {
+    ViewModelTypeNone,
+    ViewModelTypeLockFree,
+    ViewModelTypeLocking,
+} ViewModelType;
+
+View* view_alloc(void);
+void view_free(View* view);
+void view_set_draw_callback(View* view, ViewDrawCallback callback);
+void view_set_input_callback(View* view, ViewInputCallback callback);
+void view_set_previous_callback(View* view, ViewNavigationCallback callback);
+void view_set_exit_callback(View* view, ViewCallback callback);
+void view_set_context(View* view, void* context);
+void view_allocate_model(View* view, ViewModelType type, size_t size);
+void* view_get_model(View* view);
+void view_commit_model(View* view, bool update);
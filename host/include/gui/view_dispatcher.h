@@ -0,0 +1,22 @@
+#pragma once
+#include <gui/view.h>
+
+typedef struct ViewDispatcher ViewDispatcher;
+typedef enum {
+    ViewDispatcherTypeDesktop,
+    ViewDispatcherTypeWindow,
+    ViewDispatcherTypeFullscreen,
+} ViewDispatcherType;
+
+ViewDispatcher* view_dispatcher_alloc(void);
+void view_dispatcher_free(ViewDispatcher* view_dispatcher);
+void view_dispatcher_enable_queue(ViewDispatcher* view_dispatcher);
+void view_dispatcher_attach_to_gui(
+    ViewDispatcher* view_dispatcher,
+    Gui* gui,
+    ViewDispatcherType type);
+void view_dispatcher_add_view(ViewDispatcher* view_dispatcher, uint32_t view_id, View* view);
+void view_dispatcher_remove_view(ViewDispatcher* view_dispatcher, uint32_t view_id);
+void view_dispatcher_switch_to_view(ViewDispatcher* view_dispatcher, uint32_t view_id);
+/* Модель не крутит цикл событий: возврат сразу, как из закрытого диспетчера */
+void view_dispatcher_run(ViewDispatcher* view_dispatcher);
@@ -0,0 +1,7 @@
+#pragma once
+
+typedef struct NotificationApp NotificationApp;
+typedef struct NotificationSequence NotificationSequence;
+#define RECORD_NOTIFICATION "notification"
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence);
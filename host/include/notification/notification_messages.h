@@ -0,0 +1,8 @@
+#pragma once
+#include <notification/notification.h>
+
+extern const NotificationSequence sequence_display_backlight_enforce_on;
+extern const NotificationSequence sequence_display_backlight_enforce_auto;
+extern const NotificationSequence sequence_audiovisual_alert;
+extern const NotificationSequence sequence_blink_start_red;
+extern const NotificationSequence sequence_blink_stop;
@@ -0,0 +1,39 @@
+#pragma once
+#include <furi.h>
+
+/* Хранилище модели - каталог компьютера, в который отображается /ext (см. fake_storage.h) */
+typedef struct Storage Storage;
+typedef struct File File;
+#define RECORD_STORAGE "storage"
+typedef enum {
+    FSE_OK = 0,
+    FSE_NOT_READY,
+    FSE_EXIST,
+    FSE_NOT_EXIST,
+    FSE_INTERNAL,
+} FS_Error;
+typedef enum {
+    FSAM_READ = 1,
+    FSAM_WRITE = 2,
+    FSAM_READ_WRITE = 3,
+} FS_AccessMode;
+typedef enum {
+    FSOM_OPEN_EXISTING = 1,
+    FSOM_OPEN_ALWAYS = 2,
+    FSOM_OPEN_APPEND = 4,
+    FSOM_CREATE_NEW = 8,
+    FSOM_CREATE_ALWAYS = 16,
+} FS_OpenMode;
+
+FS_Error storage_common_mkdir(Storage* storage, const char* path);
+FS_Error storage_common_remove(Storage* storage, const char* path);
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path);
+bool storage_file_exists(Storage* storage, const char* path);
+File* storage_file_alloc(Storage* storage);
+void storage_file_free(File* file);
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode);
+bool storage_file_close(File* file);
+uint16_t storage_file_read(File* file, void* buff, uint16_t bytes_to_read);
+uint16_t storage_file_write(File* file, const void* buff, uint16_t bytes_to_write);
+uint64_t storage_file_size(File* file);
+bool storage_file_seek(File* file, uint32_t offset, bool from_start);
@@ -0,0 +1,10 @@
+#pragma once
+#include <storage/storage.h>
+
+typedef struct Stream Stream;
+Stream* file_stream_alloc(Storage* storage);
+bool file_stream_open(Stream* stream, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode);
+void stream_free(Stream* stream);
+size_t stream_read(Stream* stream, uint8_t* data, size_t size);
+size_t stream_write(Stream* stream, const uint8_t* data, size_t size);
+size_t stream_write_format(Stream* stream, const char* format, ...);
@@ -0,0 +1,89 @@
+#pragma once
+/* Простейшие проверки: неудачная проверка печатается и помечает тест проваленным */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+static int testFailures = 0;
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if(!(cond)) {                                                            \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            testFailures++;                                                      \
+        }                                                                        \
+    } while(0)
+
+#define CHECK_EQ(actual, expected)                                        \
+    do {                                                                  \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);   \
+        if(a_ != e_) {                                                    \
+            fprintf(                                                      \
+                stderr,                                                   \
+                "%s:%d: %s = %lld, expected %lld\n",                      \
+                __FILE__,                                                 \
+                __LINE__,                                                 \
+                #actual,                                                  \
+                a_,                                                       \
+                e_);                                                      \
+            testFailures++;                                               \
+        }                                                                 \
+    } while(0)
+
+#define CHECK_STR(actual, expected)                                                       \
+    do {                                                                                  \
+        const char *a_ = (actual), *e_ = (expected);                                      \
+        if(a_ == NULL || strcmp(a_, e_) != 0) {                                           \
+            fprintf(                                                                      \
+                stderr, "%s:%d: %s = \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #actual, \
+                a_ ? a_ : "(null)", e_);                                                  \
+            testFailures++;                                                               \
+        }                                                                                 \
+    } while(0)
+
+/**
+ * @brief Итог теста для main: 0 - все проверки прошли
+ */
+static inline int test_result(const char* name) {
+    if(testFailures > 0) {
+        fprintf(stderr, "%s: %d checks failed\n", name, testFailures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+/**
+ * @brief Новый пустой каталог для хранилища модели
+ */
+static inline const char* test_tempDir(void) {
+    static char dir[64];
+    snprintf(dir, sizeof(dir), "/tmp/dhtmon_test_XXXXXX");
+    if(mkdtemp(dir) == NULL) abort();
+    return dir;
+}
+
+/**
+ * @brief Запись файла целиком
+ */
+static inline void test_writeFile(const char* path, const char* text) {
+    FILE* fp = fopen(path, "wb");
+    if(fp == NULL) abort();
+    fputs(text, fp);
+    fclose(fp);
+}
+
+/**
+ * @brief Чтение файла целиком в буфер
+ *
+ * @return Длина файла или -1, если его нет
+ */
+static inline long test_readFile(const char* path, char* buffer, size_t size) {
+    FILE* fp = fopen(path, "rb");
+    if(fp == NULL) return -1;
+    size_t len = fread(buffer, 1, size - 1, fp);
+    buffer[len] = '\0';
+    fclose(fp);
+    return len;
+}
@@ -0,0 +1,256 @@
+/* Разбор файла датчиков на случайных файлах: построчно сверяется с независимой простой моделью
+ * формата, мусор не роняет загрузку, загруженное переживает сохранение и повторную загрузку */
+#include "test.h"
+#include "fake_hal.h"
+#include "fake_app.h"
+#include "fake_storage.h"
+#include "../bench/bench.h"
+
+#define FILES 3000 //Файлов для сверки с моделью
+#define GARBAGE_FILES 300 //Файлов из случайных байт
+#define MODEL_MAX 64 //Строк в файле не больше
+
+static char path[512];
+static uint32_t rng = 12345;
+static uint32_t mismatches = 0;
+
+static uint32_t test_random(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static const char* test_pick(const char* const* items, size_t count) {
+    return items[test_random() % count];
+}
+#define PICK(items) test_pick(items, sizeof(items) / sizeof(items[0]))
+
+//Поля строки: правильные, пограничные и ошибочные
+static const char* const names[] = {
+    "Room", "_x", "9lives", "TenLetters", "ElevenChars", "-bad", "#hash", "a#b", "Ünï", "x"};
+static const char* const types[] = {"0", "1", "2", "3", "4", "256", "257", "-1", "1x", "01"};
+static const char* const gpios[] = {
+    "2", "3", "4", "5", "6", "7", "13", "14", "15", "16", "17", "8", "255", "258", "0", "x"};
+static const char* const intervals[] = {"0", "5", "60", "600", "4294968", "1000009", "-5", "1.5"};
+static const char* const limits[] = {
+    "-", "0", "30", "-30", "-40", "100", "1000", "1001", "--5", "5-", "-0", "x", "99999999"};
+static const char* const separators[] = {" ", "  ", "\t", " \t ", "\r "};
+
+//Датчик по простой модели формата
+typedef struct {
+    char name[11];
+    uint8_t type;
+    uint8_t gpio;
+    uint32_t interval;
+    uint8_t enabled;
+    int16_t limit[DHT_ALARMS_COUNT];
+} test_modelSensor;
+
+static test_modelSensor model[MODEL_MAX];
+static uint16_t modelCount;
+
+/**
+ * @brief Число поля как его понимает формат: только цифры, у порогов - знак минус впереди
+ *
+ * @return false Поле ошибочно
+ */
+static bool test_modelNumber(
+    const char* token,
+    bool sign,
+    bool* negative,
+    bool* digits,
+    uint32_t* value) {
+    *negative = *digits = false;
+    *value = 0;
+    if(sign && token[0] == '-') {
+        *negative = true;
+        token++;
+    }
+    for(; *token; token++) {
+        if(*token < '0' || *token > '9' || *value > 100000) return false;
+        *value = *value * 10 + (*token - '0');
+        *digits = true;
+    }
+    return true;
+}
+
+/**
+ * @brief Разбор строки моделью
+ */
+static void test_modelLine(char* line) {
+    char* tokens[16];
+    uint8_t count = 0;
+    char* token = strtok(line, " \t\r");
+    for(; token != NULL && count < 16; token = strtok(NULL, " \t\r")) {
+        tokens[count++] = token;
+    }
+    if(count < 3 || tokens[0][0] == '#' || strlen(tokens[0]) > 10) return;
+    test_modelSensor sensor = {0};
+    strcpy(sensor.name, tokens[0]);
+    char first = sensor.name[0];
+    if(!((first >= '0' && first <= '9') || (first >= 'A' && first <= 'Z') ||
+         (first >= 'a' && first <= 'z') || first == '_')) {
+        return;
+    }
+    uint32_t values[DHTMON_LINE_VALUES] = {0};
+    bool digits[DHTMON_LINE_VALUES] = {0}, negative[DHTMON_LINE_VALUES] = {0};
+    for(uint8_t field = 0; field < DHTMON_LINE_VALUES && field + 1 < count; field++) {
+        bool sign = field >= DHTMON_LINE_THRESHOLD;
+        bool valid = test_modelNumber(
+            tokens[field + 1], sign, &negative[field], &digits[field], &values[field]);
+        if(!valid) return;
+    }
+    //Тип - номер известного драйверу типа, порт - номер контакта на корпусе
+    if(values[0] >= DHT_TYPES_COUNT) return;
+    if(values[1] > 255 || DHTMon_GPIO_form_int(values[1]) == NULL) return;
+    sensor.type = values[0];
+    sensor.gpio = values[1];
+    sensor.interval = values[2] * 1000;
+    for(uint8_t alarm = 0; alarm < DHT_ALARMS_COUNT; alarm++) {
+        uint8_t field = DHTMON_LINE_THRESHOLD + alarm;
+        if(!digits[field] || values[field] > 1000) continue;
+        sensor.enabled |= 1 << alarm;
+        sensor.limit[alarm] = (negative[field] ? -1 : 1) * (int16_t)values[field] * 10;
+    }
+    if(modelCount < MODEL_MAX) model[modelCount++] = sensor;
+}
+
+/**
+ * @brief Случайная строка файла датчиков
+ */
+static void test_randomLine(char* line, size_t size) {
+    size_t len = 0;
+    uint8_t kind = test_random() % 10;
+    if(kind == 0) {
+        snprintf(line, size, "#%s %s", PICK(names), PICK(types));
+        return;
+    }
+    if(kind == 1) {
+        line[0] = '\0';
+        return;
+    }
+    //Ведущие пробелы, затем поля через случайные разделители
+    if(test_random() % 4 == 0) len += snprintf(line + len, size - len, "%s", PICK(separators));
+    const char* fields[DHTMON_LINE_VALUES + 2];
+    uint8_t count = 1 + test_random() % (DHTMON_LINE_VALUES + 2);
+    fields[0] = PICK(names);
+    for(uint8_t i = 1; i < count; i++) {
+        if(i == 1) fields[i] = PICK(types);
+        else if(i == 2) fields[i] = PICK(gpios);
+        else if(i == 3) fields[i] = PICK(intervals);
+        else fields[i] = PICK(limits);
+    }
+    for(uint8_t i = 0; i < count; i++) {
+        len += snprintf(line + len, size - len, "%s%s", i > 0 ? PICK(separators) : "", fields[i]);
+    }
+    if(test_random() % 4 == 0) len += snprintf(line + len, size - len, "%s", PICK(separators));
+}
+
+static bool test_sameSensor(const DHT_sensor* sensor, const test_modelSensor* expected) {
+    if(strcmp(sensor->name, expected->name) != 0) return false;
+    if(sensor->type != expected->type) return false;
+    if(DHTMon_GPIO_to_int(sensor->GPIO) != expected->gpio) return false;
+    if(sensor->pollingInterval != expected->interval) return false;
+    if(sensor->thresholds.enabled != expected->enabled) return false;
+    for(uint8_t alarm = 0; alarm < DHT_ALARMS_COUNT; alarm++) {
+        if((expected->enabled & (1 << alarm)) &&
+           sensor->thresholds.limit[alarm] != expected->limit[alarm]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool test_sameAsModel(PluginData* app, const char* text) {
+    bool same = app->sensors_count == modelCount;
+    for(uint16_t i = 0; same && i < modelCount; i++) {
+        same = test_sameSensor(&app->sensors[i], &model[i]);
+    }
+    if(!same && mismatches++ < 3) {
+        fprintf(
+            stderr,
+            "model mismatch: %d sensors, model %u, file:\n%s\n",
+            app->sensors_count,
+            modelCount,
+            text);
+    }
+    return same;
+}
+
+static void test_modelFiles(PluginData* app) {
+    static char text[MODEL_MAX * 96];
+    uint64_t bytes = 0, ns = 0, sensors = 0;
+    for(uint32_t file = 0; file < FILES; file++) {
+        size_t len = 0;
+        modelCount = 0;
+        uint8_t lines = 1 + test_random() % (MODEL_MAX - 1);
+        for(uint8_t i = 0; i < lines; i++) {
+            char line[96];
+            test_randomLine(line, sizeof(line));
+            bool last = i + 1 == lines;
+            //Последняя строка иногда без перевода строки
+            const char* end = last && file % 2 ? "" : "\n";
+            len += snprintf(text + len, sizeof(text) - len, "%s%s", line, end);
+            test_modelLine(line);
+        }
+        test_writeFile(path, text);
+        uint64_t start = bench_ns();
+        DHTMon_sensors_load();
+        ns += bench_ns() - start;
+        bytes += len;
+        sensors += modelCount;
+        if(!test_sameAsModel(app, text)) continue;
+        //Сохранённый файл загружается в те же датчики
+        if(modelCount > 0) {
+            CHECK_EQ(DHTMon_sensors_save(), modelCount);
+            DHTMon_sensors_load();
+            test_sameAsModel(app, "(saved copy)");
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+    printf(
+        "configFuzz: %u files, %llu bytes, %llu valid sensors, %llu ns per byte\n",
+        FILES,
+        (unsigned long long)bytes,
+        (unsigned long long)sensors,
+        (unsigned long long)(ns / (bytes ? bytes : 1)));
+}
+
+static void test_garbageFiles(PluginData* app) {
+    //Случайные байты, в том числе нули и очень длинные строки
+    static char text[32768];
+    for(uint32_t file = 0; file < GARBAGE_FILES; file++) {
+        size_t len = test_random() % (file == 0 ? sizeof(text) : 2048);
+        for(size_t i = 0; i < len; i++) {
+            uint32_t r = test_random();
+            text[i] = r % 8 == 0 ? '\n' : r % 8 == 1 ? ' ' : (char)(r >> 8);
+        }
+        FILE* fp = fopen(path, "wb");
+        if(fp == NULL) abort();
+        fwrite(text, 1, len, fp);
+        fclose(fp);
+        DHTMon_sensors_load();
+        CHECK(app->sensors_count >= 0);
+        for(int16_t i = 0; i < app->sensors_count; i++) {
+            CHECK(DHTMon_sensor_check(&app->sensors[i]));
+            CHECK(app->sensors[i].type < DHT_TYPES_COUNT);
+        }
+    }
+    //Строка длиннее любого буфера без единого перевода строки
+    memset(text, 'A', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    test_writeFile(path, text);
+    CHECK(!DHTMon_sensors_load());
+    CHECK_EQ(app->sensors_count, 0);
+}
+
+int main(void) {
+    fakeHal_reset(1);
+    PluginData* app = fakeApp_start(test_tempDir());
+    fakeStorage_hostPath(APP_FILEPATH, path, sizeof(path));
+    test_modelFiles(app);
+    test_garbageFiles(app);
+    fakeApp_stop();
+    return test_result("test_configFuzz");
+}
@@ -0,0 +1,156 @@
+/* Приём по прерываниям EXTI: запись фронтов ответа датчика совпадает с его сценарием,
+ * декодируется так же, как при приёме опросом, и переживает потерянный подъём линии */
+#include "test.h"
+#include "fake_hal.h"
+#include "fake_app.h"
+
+#define POLLS 50
+
+static DHT_waveform wave;
+
+static void test_initSensor(DHT_sensor* sensor, const GpioPin* gpio, uint8_t type) {
+    memset(sensor, 0, sizeof(DHT_sensor));
+    strcpy(sensor->name, "Exti");
+    sensor->GPIO = gpio;
+    sensor->type = type;
+    DHT_initLine(sensor, 0);
+    DHT_resetState(sensor);
+    furi_hal_gpio_write(gpio, true);
+    furi_hal_gpio_init(gpio, GpioModeOutputOpenDrain, GpioPullUp, GpioSpeedVeryHigh);
+}
+
+/**
+ * @brief Опрос датчика с записью ответа
+ */
+static DHT_data test_poll(DHT_sensor* sensor) {
+    memset(&wave, 0, sizeof(wave));
+    sensor->lastPollingTime = 0;
+    sensor->wave = &wave;
+    return DHT_getData(sensor);
+}
+
+/**
+ * @brief Уровень записи совпадает с уровнем сценария с точностью до микросекунды
+ */
+static void test_checkWidth(uint8_t index, uint8_t level, uint8_t expected) {
+    CHECK_EQ((wave.firstLevel ^ index) & 1, level);
+    int diff = (int)wave.width[index] - expected;
+    if(diff < -1 || diff > 1) {
+        fprintf(stderr, "width[%u] = %u, expected %u\n", index, wave.width[index], expected);
+        testFailures++;
+    }
+}
+
+static void test_edgeTrace(void) {
+    //Линия PA7 свободна от кнопок, ответ принимается по прерываниям
+    FakeSensorTiming timing = fakeSensor_defaultTiming(DHT22);
+    fakeSensor_attach(&gpio_ext_pa7, &timing);
+    uint8_t rawData[5];
+    fakeSensor_encode(DHT22, 235, 481, rawData);
+    fakeSensor_setFrame(&gpio_ext_pa7, rawData);
+    DHT_sensor sensor;
+    test_initSensor(&sensor, &gpio_ext_pa7, DHT22);
+
+    DHT_data data = test_poll(&sensor);
+    CHECK_EQ(data.status, DHT_OK);
+    CHECK_EQ(data.temp, 235);
+    CHECK_EQ(data.hum, 481);
+    CHECK(wave.ready);
+    CHECK_EQ(wave.response, DHT_RESPONSE_OK);
+    //Фронты: подъём линии, подтверждение, 40 бит, последний спад и отпускание линии
+    CHECK_EQ(wave.count, 84);
+    CHECK_EQ(wave.firstLevel, 1);
+    test_checkWidth(0, 1, timing.response);
+    test_checkWidth(1, 0, timing.ackLow);
+    test_checkWidth(2, 1, timing.ackHigh);
+    for(uint8_t bit = 0; bit < 40; bit++) {
+        bool one = rawData[bit / 8] & (1 << (7 - bit % 8));
+        test_checkWidth(3 + bit * 2, 0, timing.bitLow);
+        test_checkWidth(4 + bit * 2, 1, one ? timing.one : timing.zero);
+    }
+    //Запись фронтов декодируется в те же байты
+    uint8_t decoded[5] = {0};
+    DHT_timing pulses = {.zeroMin = 255, .oneMin = 255};
+    CHECK_EQ(DHT_decodeWave(&wave, decoded, &pulses), DHT_RESPONSE_OK);
+    CHECK(memcmp(decoded, rawData, 5) == 0);
+    DHTMon_waveReport report;
+    DHTMon_wave_analyze(&wave, &report);
+    CHECK_EQ(report.bits, 40);
+
+    //Разброс длительностей в пределах даташита не мешает приёму
+    timing.jitter = 3;
+    fakeSensor_setTiming(&gpio_ext_pa7, &timing);
+    uint32_t ok = 0;
+    for(uint16_t i = 0; i < POLLS; i++) {
+        data = test_poll(&sensor);
+        if(data.status == DHT_OK && data.temp == 235 && data.hum == 481) ok++;
+    }
+    CHECK_EQ(ok, POLLS);
+    //Во время приёма прерывания не выключались
+    CHECK_EQ(sensor.stats.irqMax, 0);
+    fakeSensor_detach(&gpio_ext_pa7);
+}
+
+static void test_lostRise(void) {
+    //Обработчик подключается позже подъёма линии: первый записанный фронт - спад подтверждения
+    FakeSensorTiming timing = fakeSensor_defaultTiming(DHT22);
+    fakeSensor_attach(&gpio_ext_pa7, &timing);
+    uint8_t rawData[5];
+    fakeSensor_encode(DHT22, -101, 500, rawData);
+    fakeSensor_setFrame(&gpio_ext_pa7, rawData);
+    DHT_sensor sensor;
+    test_initSensor(&sensor, &gpio_ext_pa7, DHT22);
+    fakeHal_setIrqArmDelay(10 * FAKE_HAL_CPU_MHZ);
+
+    DHT_data data = test_poll(&sensor);
+    CHECK_EQ(data.status, DHT_OK);
+    CHECK_EQ(data.temp, -101);
+    //Пропущенный подъём записан уровнем нулевой длины
+    CHECK_EQ(wave.firstLevel, 1);
+    CHECK_EQ(wave.width[0], 0);
+    DHTMon_waveReport report;
+    DHTMon_wave_analyze(&wave, &report);
+    CHECK_EQ(report.ackLow, timing.ackLow);
+    CHECK_EQ(report.ackHigh, timing.ackHigh);
+    CHECK_EQ(report.bits, 40);
+    fakeHal_setIrqArmDelay(0);
+    fakeSensor_detach(&gpio_ext_pa7);
+}
+
+static void test_reservedLine(void) {
+    //На PA6 линия EXTI занята кнопкой, приём идёт опросом линии
+    FakeSensorTiming timing = fakeSensor_defaultTiming(DHT11);
+    fakeSensor_attach(&gpio_ext_pa6, &timing);
+    uint8_t rawData[5];
+    fakeSensor_encode(DHT11, 237, 480, rawData);
+    fakeSensor_setFrame(&gpio_ext_pa6, rawData);
+    DHT_sensor sensor;
+    test_initSensor(&sensor, &gpio_ext_pa6, DHT11);
+
+    DHT_data data = test_poll(&sensor);
+    CHECK_EQ(data.status, DHT_OK);
+    CHECK_EQ(data.temp, 237);
+    CHECK_EQ(data.hum, 480);
+    //Запись опросом начинается с низкого уровня до подъёма линии
+    CHECK_EQ(wave.firstLevel, 0);
+    CHECK(sensor.stats.irqMax > 0);
+    fakeSensor_detach(&gpio_ext_pa6);
+}
+
+static void test_absent(void) {
+    DHT_sensor sensor;
+    test_initSensor(&sensor, &gpio_ext_pa7, DHT22);
+    DHT_data data = test_poll(&sensor);
+    CHECK_EQ(data.status, DHT_NO_RESPONSE);
+    CHECK_EQ(wave.response, DHT_RESPONSE_ABSENT);
+    CHECK_EQ(sensor.stats.timeouts[DHT_PHASE_RESPONSE], 1);
+}
+
+int main(void) {
+    fakeHal_reset(1);
+    test_edgeTrace();
+    test_lostRise();
+    test_reservedLine();
+    test_absent();
+    return test_result("test_exti");
+}
@@ -0,0 +1,138 @@
+/* Конвертация в десятые доли и печать без float дают то же, что прежние вычисления во float,
+ * на всём пространстве значений каждого поля ответа */
+#include <math.h>
+#include "test.h"
+#include "fake_hal.h"
+
+//Расхождений по видам, чтобы не печатать их тысячами
+static uint32_t statusMismatches, valueMismatches, textMismatches;
+static uint32_t compared, valid;
+
+/**
+ * @brief Показания по прежней конвертации во float
+ */
+typedef struct {
+    float temp;
+    float hum;
+    uint8_t status;
+} test_floatData;
+
+static test_floatData test_floatConvert(uint8_t type, const uint8_t rawData[5]) {
+    test_floatData data;
+    if(type == DHT11) {
+        data.hum = rawData[0];
+        data.temp = rawData[2] + (rawData[3] & 0x7F) * 0.1f;
+        if(rawData[3] & 0x80) data.temp = -data.temp;
+    } else {
+        data.hum = (uint16_t)((rawData[0] << 8) | rawData[1]) * 0.1f;
+        data.temp = (uint16_t)(((rawData[2] & 0x7F) << 8) | rawData[3]) * 0.1f;
+        if(rawData[2] & 0x80) data.temp = -data.temp;
+    }
+    bool range = data.hum > 100.0f || data.temp < -40.0f || data.temp > 80.0f;
+    data.status = range ? DHT_OUT_OF_RANGE : DHT_OK;
+    return data;
+}
+
+/**
+ * @brief Печать значения так, как её делал printf во float. -0.0 печатается без знака
+ */
+static void test_floatText(char* str, size_t size, float value) {
+    snprintf(str, size, "%.1f", value);
+    if(strcmp(str, "-0.0") == 0) strcpy(str, "0.0");
+}
+
+static void test_compare(uint8_t type, uint8_t rawData[5]) {
+    rawData[4] = rawData[0] + rawData[1] + rawData[2] + rawData[3];
+    //Нулевой ответ отвергается намеренно: датчик ещё не закончил первое измерение
+    if((rawData[0] | rawData[1] | rawData[2] | rawData[3]) == 0) return;
+    test_floatData expected = test_floatConvert(type, rawData);
+    compared++;
+    DHT_data data = {.status = DHT_NO_RESPONSE};
+    DHT_convert(type, rawData, &data);
+    if(data.status != expected.status) {
+        if(statusMismatches++ < 5) {
+            fprintf(
+                stderr,
+                "%s %02X %02X %02X %02X: status %u, float %u\n",
+                DHT_getDriver(type)->name,
+                rawData[0],
+                rawData[1],
+                rawData[2],
+                rawData[3],
+                data.status,
+                expected.status);
+        }
+        return;
+    }
+    if(data.status != DHT_OK) return;
+    valid++;
+    if(data.temp != lroundf(expected.temp * 10) || data.hum != lroundf(expected.hum * 10)) {
+        valueMismatches++;
+        return;
+    }
+    char fixed[16], floating[16];
+    DHT_formatTenths(fixed, sizeof(fixed), data.temp);
+    test_floatText(floating, sizeof(floating), expected.temp);
+    if(strcmp(fixed, floating) != 0) textMismatches++;
+    DHT_formatTenths(fixed, sizeof(fixed), data.hum);
+    test_floatText(floating, sizeof(floating), expected.hum);
+    if(strcmp(fixed, floating) != 0) textMismatches++;
+}
+
+static void test_dht22(void) {
+    //Каждое 16-битное поле перебирается целиком при обычном значении другого
+    for(uint32_t word = 0; word <= 0xFFFF; word++) {
+        uint8_t hum[5] = {word >> 8, word & 0xFF, 0x00, 0xC8};
+        test_compare(DHT22, hum);
+        uint8_t temp[5] = {0x01, 0xF4, word >> 8, word & 0xFF};
+        test_compare(DHT22, temp);
+    }
+}
+
+static void test_dht11(void) {
+    //Температура ASAIR DHT11 - все сочетания целой части и байта знака с десятыми
+    for(uint32_t word = 0; word <= 0xFFFF; word++) {
+        uint8_t temp[5] = {50, 0x00, word >> 8, word & 0xFF};
+        test_compare(DHT11, temp);
+    }
+    for(uint16_t hum = 0; hum <= 0xFF; hum++) {
+        uint8_t rawData[5] = {hum, 0x00, 22, 0x05};
+        test_compare(DHT11, rawData);
+    }
+}
+
+static void test_formatAll(void) {
+    //Печать всего диапазона int16_t против printf
+    uint32_t mismatches = 0;
+    for(int32_t value = INT16_MIN; value <= INT16_MAX; value++) {
+        char fixed[16], reference[16];
+        uint8_t len = DHT_formatTenths(fixed, sizeof(fixed), value);
+        snprintf(
+            reference,
+            sizeof(reference),
+            "%s%d.%d",
+            value < 0 ? "-" : "",
+            abs(value) / 10,
+            abs(value) % 10);
+        if(strcmp(fixed, reference) != 0 || len != strlen(reference)) mismatches++;
+    }
+    CHECK_EQ(mismatches, 0);
+    //Короткий буфер даёт пустую строку
+    char small[4];
+    CHECK_EQ(DHT_formatTenths(small, sizeof(small), -123), 0);
+    CHECK_STR(small, "");
+    CHECK_EQ(DHT_formatTenths(small, sizeof(small), 12), 3);
+    CHECK_STR(small, "1.2");
+}
+
+int main(void) {
+    fakeHal_reset(1);
+    test_dht22();
+    test_dht11();
+    printf("fixedPoint: %u frames compared, %u in range\n", compared, valid);
+    CHECK_EQ(statusMismatches, 0);
+    CHECK_EQ(valueMismatches, 0);
+    CHECK_EQ(textMismatches, 0);
+    test_formatAll();
+    return test_result("test_fixedPoint");
+}
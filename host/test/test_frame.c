@@ -0,0 +1,116 @@
+/* Отрисовка главного экрана: кадр берёт только снимок показаний и не трогает линии датчиков,
+ * поэтому не ждёт ответа датчика и не двигает модельное время. Рисуются только видимые строки,
+ * поэтому цена кадра не растёт с числом загруженных датчиков */
+#include "test.h"
+#include "fake_hal.h"
+#include "fake_app.h"
+#include "fake_gui.h"
+#include "fake_storage.h"
+#include "../bench/bench.h"
+
+#define FRAMES 1000
+#define SCROLL_CALLS 2 //Вызовов на указатель прокрутки, когда датчиков больше, чем строк
+
+//Датчики на линиях отвечают, если их всё же опросят
+static const GpioPin* const gpios[] = {&gpio_ext_pa7, &gpio_ext_pa6, &gpio_ext_pa4};
+static const uint8_t types[] = {DHT22, DHT11, AM2301};
+static const char* const names[] = {"Room", "Cellar", "Freezer"};
+static const uint8_t ports[] = {2, 3, 4};
+
+static void test_attachSensors(void) {
+    for(uint8_t i = 0; i < 3; i++) {
+        FakeSensorTiming timing = fakeSensor_defaultTiming(types[i]);
+        fakeSensor_attach(gpios[i], &timing);
+        uint8_t rawData[5];
+        fakeSensor_encode(types[i], 215 + i, 450 + 10 * i, rawData);
+        fakeSensor_setFrame(gpios[i], rawData);
+    }
+}
+
+/**
+ * @brief Загрузка count датчиков на трёх линиях по кругу и публикация их показаний
+ */
+static bool test_loadSensors(PluginData* app, uint16_t count) {
+    static char config[2048];
+    size_t len = 0;
+    for(uint16_t i = 0; i < count; i++) {
+        len += snprintf(
+            config + len,
+            sizeof(config) - len,
+            "%.6s%u %u %u\n",
+            names[i % 3],
+            i / 3,
+            types[i % 3],
+            ports[i % 3]);
+    }
+    char path[512];
+    fakeStorage_hostPath(APP_FILEPATH, path, sizeof(path));
+    test_writeFile(path, config);
+    CHECK(DHTMon_sensors_load());
+    CHECK_EQ(app->sensors_count, count);
+    if(app->sensors_count != count) return false;
+
+    DHT_data data = {.temp = 215, .hum = 450, .status = DHT_OK, .type = DHT22};
+    for(uint16_t i = 0; i < count; i++) fakeApp_publish(i, &data, 0);
+    if(count >= 3) {
+        data = (DHT_data){.status = DHT_NO_RESPONSE, .type = DHT11};
+        fakeApp_publish(1, &data, 0);
+        data = (DHT_data){.temp = -52, .hum = 980, .status = DHT_STALE, .type = AM2301};
+        fakeApp_publish(2, &data, 1 << DHT_ALARM_HUM_HIGH);
+    }
+    return true;
+}
+
+/**
+ * @brief Отрисовка FRAMES кадров
+ *
+ * @return Вызовов отрисовки за кадр
+ */
+static uint32_t test_drawFrames(PluginData* app) {
+    uint32_t accesses = fakeHal_gpioAccesses();
+    uint64_t now = fakeHal_now();
+    uint64_t start = bench_ns();
+    for(uint16_t i = 0; i < FRAMES; i++) {
+        fakeApp_draw();
+    }
+    uint64_t frameNs = (bench_ns() - start) / FRAMES;
+
+    //Ни обращений к линиям, ни ожидания на модельных часах
+    CHECK_EQ(fakeHal_gpioAccesses(), accesses);
+    CHECK_EQ(fakeHal_now(), now);
+    CHECK_EQ(fakeSensor_responses(&gpio_ext_pa7), 0);
+    //Кадр показывает опубликованные показания
+    const char* text = fakeGui_canvasText();
+    CHECK(strstr(text, "Room0") != NULL);
+    CHECK(strstr(text, "21.5*C/45%") != NULL);
+    if(app->sensors_count >= 3) {
+        CHECK(strstr(text, "timeout") != NULL);
+        CHECK(strstr(text, "-5.2*C/98%?") != NULL);
+        CHECK(strstr(text, "!") != NULL);
+    }
+    uint32_t calls = fakeGui_canvasCalls();
+    CHECK(calls > 0);
+    printf(
+        "frame: %llu ns per frame, %lu canvas calls, %u sensors\n",
+        (unsigned long long)frameNs,
+        (unsigned long)calls,
+        app->sensors_count);
+    return calls;
+}
+
+int main(void) {
+    fakeHal_reset(1);
+    test_attachSensors();
+    PluginData* app = fakeApp_start(test_tempDir());
+    //Кадр рисует только видимые строки, сколько бы датчиков ни было загружено
+    static const uint16_t sizes[] = {1, 3, DHTMON_MONITOR_ROWS, 32};
+    uint32_t calls[sizeof(sizes) / sizeof(sizes[0])] = {0};
+    for(uint8_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if(test_loadSensors(app, sizes[i])) calls[i] = test_drawFrames(app);
+    }
+    //Строк больше видимых не рисуется: кадр 32 датчиков не дороже кадра полного экрана
+    CHECK(calls[0] < calls[2]);
+    CHECK(calls[3] <= calls[2] + SCROLL_CALLS);
+    fakeApp_stop();
+    return test_result("test_frame");
+}
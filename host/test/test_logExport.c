@@ -0,0 +1,141 @@
+/* Журнал показаний: записанное через DHTMon_logger_add возвращается из CSV запись в запись,
+ * блок с испорченной контрольной суммой пропускается, не задевая соседние */
+#include <furi_hal_rtc.h>
+#include "test.h"
+#include "fake_hal.h"
+#include "fake_app.h"
+#include "fake_storage.h"
+
+#define SENSORS 2
+#define RECORDS 300 //Записей первого датчика, у второго - втрое меньше
+
+static char expected[SENSORS][RECORDS][DHTMON_LOG_LINE];
+static uint16_t expectedCount[SENSORS];
+static char csv[65536], copy[65536], logData[16384];
+static char logPath[512], csvPath[512], copyPath[520];
+
+/**
+ * @brief Десятые доли так, как их печатает printf
+ */
+static void test_tenths(char* str, size_t size, int16_t value) {
+    snprintf(str, size, "%s%d.%d", value < 0 ? "-" : "", abs(value) / 10, abs(value) % 10);
+}
+
+static void test_add(PluginData* app, uint16_t index, const DHT_data* data) {
+    FuriHalRtcDateTime datetime;
+    furi_hal_rtc_get_datetime(&datetime);
+    char temp[8] = "", hum[8] = "";
+    if(data->status == DHT_OK) {
+        test_tenths(temp, sizeof(temp), data->temp);
+        test_tenths(hum, sizeof(hum), data->hum);
+    }
+    snprintf(
+        expected[index][expectedCount[index]++],
+        DHTMON_LOG_LINE,
+        "%lu;%s;%s;%s;%u",
+        (unsigned long)datetime.timestamp,
+        app->sensors[index].name,
+        temp,
+        hum,
+        data->status);
+    DHTMon_logger_add(index, &app->sensors[index], data);
+}
+
+static void test_writeLog(PluginData* app) {
+    DHTMon_logger_enable(true);
+    for(uint16_t i = 0; i < RECORDS; i++) {
+        //Шаг времени от секунды до нескольких суток, чтобы шаг занимал разное число байт
+        uint64_t seconds = i == 150 ? 300000 : 1 + i % 3;
+        fakeHal_advance(seconds * 1000 * FAKE_HAL_CYCLES_PER_MS);
+        //Температура переходит через ноль, чтобы разности были обоих знаков
+        DHT_data data = {.temp = 30 - (int16_t)(i % 70), .hum = 400 + i % 17, .status = DHT_OK};
+        test_add(app, 0, &data);
+        if(i % 3 == 0) {
+            data = (DHT_data){.temp = -400 + i, .hum = 1000 - i, .status = DHT_OK};
+            if(i % 27 == 0) data.status = DHT_NO_RESPONSE;
+            if(i % 45 == 0) data.status = DHT_CHECKSUM_ERROR;
+            test_add(app, 1, &data);
+        }
+    }
+}
+
+/**
+ * @brief Сверка строк CSV с записанными
+ * @details Блоки датчиков в файле перемежаются, но внутри датчика записи идут по порядку
+ *
+ * @param skip Сколько первых записей первого датчика потеряно
+ * @return Количество строк без заголовка
+ */
+static uint32_t test_checkCsv(char* text, uint16_t skip) {
+    uint16_t next[SENSORS] = {skip, 0};
+    uint32_t lines = 0;
+    char* line = strtok(text, "\n");
+    CHECK_STR(line, "timestamp;sensor;temp;hum;status");
+    for(line = strtok(NULL, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+        lines++;
+        bool found = false;
+        for(uint8_t s = 0; s < SENSORS && !found; s++) {
+            if(next[s] < expectedCount[s] && strcmp(line, expected[s][next[s]]) == 0) {
+                next[s]++;
+                found = true;
+            }
+        }
+        if(!found && lines < 5) fprintf(stderr, "unexpected line: %s\n", line);
+        CHECK(found);
+    }
+    CHECK_EQ(next[0], expectedCount[0]);
+    CHECK_EQ(next[1], expectedCount[1]);
+    return lines;
+}
+
+static void test_export(void) {
+    //Экспорт в каталоге модели выгружает накопленное и сохраняет CSV рядом с журналом
+    fakeApp_exportLog(NULL, NULL);
+    fakeStorage_hostPath(DHTMON_LOG_PATH, logPath, sizeof(logPath));
+    fakeStorage_hostPath(DHTMON_LOG_CSV_PATH, csvPath, sizeof(csvPath));
+    long logLen = test_readFile(logPath, logData, sizeof(logData));
+    CHECK(logLen > 0);
+    CHECK(test_readFile(csvPath, csv, sizeof(csv)) > 0);
+    //Утилита преобразует произвольный файл в произвольный и получает то же
+    snprintf(copyPath, sizeof(copyPath), "%s.copy", csvPath);
+    fakeApp_exportLog(logPath, copyPath);
+    CHECK(test_readFile(copyPath, copy, sizeof(copy)) > 0);
+    CHECK_STR(copy, csv);
+    uint32_t lines = test_checkCsv(csv, 0);
+    CHECK_EQ(lines, expectedCount[0] + expectedCount[1]);
+    printf(
+        "logExport: %lu records in %ld bytes, %.2f bytes per record\n",
+        (unsigned long)lines,
+        logLen,
+        (double)logLen / (lines ? lines : 1));
+
+    //Испорченный байт записей первого блока: теряются только его записи.
+    //Первым закрывается блок первого датчика, он пишет чаще
+    uint8_t lost = logData[2];
+    CHECK_EQ((uint8_t)logData[0], DHTMON_LOG_MAGIC);
+    CHECK(memcmp(&logData[12], "Room", 4) == 0);
+    logData[20] ^= 0x55;
+    FILE* fp = fopen(logPath, "wb");
+    if(fp == NULL) abort();
+    fwrite(logData, 1, logLen, fp);
+    fclose(fp);
+    fakeApp_exportLog(logPath, copyPath);
+    CHECK(test_readFile(copyPath, copy, sizeof(copy)) > 0);
+    CHECK_EQ(test_checkCsv(copy, lost), lines - lost);
+}
+
+int main(void) {
+    fakeHal_reset(1);
+    PluginData* app = fakeApp_start(test_tempDir());
+    char path[512];
+    fakeStorage_hostPath(APP_FILEPATH, path, sizeof(path));
+    test_writeFile(path, "Room 1 2\nCellar 0 3\n");
+    CHECK(DHTMon_sensors_load());
+    CHECK_EQ(app->sensors_count, SENSORS);
+    if(app->sensors_count == SENSORS) {
+        test_writeLog(app);
+        test_export();
+    }
+    fakeApp_stop();
+    return test_result("test_logExport");
+}
@@ -0,0 +1,116 @@
+/* Производные величины в целых числах против тех же формул в double на всей сетке
+ * пригодных показаний: от -40 до 80 *C и от 0.1 до 100% через десятую долю */
+#include <math.h>
+#include "test.h"
+#include "fake_hal.h"
+#include "quenon_dht_mon.h"
+
+//Допустимое расхождение в десятых долях: округление результата и погрешность таблиц
+#define DEW_POINT_ERROR 1
+#define ABS_HUM_ERROR 1
+#define HEAT_INDEX_ERROR 1
+
+static const double magnusB = 17.62, magnusC = 243.12;
+
+/**
+ * @brief Индекс жары по методике NWS в *F
+ */
+static double test_heatIndexF(double f, double rh) {
+    double simple = 0.5 * (f + 61.0 + (f - 68.0) * 1.2 + rh * 0.094);
+    if((simple + f) / 2 < 80.0) return simple;
+    double hi = -42.379 + 2.04901523 * f + 10.14333127 * rh - 0.22475541 * f * rh -
+                0.00683783 * f * f - 0.05481717 * rh * rh + 0.00122874 * f * f * rh +
+                0.00085282 * f * rh * rh - 0.00000199 * f * f * rh * rh;
+    if(rh < 13.0 && f >= 80.0 && f <= 112.0) {
+        hi -= ((13.0 - rh) / 4.0) * sqrt((17.0 - fabs(f - 95.0)) / 17.0);
+    } else if(rh > 85.0 && f >= 80.0 && f <= 87.0) {
+        hi += ((rh - 85.0) / 10.0) * ((87.0 - f) / 5.0);
+    }
+    return hi;
+}
+
+typedef struct {
+    int32_t max; //Наибольшее расхождение, десятые доли
+    int16_t temp, hum; //Показания, на которых оно достигнуто
+    uint32_t over; //Показаний с расхождением больше допустимого
+} test_error;
+
+static void test_track(test_error* error, int32_t diff, int32_t bound, int16_t temp, int16_t hum) {
+    if(diff < 0) diff = -diff;
+    if(diff > error->max) {
+        error->max = diff;
+        error->temp = temp;
+        error->hum = hum;
+    }
+    if(diff > bound) error->over++;
+}
+
+static void test_print(const char* name, const test_error* error) {
+    printf(
+        "metrics: %s max error %ld tenths at %d/%d, %lu over bound\n",
+        name,
+        (long)error->max,
+        error->temp,
+        error->hum,
+        (unsigned long)error->over);
+}
+
+static void test_accuracy(void) {
+    test_error dew = {0}, ah = {0}, hi = {0};
+    uint32_t samples = 0;
+    for(int16_t temp = -400; temp <= 800; temp++) {
+        for(int16_t hum = 1; hum <= 1000; hum++) {
+            DHT_data data = {.temp = temp, .hum = hum, .status = DHT_OK};
+            DHTMon_metrics metrics = {0};
+            DHTMon_metrics_calc(&data, &metrics);
+            if(!metrics.valid) {
+                testFailures++;
+                continue;
+            }
+            samples++;
+            double t = temp / 10.0, rh = hum / 10.0;
+            double gamma = log(rh / 100.0) + magnusB * t / (magnusC + t);
+            double dewPoint = magnusC * gamma / (magnusB - gamma);
+            double absHum = 216.7 * 6.112 * exp(gamma) / (t + 273.15);
+            double heatIndex = (test_heatIndexF(t * 1.8 + 32.0, rh) - 32.0) / 1.8;
+            int32_t diff = metrics.dewPoint - lround(dewPoint * 10);
+            test_track(&dew, diff, DEW_POINT_ERROR, temp, hum);
+            diff = metrics.absHum - lround(absHum * 10);
+            test_track(&ah, diff, ABS_HUM_ERROR, temp, hum);
+            diff = metrics.heatIndex - lround(heatIndex * 10);
+            test_track(&hi, diff, HEAT_INDEX_ERROR, temp, hum);
+        }
+    }
+    printf("metrics: %lu readings compared\n", (unsigned long)samples);
+    test_print("dew point", &dew);
+    test_print("absolute humidity", &ah);
+    test_print("heat index", &hi);
+    CHECK_EQ(dew.over, 0);
+    CHECK_EQ(ah.over, 0);
+    CHECK_EQ(hi.over, 0);
+}
+
+static void test_invalid(void) {
+    //Непригодные показания сбрасывают только признак, прежние величины остаются
+    DHTMon_metrics metrics = {.dewPoint = 123, .valid = true};
+    DHT_data data = {.temp = 215, .hum = 0, .status = DHT_OK};
+    DHTMon_metrics_calc(&data, &metrics);
+    CHECK(!metrics.valid);
+    CHECK_EQ(metrics.dewPoint, 123);
+    data = (DHT_data){.temp = 215, .hum = 450, .status = DHT_NO_RESPONSE};
+    DHTMon_metrics_calc(&data, &metrics);
+    CHECK(!metrics.valid);
+    //Известная точка: 20 *C и 50% - точка росы 9.3 *C, 8.6 г/м3
+    data = (DHT_data){.temp = 200, .hum = 500, .status = DHT_OK};
+    DHTMon_metrics_calc(&data, &metrics);
+    CHECK(metrics.valid);
+    CHECK_EQ(metrics.dewPoint, 93);
+    CHECK_EQ(metrics.absHum, 86);
+}
+
+int main(void) {
+    fakeHal_reset(1);
+    test_accuracy();
+    test_invalid();
+    return test_result("test_metrics");
+}
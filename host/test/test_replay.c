@@ -0,0 +1,175 @@
+/* Воспроизведение эталонных ответов: встроенный набор проходит целиком, а те же
+ * осциллограммы, проигранные датчиком модели, принимаются DHT_getData так же,
+ * как их разбирает DHT_decodeWave без линии */
+#include "test.h"
+#include "fake_hal.h"
+#include "quenon_dht_mon.h"
+#include "../bench/bench.h"
+
+#define RUNS 20
+
+//Осциллограмма: импульсы нуля, единицы и низкого уровня, сколько бит до обрыва
+typedef struct {
+    const char* name;
+    uint8_t type;
+    uint8_t rawData[5];
+    uint8_t zero, one, low, bits;
+} test_trace;
+
+static const test_trace traces[] = {
+    {"DHT22 nominal", DHT22, {0x02, 0x8C, 0x01, 0x5F, 0xEE}, 26, 70, 50, 40},
+    {"DHT22 long cable", DHT22, {0x01, 0xF4, 0x80, 0x65, 0xDA}, 40, 56, 62, 40},
+    {"ASAIR negative", DHT11, {0x23, 0x00, 0x0C, 0x83, 0xB2}, 27, 71, 54, 40},
+    {"Zero over threshold", DHT22, {0x02, 0x8C, 0x01, 0x5F, 0xEE}, 50, 70, 50, 40},
+    {"Broken at bit 20", DHT22, {0x02, 0x8C, 0x01, 0x5F, 0xEE}, 26, 70, 50, 20},
+    {"No response", DHT22, {0}, 0, 0, 0, 0},
+};
+
+static void test_corpus(void) {
+    DHTMon_replayResult result;
+    DHTMon_replay_run(&result);
+    CHECK_EQ(result.frames, 18);
+    CHECK_EQ(result.traces, 6);
+    CHECK_EQ(result.framesPassed, result.frames);
+    CHECK_EQ(result.tracesPassed, result.traces);
+    CHECK_STR(result.failed == NULL ? "" : result.failed, "");
+    //Воспроизведение не зависит от предыдущих прогонов
+    uint64_t start = bench_ns();
+    for(uint8_t i = 0; i < RUNS; i++) {
+        DHTMon_replayResult again;
+        DHTMon_replay_run(&again);
+        CHECK_EQ(again.framesPassed, result.framesPassed);
+        CHECK_EQ(again.tracesPassed, result.tracesPassed);
+    }
+    //Каждый ответ разбирается при сверке и DHTMON_REPLAY_ROUNDS раз при замере
+    uint64_t runNs = (bench_ns() - start) / RUNS;
+    uint32_t replayed = (result.frames + result.traces) * (DHTMON_REPLAY_ROUNDS + 1);
+    printf(
+        "replay: %u/%u frames, %u/%u traces, host %llu ns per response\n",
+        result.framesPassed,
+        result.frames,
+        result.tracesPassed,
+        result.traces,
+        (unsigned long long)(runNs / replayed));
+}
+
+/**
+ * @brief Запись ответа в том виде, в каком её пишет приём опросом линии
+ */
+static void test_buildWave(const test_trace* trace, DHT_waveform* wave) {
+    memset(wave, 0, sizeof(DHT_waveform));
+    wave->firstLevel = 0;
+    wave->width[wave->count++] = 5;
+    if(trace->bits == 0) {
+        wave->width[wave->count++] = DHT_WAVE_TIMEOUT;
+        return;
+    }
+    wave->width[wave->count++] = 30;
+    wave->width[wave->count++] = 80;
+    wave->width[wave->count++] = 80;
+    for(uint8_t bit = 0; bit < trace->bits; bit++) {
+        bool one = trace->rawData[bit / 8] & (1 << (7 - bit % 8));
+        wave->width[wave->count++] = trace->low;
+        wave->width[wave->count++] = one ? trace->one : trace->zero;
+    }
+    if(trace->bits < 40) {
+        wave->width[wave->count++] = trace->low;
+        wave->width[wave->count++] = DHT_WAVE_TIMEOUT;
+    }
+}
+
+static void test_liveReplay(void) {
+    FakeSensorTiming timing = fakeSensor_defaultTiming(DHT22);
+    fakeSensor_attach(&gpio_ext_pa7, &timing);
+    static DHT_waveform trace, captured;
+    for(uint8_t i = 0; i < sizeof(traces) / sizeof(traces[0]); i++) {
+        //Разбор записи без линии
+        test_buildWave(&traces[i], &trace);
+        uint8_t rawData[5] = {0};
+        DHT_timing pulses = {.zeroMin = 255, .oneMin = 255};
+        DHT_response response = DHT_decodeWave(&trace, rawData, &pulses);
+        DHT_data expected = {.status = DHT_NO_RESPONSE};
+        if(response == DHT_RESPONSE_OK) DHT_convert(traces[i].type, rawData, &expected);
+
+        //Та же запись, проигранная на линии
+        DHT_sensor sensor = {.GPIO = &gpio_ext_pa7, .type = traces[i].type};
+        strcpy(sensor.name, "Replay");
+        DHT_initLine(&sensor, 0);
+        DHT_resetState(&sensor);
+        furi_hal_gpio_write(sensor.GPIO, true);
+        furi_hal_gpio_init(
+            sensor.GPIO, GpioModeOutputOpenDrain, GpioPullUp, GpioSpeedVeryHigh);
+        fakeSensor_setWave(&gpio_ext_pa7, &trace);
+        memset(&captured, 0, sizeof(captured));
+        sensor.wave = &captured;
+        DHT_data data = DHT_getData(&sensor);
+
+        bool same = captured.response == response;
+        if(response == DHT_RESPONSE_OK) {
+            same &= memcmp(captured.rawData, rawData, 5) == 0 && data.status == expected.status;
+            if(expected.status == DHT_OK) {
+                same &= data.temp == expected.temp && data.hum == expected.hum;
+            }
+        } else {
+            same &= data.status != DHT_OK;
+        }
+        if(!same) {
+            fprintf(
+                stderr,
+                "%s: live response %u status %u, replayed %u status %u\n",
+                traces[i].name,
+                captured.response,
+                data.status,
+                response,
+                expected.status);
+            testFailures++;
+        }
+    }
+    fakeSensor_setWave(&gpio_ext_pa7, NULL);
+    fakeSensor_detach(&gpio_ext_pa7);
+}
+
+static void test_recordedReplay(void) {
+    //Ответ с разбросом длительностей, записанный при опросе, проигрывается снова
+    FakeSensorTiming timing = fakeSensor_defaultTiming(DHT22);
+    timing.jitter = 3;
+    fakeSensor_attach(&gpio_ext_pa7, &timing);
+    uint8_t rawData[5];
+    fakeSensor_encode(DHT22, -101, 500, rawData);
+    fakeSensor_setFrame(&gpio_ext_pa7, rawData);
+    DHT_sensor sensor = {.name = "Replay", .GPIO = &gpio_ext_pa7, .type = DHT22};
+    DHT_initLine(&sensor, 0);
+    DHT_resetState(&sensor);
+    furi_hal_gpio_write(sensor.GPIO, true);
+    furi_hal_gpio_init(sensor.GPIO, GpioModeOutputOpenDrain, GpioPullUp, GpioSpeedVeryHigh);
+    static DHT_waveform recorded, replayed;
+    sensor.wave = &recorded;
+    DHT_data data = DHT_getData(&sensor);
+    CHECK_EQ(data.status, DHT_OK);
+
+    fakeSensor_setWave(&gpio_ext_pa7, &recorded);
+    sensor.lastPollingTime = 0;
+    sensor.wave = &replayed;
+    DHT_data again = DHT_getData(&sensor);
+    CHECK_EQ(again.status, DHT_OK);
+    CHECK_EQ(again.temp, data.temp);
+    CHECK_EQ(again.hum, data.hum);
+    //Длительности повторяются с точностью до прохода цикла опроса
+    CHECK_EQ(replayed.count, recorded.count);
+    uint8_t worst = 0;
+    for(uint8_t i = 0; i < recorded.count && i < replayed.count; i++) {
+        uint8_t diff = abs((int)replayed.width[i] - recorded.width[i]);
+        if(diff > worst) worst = diff;
+    }
+    CHECK(worst <= 1);
+    fakeSensor_setWave(&gpio_ext_pa7, NULL);
+    fakeSensor_detach(&gpio_ext_pa7);
+}
+
+int main(void) {
+    fakeHal_reset(1);
+    test_corpus();
+    test_liveReplay();
+    test_recordedReplay();
+    return test_result("test_replay");
+}
@@ -0,0 +1,93 @@
+/* Редактор датчика: значения из файла, которых нет в меню, не округляются при сохранении */
+#include "test.h"
+#include "fake_hal.h"
+#include "fake_app.h"
+#include "fake_gui.h"
+#include "fake_storage.h"
+
+//Пункты редактора по порядку
+enum {
+    ITEM_NAME,
+    ITEM_TYPE,
+    ITEM_GPIO,
+    ITEM_INTERVAL,
+    ITEM_TEMP_LOW,
+    ITEM_TEMP_HIGH,
+    ITEM_HUM_LOW,
+    ITEM_HUM_HIGH,
+    ITEM_SAVE,
+};
+
+static VariableItemList* test_openEditor(PluginData* app, uint16_t index) {
+    app->currentSensorEdit = &app->sensors[index];
+    sensorEdit_scene(app);
+    return fakeGui_viewItemList(fakeGui_dispatcherView(app->view_dispatcher, ADDSENSOR_MENU_VIEW));
+}
+
+static void test_menuValues(PluginData* app) {
+    //Значения из меню редактируются как раньше, лишних вариантов нет
+    VariableItemList* list = test_openEditor(app, 0);
+    CHECK(list != NULL);
+    if(list == NULL) return;
+    CHECK_EQ(fakeGui_itemCount(list), ITEM_SAVE + 1);
+    VariableItem* interval = fakeGui_item(list, ITEM_INTERVAL);
+    CHECK_EQ(fakeGui_itemValues(interval), 7);
+    CHECK_STR(fakeGui_itemText(interval), "1 min");
+    VariableItem* tempLow = fakeGui_item(list, ITEM_TEMP_LOW);
+    CHECK_EQ(fakeGui_itemValues(tempLow), 122);
+    CHECK_STR(fakeGui_itemText(tempLow), "10*C");
+    CHECK_STR(fakeGui_itemText(fakeGui_item(list, ITEM_HUM_LOW)), "Off");
+}
+
+static void test_customValues(PluginData* app) {
+    VariableItemList* list = test_openEditor(app, 1);
+    if(list == NULL) return;
+    //Интервал и пороги вне вариантов меню показываются последним вариантом как есть
+    VariableItem* interval = fakeGui_item(list, ITEM_INTERVAL);
+    CHECK_EQ(fakeGui_itemValues(interval), 8);
+    CHECK_STR(fakeGui_itemText(interval), "45 s");
+    VariableItem* tempLow = fakeGui_item(list, ITEM_TEMP_LOW);
+    CHECK_EQ(fakeGui_itemValues(tempLow), 123);
+    CHECK_STR(fakeGui_itemText(tempLow), "-50.0*C");
+    VariableItem* humHigh = fakeGui_item(list, ITEM_HUM_HIGH);
+    CHECK_EQ(fakeGui_itemValues(humHigh), 103);
+    CHECK_STR(fakeGui_itemText(humHigh), "150.0%");
+    //Порог в пределах меню остаётся обычным вариантом
+    CHECK_EQ(fakeGui_itemValues(fakeGui_item(list, ITEM_TEMP_HIGH)), 122);
+    CHECK_STR(fakeGui_itemText(fakeGui_item(list, ITEM_TEMP_HIGH)), "30*C");
+
+    //Уход с особого варианта и возврат к нему восстанавливают значение из файла
+    fakeGui_itemSelect(interval, 1);
+    CHECK_EQ(app->sensorEdit.pollingInterval, 5000);
+    fakeGui_itemSelect(interval, 7);
+    CHECK_STR(fakeGui_itemText(interval), "45 s");
+    fakeGui_itemSelect(tempLow, 0);
+    CHECK(!(app->sensorEdit.thresholds.enabled & (1 << DHT_ALARM_TEMP_LOW)));
+    fakeGui_itemSelect(tempLow, 122);
+    CHECK_STR(fakeGui_itemText(tempLow), "-50.0*C");
+
+    //Сохранение без изменений не трогает значения
+    fakeGui_itemEnter(list, ITEM_SAVE);
+    const DHT_sensor* sensor = &app->sensors[1];
+    CHECK_EQ(sensor->pollingInterval, 45000);
+    CHECK_EQ(sensor->thresholds.enabled, 0x0B);
+    CHECK_EQ(sensor->thresholds.limit[DHT_ALARM_TEMP_LOW], -500);
+    CHECK_EQ(sensor->thresholds.limit[DHT_ALARM_TEMP_HIGH], 300);
+    CHECK_EQ(sensor->thresholds.limit[DHT_ALARM_HUM_HIGH], 1500);
+}
+
+int main(void) {
+    fakeHal_reset(1);
+    PluginData* app = fakeApp_start(test_tempDir());
+    char path[512];
+    fakeStorage_hostPath(APP_FILEPATH, path, sizeof(path));
+    test_writeFile(path, "Room 1 2 60 10 30 - 70\nOdd 1 3 45 -50 30 - 150\n");
+    CHECK(DHTMon_sensors_load());
+    CHECK_EQ(app->sensors_count, 2);
+    if(app->sensors_count == 2) {
+        test_menuValues(app);
+        test_customValues(app);
+    }
+    fakeApp_stop();
+    return test_result("test_sensorEdit");
+}
@@ -0,0 +1,145 @@
+/* Список датчиков: таблица портов, проверка параметров, загрузка и сохранение файла датчиков */
+#include "test.h"
+#include "fake_hal.h"
+#include "fake_app.h"
+#include "fake_storage.h"
+
+static char path[512];
+
+static const char* test_hostPath(const char* appPath) {
+    fakeStorage_hostPath(appPath, path, sizeof(path));
+    return path;
+}
+
+static void test_gpioMapping(void) {
+    //Номера на корпусе и порядковые номера портов переводятся туда и обратно
+    CHECK_EQ(DHTMon_GPIO_to_int(&gpio_ext_pa7), 2);
+    CHECK_EQ(DHTMon_GPIO_to_int(&ibutton_gpio), 17);
+    CHECK(DHTMon_GPIO_form_int(16) == &gpio_ext_pc0);
+    CHECK(DHTMon_GPIO_form_int(8) == NULL);
+    CHECK_EQ(DHTMon_GPIO_to_int(NULL), 255);
+    for(uint8_t i = 0; i < 13; i++) {
+        const GpioPin* gpio = DHTMon_GPIO_from_index(i);
+        CHECK(gpio != NULL);
+        CHECK_EQ(DHTMon_GPIO_to_index(gpio), i);
+        CHECK(DHTMon_GPIO_form_int(DHTMon_GPIO_to_int(gpio)) == gpio);
+        CHECK(DHTMon_GPIO_getName(gpio) != NULL);
+    }
+    CHECK_STR(DHTMon_GPIO_getName(&gpio_ext_pb3), "5 (B3)");
+    //Пин с тем же номером и портом считается тем же портом
+    const GpioPin copy = {.port = GPIOA, .pin = LL_GPIO_PIN_6};
+    CHECK_EQ(DHTMon_GPIO_to_int(&copy), 3);
+}
+
+static void test_sensorCheck(void) {
+    DHT_sensor sensor = {.name = "Room", .GPIO = &gpio_ext_pa7, .type = DHT22};
+    DHT_initLine(&sensor, DHTMon_GPIO_to_index(sensor.GPIO));
+    CHECK(DHTMon_sensor_check(&sensor));
+    strcpy(sensor.name, "_x");
+    CHECK(DHTMon_sensor_check(&sensor));
+    strcpy(sensor.name, "");
+    CHECK(!DHTMon_sensor_check(&sensor));
+    strcpy(sensor.name, "-bad");
+    CHECK(!DHTMon_sensor_check(&sensor));
+    strcpy(sensor.name, "Room");
+    sensor.type = DHT_TYPES_COUNT;
+    CHECK(!DHTMon_sensor_check(&sensor));
+    sensor.type = AM2320;
+    sensor.GPIO = NULL;
+    DHT_initLine(&sensor, 255);
+    CHECK(!DHTMon_sensor_check(&sensor));
+}
+
+static void test_checkSensor(
+    const DHT_sensor* sensor,
+    const char* name,
+    DHT_type type,
+    uint8_t gpio,
+    uint32_t interval,
+    uint8_t enabled) {
+    CHECK_STR(sensor->name, name);
+    CHECK_EQ(sensor->type, type);
+    CHECK_EQ(DHTMon_GPIO_to_int(sensor->GPIO), gpio);
+    CHECK_EQ(sensor->pollingInterval, interval);
+    CHECK_EQ(sensor->thresholds.enabled, enabled);
+    //Описатель линии заполнен, драйвер может сразу опрашивать датчик
+    CHECK(sensor->line.idr == &sensor->GPIO->port->IDR);
+    CHECK_EQ(sensor->line.setMask, sensor->GPIO->pin);
+}
+
+static void test_checkLoaded(PluginData* app) {
+    CHECK_EQ(app->sensors_count, 4);
+    if(app->sensors_count != 4) return;
+    test_checkSensor(&app->sensors[0], "Room", DHT22, 2, 60000, 0x0B);
+    CHECK_EQ(app->sensors[0].thresholds.limit[DHT_ALARM_TEMP_LOW], 100);
+    CHECK_EQ(app->sensors[0].thresholds.limit[DHT_ALARM_TEMP_HIGH], 300);
+    CHECK_EQ(app->sensors[0].thresholds.limit[DHT_ALARM_HUM_HIGH], 700);
+    test_checkSensor(&app->sensors[1], "Cellar", DHT11, 17, 0, 0);
+    test_checkSensor(&app->sensors[2], "Freezer", AM2301, 3, 5000, 0x03);
+    CHECK_EQ(app->sensors[2].thresholds.limit[DHT_ALARM_TEMP_LOW], -300);
+    CHECK_EQ(app->sensors[2].thresholds.limit[DHT_ALARM_TEMP_HIGH], -100);
+    test_checkSensor(&app->sensors[3], "Last", AM2320, 16, 0, 0);
+}
+
+static void test_load(PluginData* app) {
+    //Комментарии, лишние пробелы и неверные строки пропускаются, последняя строка без перевода строки
+    test_writeFile(
+        test_hostPath(APP_FILEPATH),
+        "#DHT monitor sensors file\n"
+        "Room 1 2 60 10 30 - 70\n"
+        "Cellar 0 17\n"
+        "\tFreezer  2 3 5 -30 -10\r\n"
+        "TooLongName1 1 4\n"
+        "BadGpio 1 8\n"
+        "BadType 9 4\n"
+        "Letters 1 x\n"
+        "Last 3 16 0 - - - -");
+    CHECK(DHTMon_sensors_load());
+    test_checkLoaded(app);
+    //Загруженные датчики запитаны, линии подняты
+    CHECK(fakeHal_isOtgEnabled());
+    CHECK(furi_hal_gpio_read(&gpio_ext_pa7));
+}
+
+static void test_saveReload(PluginData* app) {
+    CHECK_EQ(DHTMon_sensors_save(), 4);
+    char text[2048];
+    CHECK(test_readFile(test_hostPath(APP_FILEPATH), text, sizeof(text)) > 0);
+    CHECK(strstr(text, "Room 1 2 60 10 30 - 70\n") != NULL);
+    CHECK(strstr(text, "Freezer 2 3 5 -30 -10 - -\n") != NULL);
+    CHECK(!storage_file_exists(app->storage, APP_FILEPATH_TMP));
+    CHECK(DHTMon_sensors_load());
+    test_checkLoaded(app);
+}
+
+static void test_restoreTemporary(PluginData* app) {
+    //Сбой между удалением файла и переименованием временной копии
+    storage_common_rename(app->storage, APP_FILEPATH, APP_FILEPATH_TMP);
+    CHECK(DHTMon_sensors_load());
+    test_checkLoaded(app);
+    CHECK(storage_file_exists(app->storage, APP_FILEPATH));
+    CHECK(!storage_file_exists(app->storage, APP_FILEPATH_TMP));
+}
+
+static void test_missingFile(PluginData* app) {
+    storage_common_remove(app->storage, APP_FILEPATH);
+    CHECK(!DHTMon_sensors_load());
+    CHECK_EQ(app->sensors_count, 0);
+    //Вместо отсутствующего файла создаётся болванка с описанием формата
+    char text[2048];
+    CHECK(test_readFile(test_hostPath(APP_FILEPATH), text, sizeof(text)) > 0);
+    CHECK(strstr(text, "DHT22 - 1") != NULL);
+}
+
+int main(void) {
+    fakeHal_reset(1);
+    PluginData* app = fakeApp_start(test_tempDir());
+    test_gpioMapping();
+    test_sensorCheck();
+    test_load(app);
+    test_saveReload(app);
+    test_restoreTemporary(app);
+    test_missingFile(app);
+    fakeApp_stop();
+    return test_result("test_sensors");
+}
@@ -0,0 +1,108 @@
+/* Граница нуля и единицы: импульсы до DHT_BIT_THRESHOLD включительно - нули, длиннее - единицы.
+ * Проверяется по синтетическим осциллограммам и через модель линии с замером по DWT.
+ * Осциллограммы составлены по даташиту, а не сняты с датчиков */
+#include "test.h"
+#include "fake_hal.h"
+
+static const uint8_t frame[5] = {0x02, 0x8C, 0x01, 0x5F, 0xEE};
+//Тот же ответ, в котором все нули приняты единицами
+static const uint8_t allOnes[5] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+/**
+ * @brief Осциллограмма ответа в том виде, в каком её пишет приём опросом линии
+ */
+static void test_buildWave(DHT_waveform* wave, uint8_t zero, uint8_t one) {
+    memset(wave, 0, sizeof(DHT_waveform));
+    wave->firstLevel = 0;
+    wave->width[wave->count++] = 2;
+    wave->width[wave->count++] = 30;
+    wave->width[wave->count++] = 80;
+    wave->width[wave->count++] = 80;
+    for(uint8_t bit = 0; bit < 40; bit++) {
+        wave->width[wave->count++] = 50;
+        wave->width[wave->count++] = frame[bit / 8] & (1 << (7 - bit % 8)) ? one : zero;
+    }
+}
+
+static void test_waveThreshold(void) {
+    DHT_waveform wave;
+    for(uint8_t zero = 20; zero <= 60; zero++) {
+        test_buildWave(&wave, zero, 70);
+        uint8_t rawData[5] = {0};
+        DHT_timing timing = {.zeroMin = 255, .oneMin = 255};
+        CHECK_EQ(DHT_decodeWave(&wave, rawData, &timing), DHT_RESPONSE_OK);
+        CHECK(memcmp(rawData, zero <= DHT_BIT_THRESHOLD ? frame : allOnes, 5) == 0);
+    }
+    //Укороченные единицы остаются единицами до самой границы
+    for(uint8_t one = DHT_BIT_THRESHOLD + 1; one <= 80; one++) {
+        test_buildWave(&wave, 26, one);
+        uint8_t rawData[5] = {0};
+        DHT_timing timing = {.zeroMin = 255, .oneMin = 255};
+        DHT_decodeWave(&wave, rawData, &timing);
+        CHECK(memcmp(rawData, frame, 5) == 0);
+        CHECK_EQ(timing.oneMin, one);
+        CHECK_EQ(timing.zeroMax, 26);
+    }
+}
+
+/**
+ * @brief Опрос датчика через модель линии
+ *
+ * @param zero Импульс нуля, мкс
+ * @param rawData Принятые байты
+ * @return Результат приёма
+ */
+static uint8_t test_linePoll(DHT_sensor* sensor, uint8_t zero, uint8_t rawData[5]) {
+    static DHT_waveform wave;
+    FakeSensorTiming timing = fakeSensor_defaultTiming(DHT22);
+    timing.zero = zero;
+    fakeSensor_setTiming(sensor->GPIO, &timing);
+    memset(&wave, 0, sizeof(wave));
+    sensor->wave = &wave;
+    sensor->lastPollingTime = 0;
+    DHT_getData(sensor);
+    memcpy(rawData, wave.rawData, 5);
+    return wave.response;
+}
+
+static void test_lineThreshold(uint32_t loopCycles) {
+    fakeHal_setLoopCycles(loopCycles);
+    FakeSensorTiming timing = fakeSensor_defaultTiming(DHT22);
+    fakeSensor_attach(&gpio_ext_pa7, &timing);
+    fakeSensor_setFrame(&gpio_ext_pa7, frame);
+    DHT_sensor sensor = {.name = "Edge", .GPIO = &gpio_ext_pa7, .type = DHT22};
+    DHT_initLine(&sensor, 0);
+    DHT_resetState(&sensor);
+    furi_hal_gpio_write(sensor.GPIO, true);
+    furi_hal_gpio_init(sensor.GPIO, GpioModeOutputOpenDrain, GpioPullUp, GpioSpeedVeryHigh);
+
+    //Спад замечается на следующем проходе цикла, поэтому замер короче импульса
+    //не больше чем на проход: у самой границы допустимы оба решения
+    uint8_t loopUs = (loopCycles + FAKE_HAL_CPU_MHZ - 1) / FAKE_HAL_CPU_MHZ;
+    uint8_t rawData[5];
+    for(uint8_t zero = 26; zero <= 52; zero++) {
+        CHECK_EQ(test_linePoll(&sensor, zero, rawData), DHT_RESPONSE_OK);
+        const uint8_t* expected = NULL;
+        if(zero <= DHT_BIT_THRESHOLD) expected = frame;
+        if(zero > DHT_BIT_THRESHOLD + loopUs) expected = allOnes;
+        if(expected != NULL && memcmp(rawData, expected, 5) != 0) {
+            fprintf(stderr, "loop %u cycles: zero of %u us misread\n", loopCycles, zero);
+            testFailures++;
+        }
+    }
+    //Даташит: ноль до 28 мкс. У границы 48 мкс запас 20 мкс на затянутые фронты длинного кабеля
+    test_linePoll(&sensor, 28, rawData);
+    CHECK(memcmp(rawData, frame, 5) == 0);
+    CHECK(sensor.timing.zeroMax >= 28 - loopUs && sensor.timing.zeroMax <= 28);
+    fakeSensor_detach(&gpio_ext_pa7);
+    fakeHal_setLoopCycles(8);
+}
+
+int main(void) {
+    fakeHal_reset(1);
+    test_waveThreshold();
+    //Быстрый цикл опроса и цикл в микросекунду
+    test_lineThreshold(8);
+    test_lineThreshold(FAKE_HAL_CPU_MHZ);
+    return test_result("test_threshold");
+}
@@ -0,0 +1,119 @@
+/* Разбор записи ответа: подтверждение датчика находится при любом начале записи,
+ * сохранённая на карту запись читается утилитой в те же уровни */
+#include "test.h"
+#include "fake_hal.h"
+#include "fake_app.h"
+#include "fake_storage.h"
+#include "../tools/wave_csv.h"
+
+static const uint8_t frame[5] = {0x02, 0x8C, 0x01, 0x5F, 0xEE};
+
+/**
+ * @brief Запись ответа
+ *
+ * @param wave Запись
+ * @param lead Уровни перед подтверждением: 2 - приём опросом (подъём линии и ожидание),
+ * 1 - приём по прерываниям (ожидание), 0 - прерывания пропустили подъём линии
+ * и записали его нулевой длины
+ * @param bits Сколько бит передано
+ */
+static void test_buildWave(DHT_waveform* wave, uint8_t lead, uint8_t bits) {
+    memset(wave, 0, sizeof(DHT_waveform));
+    wave->firstLevel = lead == 2 ? 0 : 1;
+    if(lead == 2) wave->width[wave->count++] = 5;
+    wave->width[wave->count++] = lead >= 1 ? 30 : 0;
+    wave->width[wave->count++] = 82;
+    wave->width[wave->count++] = 78;
+    for(uint8_t bit = 0; bit < bits; bit++) {
+        bool one = frame[bit / 8] & (1 << (7 - bit % 8));
+        wave->width[wave->count++] = 50 + bit % 3;
+        wave->width[wave->count++] = one ? 70 : 26;
+    }
+    if(bits < 40) {
+        wave->width[wave->count++] = 50;
+        wave->width[wave->count++] = DHT_WAVE_TIMEOUT;
+    }
+}
+
+static void test_layouts(void) {
+    DHT_waveform wave;
+    DHTMon_waveReport report;
+    for(uint8_t lead = 0; lead <= 2; lead++) {
+        for(uint8_t bits = 20; bits <= 40; bits += 20) {
+            test_buildWave(&wave, lead, bits);
+            DHTMon_wave_analyze(&wave, &report);
+            CHECK_EQ(report.ackLow, 82);
+            CHECK_EQ(report.ackHigh, 78);
+            CHECK_EQ(report.bits, bits);
+            CHECK_EQ(report.zeroMax, 26);
+            CHECK_EQ(report.oneMin, 70);
+            CHECK_EQ(report.lowMin, 50);
+            CHECK_EQ(report.lowMax, 52);
+            CHECK_EQ(report.zeroMargin, DHT_BIT_THRESHOLD - 26);
+            CHECK_EQ(report.oneMargin, 70 - DHT_BIT_THRESHOLD);
+        }
+    }
+}
+
+static void test_absent(void) {
+    //Линия поднялась, датчик так и не ответил
+    DHT_waveform wave = {.firstLevel = 0, .count = 2, .width = {5, DHT_WAVE_TIMEOUT}};
+    DHTMon_waveReport report;
+    DHTMon_wave_analyze(&wave, &report);
+    CHECK_EQ(report.ackLow, 0);
+    CHECK_EQ(report.ackHigh, 0);
+    CHECK_EQ(report.bits, 0);
+}
+
+static void test_saveRead(void) {
+    //Запись, заказанная с экрана диагностики, при опросе через модель линии
+    PluginData* app = fakeApp_start(test_tempDir());
+    FakeSensorTiming timing = fakeSensor_defaultTiming(DHT22);
+    timing.jitter = 3;
+    fakeSensor_attach(&gpio_ext_pa7, &timing);
+    fakeSensor_setFrame(&gpio_ext_pa7, frame);
+    DHT_sensor sensor = {.name = "Wave", .GPIO = &gpio_ext_pa7, .type = DHT22};
+    DHT_initLine(&sensor, 0);
+    DHT_resetState(&sensor);
+    furi_hal_gpio_write(sensor.GPIO, true);
+    furi_hal_gpio_init(sensor.GPIO, GpioModeOutputOpenDrain, GpioPullUp, GpioSpeedVeryHigh);
+    CHECK(DHTMon_wave_arm(&sensor, 1, &sensor));
+    const DHT_waveform* captured = sensor.wave;
+    DHT_getData(&sensor);
+    CHECK(DHTMon_wave_collect());
+    DHTMon_wave_save(app->storage);
+    CHECK_EQ(DHTMon_wave_state(), DHTMON_WAVE_SAVED);
+
+    char path[512];
+    fakeStorage_hostPath(DHTMON_WAVE_PATH, path, sizeof(path));
+    DHT_waveform wave;
+    CHECK(waveCsv_read(path, &wave));
+    CHECK_EQ(wave.count, captured->count);
+    CHECK_EQ(wave.firstLevel, captured->firstLevel);
+    CHECK(memcmp(wave.width, captured->width, captured->count) == 0);
+    //Разбор прочитанной записи совпадает с разбором на приборе
+    DHTMon_waveReport report, saved;
+    DHTMon_wave_analyze(&wave, &report);
+    CHECK(DHTMon_wave_report(&saved));
+    CHECK(memcmp(&report, &saved, sizeof(report)) == 0);
+    uint8_t rawData[5] = {0};
+    DHT_timing pulses = {.zeroMin = 255, .oneMin = 255};
+    CHECK_EQ(DHT_decodeWave(&wave, rawData, &pulses), DHT_RESPONSE_OK);
+    CHECK(memcmp(rawData, frame, 5) == 0);
+
+    //Уровни, которые не чередуются, и время, не сходящееся с длительностями
+    test_writeFile(path, "#DHT monitor waveform\ntime_us;level;width_us\n0;0;5\n5;0;30\n");
+    CHECK(!waveCsv_read(path, &wave));
+    test_writeFile(path, "time_us;level;width_us\n0;0;5\n6;1;30\n");
+    CHECK(!waveCsv_read(path, &wave));
+    fakeSensor_detach(&gpio_ext_pa7);
+    fakeApp_stop();
+}
+
+int main(void) {
+    fakeHal_reset(1);
+    test_layouts();
+    test_absent();
+    test_saveRead();
+    return test_result("test_wave");
+}
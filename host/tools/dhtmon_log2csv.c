@@ -0,0 +1,54 @@
+/* Преобразование журнала log.bin, снятого с SD-карты, в CSV на компьютере.
+ * Преобразует тот же код, что и команда меню, поэтому CSV совпадает с полученным на Flipper Zero
+ * dhtmon_log2csv log.bin [log.csv] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fake_hal.h"
+#include "fake_app.h"
+
+int main(int argc, char** argv) {
+    if(argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s log.bin [log.csv]\n", argv[0]);
+        return 2;
+    }
+    const char* logPath = argv[1];
+    char csvPath[512];
+    if(argc == 3) {
+        snprintf(csvPath, sizeof(csvPath), "%s", argv[2]);
+    } else {
+        //По умолчанию рядом с журналом с расширением .csv
+        snprintf(csvPath, sizeof(csvPath), "%s", logPath);
+        char* ext = strrchr(csvPath, '.');
+        if(ext == NULL || strchr(ext, '/') != NULL) ext = csvPath + strlen(csvPath);
+        snprintf(ext, sizeof(csvPath) - (ext - csvPath), ".csv");
+    }
+    FILE* fp = fopen(logPath, "rb");
+    if(fp == NULL) {
+        perror(logPath);
+        return 1;
+    }
+    fclose(fp);
+
+    fakeHal_reset(1);
+    char root[] = "/tmp/dhtmon_log2csv_XXXXXX";
+    if(mkdtemp(root) == NULL) return 1;
+    fakeApp_start(root);
+    fakeApp_exportLog(logPath, csvPath);
+    fakeApp_stop();
+
+    fp = fopen(csvPath, "rb");
+    if(fp == NULL) {
+        perror(csvPath);
+        return 1;
+    }
+    //Строки без заголовка
+    uint32_t records = 0;
+    int c;
+    while((c = fgetc(fp)) != EOF) {
+        if(c == '\n') records++;
+    }
+    fclose(fp);
+    printf("%s: %lu records\n", csvPath, (unsigned long)(records > 0 ? records - 1 : 0));
+    return 0;
+}
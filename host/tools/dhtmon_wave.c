@@ -0,0 +1,150 @@
+/* Разбор записи ответа wave.csv, снятой с SD-карты: уровни линии рисуются строками
+ * по одному биту, у каждого бита - запас до порога декодера. Разбор делают те же
+ * DHT_decodeWave и DHTMon_wave_analyze, что и на Flipper Zero
+ * dhtmon_wave wave.csv [мкс на символ] */
+#include <stdlib.h>
+#include "fake_hal.h"
+#include "wave_csv.h"
+
+#define RENDER_WIDTH 25 //Наибольшая ширина рисунка уровня, символов
+
+/**
+ * @brief Рисунок уровня линии: '_' - низкий уровень, '#' - высокий
+ *
+ * @param level Уровень
+ * @param width Длительность, мкс
+ * @param scale Мкс на символ
+ * @return Напечатано символов
+ */
+static uint8_t render_level(uint8_t level, uint8_t width, uint8_t scale) {
+    uint8_t len = MIN((width + scale - 1) / scale, RENDER_WIDTH);
+    for(uint8_t i = 0; i < len; i++) putchar(level ? '#' : '_');
+    //Уровень до таймаута не закончился
+    if(width == DHT_WAVE_TIMEOUT) len += printf("...");
+    return len;
+}
+
+/**
+ * @brief Выравнивание подписей после рисунка
+ */
+static void render_pad(uint8_t used) {
+    for(uint8_t i = used; i < 2 * RENDER_WIDTH + 6; i++) putchar(' ');
+}
+
+/**
+ * @brief Строка одного уровня с подписью
+ */
+static void render_row(const char* label, uint8_t level, uint8_t width, uint8_t scale) {
+    printf("%-7s ", label);
+    render_pad(render_level(level, width, scale));
+    printf("%3u us\n", width);
+}
+
+/**
+ * @brief Уровни до подтверждения датчика и само подтверждение, по строке на уровень
+ *
+ * @return Номер первого уровня после подтверждения
+ */
+static uint8_t render_lead(const DHT_waveform* wave, uint8_t scale) {
+    uint8_t i = 0;
+    for(; i < wave->count; i++) {
+        uint8_t level = (wave->firstLevel ^ i) & 1;
+        bool ack = i > 0 && level == 0 && ((wave->firstLevel ^ (i - 1)) & 1) == 1;
+        render_row(ack ? "ack" : "line", level, wave->width[i], scale);
+        if(ack) {
+            if(i + 1 < wave->count) render_row("", 1, wave->width[i + 1], scale);
+            return i + 2;
+        }
+    }
+    return i;
+}
+
+/**
+ * @brief Биты: низкий уровень и импульс бита в строку, решение декодера и запас до порога
+ */
+static void render_bits(const DHT_waveform* wave, uint8_t first, uint8_t scale) {
+    uint8_t bit = 0;
+    int16_t worstMargin = INT16_MAX;
+    uint8_t worstBit = 0;
+    uint8_t i = first;
+    for(; i + 1 < wave->count && bit < 40; i += 2, bit++) {
+        uint8_t low = wave->width[i], high = wave->width[i + 1];
+        printf("bit %-3u ", bit);
+        uint8_t len = render_level(0, low, scale);
+        render_pad(len + render_level(1, high, scale));
+        if(low == DHT_WAVE_TIMEOUT || high == DHT_WAVE_TIMEOUT) {
+            printf("%3u/%3u us  timeout\n", low, high);
+            return;
+        }
+        bool one = high > DHT_BIT_THRESHOLD;
+        int16_t margin = one ? high - DHT_BIT_THRESHOLD : DHT_BIT_THRESHOLD - high;
+        printf("%3u/%3u us  %u  margin %2d us\n", low, high, one, margin);
+        if(margin < worstMargin) {
+            worstMargin = margin;
+            worstBit = bit;
+        }
+    }
+    //Ответ оборвался на низком уровне бита
+    if(i < wave->count && bit < 40) {
+        char label[8];
+        snprintf(label, sizeof(label), "bit %u", bit);
+        render_row(label, 0, wave->width[i], scale);
+    }
+    if(worstMargin != INT16_MAX) printf("Worst bit: %u, margin %d us\n", worstBit, worstMargin);
+}
+
+static void render_report(const DHT_waveform* wave) {
+    DHTMon_waveReport report;
+    DHTMon_wave_analyze(wave, &report);
+    uint8_t rawData[5] = {0};
+    DHT_timing timing = {.zeroMin = UINT8_MAX, .oneMin = UINT8_MAX};
+    DHT_response response = DHT_decodeWave(wave, rawData, &timing);
+    uint8_t sum = rawData[0] + rawData[1] + rawData[2] + rawData[3];
+    printf(
+        "Result: %s, data %02X %02X %02X %02X %02X%s\n",
+        response == DHT_RESPONSE_OK     ? "ok" :
+        response == DHT_RESPONSE_ABSENT ? "absent" :
+                                          "broken",
+        rawData[0],
+        rawData[1],
+        rawData[2],
+        rawData[3],
+        rawData[4],
+        response != DHT_RESPONSE_OK ? "" :
+        sum == rawData[4]           ? ", checksum ok" :
+                                      ", checksum bad");
+    printf("Bits: %u, ack %u/%u us\n", report.bits, report.ackLow, report.ackHigh);
+    printf(
+        "Zero: %u-%u us, margin %d us to %u us threshold\n",
+        report.zeroMax > 0 ? report.zeroMin : 0,
+        report.zeroMax,
+        report.zeroMargin,
+        DHT_BIT_THRESHOLD);
+    printf(
+        "One: %u-%u us, margin %d us\n",
+        report.oneMax > 0 ? report.oneMin : 0,
+        report.oneMax,
+        report.oneMargin);
+    printf("Bit low: %u-%u us\n", report.lowMax > 0 ? report.lowMin : 0, report.lowMax);
+    printf("Timeout margin: %d us to %u us\n", report.timeoutMargin, DHT_TIMEOUT_BIT);
+}
+
+int main(int argc, char** argv) {
+    if(argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s wave.csv [us per char]\n", argv[0]);
+        return 2;
+    }
+    long scale = argc == 3 ? strtol(argv[2], NULL, 10) : 4;
+    if(scale < 1 || scale > DHT_WAVE_TIMEOUT) scale = 4;
+    fakeHal_reset(1);
+    static DHT_waveform wave;
+    if(!waveCsv_read(argv[1], &wave)) {
+        fprintf(stderr, "%s: cannot read waveform\n", argv[1]);
+        return 1;
+    }
+    printf("%s: %u levels, %ld us per char\n", argv[1], wave.count, scale);
+    uint8_t first = render_lead(&wave, scale);
+    render_bits(&wave, first, scale);
+    render_report(&wave);
+    return 0;
+}
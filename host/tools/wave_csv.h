@@ -0,0 +1,39 @@
+#pragma once
+/* Чтение записи ответа из wave.csv, сохранённого экраном диагностики: строки отчёта
+ * начинаются с '#', дальше заголовок и уровни линии "time_us;level;width_us" */
+#include <stdio.h>
+#include <string.h>
+#include "quenon_dht_mon.h"
+
+/**
+ * @brief Чтение записи ответа
+ * @details Принятые байты и результат приёма не читаются: их даёт DHT_decodeWave
+ *
+ * @param path Файл на компьютере
+ * @param wave Запись ответа
+ * @return false Файла нет, уровни не чередуются, время не сходится с длительностями
+ * или записей больше DHT_EDGES_MAX
+ */
+static inline bool waveCsv_read(const char* path, DHT_waveform* wave) {
+    FILE* fp = fopen(path, "r");
+    if(fp == NULL) return false;
+    memset(wave, 0, sizeof(DHT_waveform));
+    char line[128];
+    bool valid = true;
+    unsigned long elapsed = 0;
+    while(valid && fgets(line, sizeof(line), fp) != NULL) {
+        if(line[0] == '#' || line[0] == '\n' || strncmp(line, "time_us", 7) == 0) continue;
+        unsigned long time;
+        unsigned level, width;
+        valid = sscanf(line, "%lu;%u;%u", &time, &level, &width) == 3 && level <= 1 &&
+                width <= DHT_WAVE_TIMEOUT && wave->count < DHT_EDGES_MAX;
+        if(!valid) break;
+        if(wave->count == 0) wave->firstLevel = level;
+        valid = ((wave->firstLevel ^ wave->count) & 1) == level && time == elapsed;
+        elapsed += width;
+        wave->width[wave->count++] = width;
+    }
+    fclose(fp);
+    wave->ready = valid;
+    return valid;
+}
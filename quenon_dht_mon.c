@@ -1,5 +1,4 @@
 #include "quenon_dht_mon.h"
-#include <m-string.h>
 
 //Порты ввода/вывода, которые не были обозначены в общем списке
 const GpioPin SWC_10 = {.pin = LL_GPIO_PIN_14, .port = GPIOA};
@@ -63,6 +62,31 @@ uint8_t DHTMon_GPIO_to_index(const GpioPin* gpio) {
     return 255;
 }
 
+/**
+ * @brief Номер порта датчика в таблице портов
+ * @details Номер запоминается в описателе линии при назначении пина, таблица
+ * просматривается только если описатель относится к другому пину
+ * 
+ * @param sensor Указатель на датчик
+ * @return Номер порта или 255, если порт не из таблицы
+ */
+static uint8_t DHTMon_sensor_GPIOIndex(const DHT_sensor* sensor) {
+    uint8_t index = sensor->line.index;
+    if(index < GPIO_ITEMS && gpio_item[index].pin == sensor->GPIO) return index;
+    return DHTMon_GPIO_to_index(sensor->GPIO);
+}
+
+/**
+ * @brief Назначение пина датчику с расчётом описателя линии
+ * 
+ * @param sensor Указатель на датчик
+ * @param gpio Пин датчика
+ */
+static void DHTMon_sensor_setGPIO(DHT_sensor* sensor, const GpioPin* gpio) {
+    sensor->GPIO = gpio;
+    DHT_initLine(sensor, DHTMon_GPIO_to_index(gpio));
+}
+
 const char* DHTMon_GPIO_getName(const GpioPin* gpio) {
     if(gpio == NULL) return NULL;
     for(uint8_t i = 0; i < GPIO_ITEMS; i++) {
@@ -73,6 +97,50 @@ const char* DHTMon_GPIO_getName(const GpioPin* gpio) {
     return NULL;
 }
 
+/**
+ * @brief Настройка порта датчика
+ * 
+ * @param gpio Порт датчика
+ */
+static void DHTMon_sensor_initGPIO(const GpioPin* gpio) {
+    //Высокий уровень по умолчанию
+    furi_hal_gpio_write(gpio, true);
+    //Режим работы - OpenDrain, подтяжка включается на всякий случай
+    furi_hal_gpio_init(
+        gpio, //Порт FZ
+        GpioModeOutputOpenDrain, //Режим работы - открытый сток
+        GpioPullUp, //Принудительная подтяжка линии данных к питанию
+        GpioSpeedVeryHigh); //Скорость работы - максимальная
+}
+
+/**
+ * @brief Перевод порта датчика в состояние по умолчанию
+ * 
+ * @param gpio Порт датчика
+ */
+static void DHTMon_sensor_deinitGPIO(const GpioPin* gpio) {
+    furi_hal_gpio_init(
+        gpio, //Порт FZ
+        GpioModeAnalog, //Режим работы - аналог
+        GpioPullNo, //Отключение подтяжки
+        GpioSpeedLow); //Скорость работы - низкая
+    //Установка низкого уровня
+    furi_hal_gpio_write(gpio, false);
+}
+
+/**
+ * @brief Проверка, подключён ли к порту хоть один датчик из списка
+ * 
+ * @param gpio Порт
+ * @return true Порт занят
+ */
+static bool DHTMon_GPIO_isUsed(const GpioPin* gpio) {
+    for(uint16_t i = 0; i < app->sensors_count; i++) {
+        if(app->sensors[i].GPIO == gpio) return true;
+    }
+    return false;
+}
+
 void DHTMon_sensors_init(void) {
     //Включение 5V если на порту 1 FZ его нет
     if(furi_hal_power_is_otg_enabled() != true) {
@@ -80,37 +148,26 @@ void DHTMon_sensors_init(void) {
     }
 
     //Настройка GPIO загруженных датчиков
-    for(uint8_t i = 0; i < app->sensors_count; i++) {
-        //Высокий уровень по умолчанию
-        furi_hal_gpio_write(app->sensors[i].GPIO, true);
-        //Режим работы - OpenDrain, подтяжка включается на всякий случай
-        furi_hal_gpio_init(
-            app->sensors[i].GPIO, //Порт FZ
-            GpioModeOutputOpenDrain, //Режим работы - открытый сток
-            GpioPullUp, //Принудительная подтяжка линии данных к питанию
-            GpioSpeedVeryHigh); //Скорость работы - максимальная
+    for(uint16_t i = 0; i < app->sensors_count; i++) {
+        DHTMon_sensor_initGPIO(app->sensors[i].GPIO);
     }
 }
 
 void DHTMon_sensors_deinit(void) {
-    //Возврат исходного состояния 5V
+    //Возврат исходного состояния 5V. В режиме экономии оно могло быть выключено
     if(app->last_OTG_State != true) {
         furi_hal_power_disable_otg();
+    } else if(!furi_hal_power_is_otg_enabled()) {
+        furi_hal_power_enable_otg();
     }
 
     //Перевод портов GPIO в состояние по умолчанию
-    for(uint8_t i = 0; i < app->sensors_count; i++) {
-        furi_hal_gpio_init(
-            app->sensors[i].GPIO, //Порт FZ
-            GpioModeAnalog, //Режим работы - аналог
-            GpioPullNo, //Отключение подтяжки
-            GpioSpeedLow); //Скорость работы - низкая
-        //Установка низкого уровня
-        furi_hal_gpio_write(app->sensors[i].GPIO, false);
+    for(uint16_t i = 0; i < app->sensors_count; i++) {
+        DHTMon_sensor_deinitGPIO(app->sensors[i].GPIO);
     }
 }
 
-bool DHTMon_sensor_check(DHT_sensor* sensor) {
+bool DHTMon_sensor_check(const DHT_sensor* sensor) {
     /* Проверка имени */
     //1) Строка должна быть длиной от 1 до 10 символов
     //2) Первый символ строки должен быть только 0-9, A-Z, a-z и _
@@ -122,16 +179,12 @@ bool DHTMon_sensor_check(DHT_sensor* sensor) {
         return false;
     }
     //Проверка GPIO
-    if(DHTMon_GPIO_to_int(sensor->GPIO) == 255) {
-        FURI_LOG_D(
-            APP_NAME,
-            "Sensor [%s] GPIO check failed: %d\r\n",
-            sensor->name,
-            DHTMon_GPIO_to_int(sensor->GPIO));
+    if(DHTMon_sensor_GPIOIndex(sensor) == 255) {
+        FURI_LOG_D(APP_NAME, "Sensor [%s] GPIO check failed\r\n", sensor->name);
         return false;
     }
     //Проверка типа датчика
-    if(sensor->type != DHT11 && sensor->type != DHT22) {
+    if(DHT_getDriver(sensor->type) == NULL) {
         FURI_LOG_D(APP_NAME, "Sensor [%s] type check failed: %d\r\n", sensor->name, sensor->type);
         return false;
     }
@@ -141,42 +194,222 @@ bool DHTMon_sensor_check(DHT_sensor* sensor) {
     return true;
 }
 
+/**
+ * @brief Перенос в датчик параметров, которые задаёт пользователь
+ * 
+ * @param sensor Датчик из списка
+ * @param config Датчик с новыми параметрами
+ */
+static void DHTMon_sensor_setConfig(DHT_sensor* sensor, const DHT_sensor* config) {
+    memcpy(sensor->name, config->name, sizeof(sensor->name));
+    if(sensor->GPIO != config->GPIO || sensor->line.idr == NULL) {
+        DHTMon_sensor_setGPIO(sensor, config->GPIO);
+    }
+    sensor->type = config->type;
+    sensor->pollingInterval = config->pollingInterval;
+    sensor->thresholds = config->thresholds;
+}
+
+/**
+ * @brief Сброс показаний строки датчика на экране
+ * 
+ * @param index Индекс датчика в списке
+ */
+static void DHTMon_readings_clear(uint16_t index) {
+    furi_mutex_acquire(app->readings_mutex, FuriWaitForever);
+    DHTMon_reading* reading = &app->readings[index];
+    memcpy(reading->name, app->sensors[index].name, sizeof(reading->name));
+    reading->data = (DHT_data){.status = DHT_NO_RESPONSE};
+    furi_mutex_release(app->readings_mutex);
+}
+
+/**
+ * @brief Увеличение пула датчиков
+ * @details Память выделяется порциями по DHTMON_POOL_STEP датчиков сразу во всех
+ * модулях, которые что-то хранят для каждого датчика. Вызывается под мутексом списка датчиков
+ * 
+ * @param count Количество датчиков, которое должно поместиться в пул
+ */
+static void DHTMon_sensors_reserve(uint16_t count) {
+    if(count <= app->sensors_capacity) return;
+    uint16_t capacity = (count + DHTMON_POOL_STEP - 1) / DHTMON_POOL_STEP * DHTMON_POOL_STEP;
+    app->sensors = realloc(app->sensors, capacity * sizeof(DHT_sensor));
+    memset(
+        &app->sensors[app->sensors_capacity],
+        0,
+        (capacity - app->sensors_capacity) * sizeof(DHT_sensor));
+
+    furi_mutex_acquire(app->readings_mutex, FuriWaitForever);
+    app->readings = realloc(app->readings, capacity * sizeof(DHTMon_reading));
+    for(uint16_t i = app->sensors_capacity; i < capacity; i++) {
+        app->readings[i] = (DHTMon_reading){.data.status = DHT_NO_RESPONSE};
+    }
+    furi_mutex_release(app->readings_mutex);
+
+    app->sensor_memory = sizeof(DHT_sensor) + sizeof(DHTMon_reading);
+    app->sensor_memory += DHTMon_scheduler_resize(capacity);
+    app->sensor_memory += DHTMon_history_resize(capacity);
+    app->sensor_memory += DHTMon_logger_resize(capacity);
+    app->sensor_memory += DHTMon_alarm_resize(capacity);
+    app->sensors_capacity = capacity;
+}
+
+bool DHTMon_sensor_add(const DHT_sensor* sensor) {
+    if(!DHTMon_sensor_check(sensor)) return false;
+    furi_mutex_acquire(app->sensors_mutex, FuriWaitForever);
+    uint16_t index = app->sensors_count > 0 ? app->sensors_count : 0;
+    bool added = index < INT16_MAX;
+    if(added) {
+        DHTMon_sensors_reserve(index + 1);
+        DHT_sensor* newSensor = &app->sensors[index];
+        memset(newSensor, 0, sizeof(DHT_sensor));
+        DHTMon_sensor_setConfig(newSensor, sensor);
+        DHT_resetState(newSensor);
+        app->sensors_count = index + 1;
+        //Настраивается только порт нового датчика, остальные датчики не трогаются.
+        //Питание подаёт поток опроса
+        DHTMon_sensor_initGPIO(newSensor->GPIO);
+        if(!DHTMon_power_isOn()) furi_hal_gpio_write(newSensor->GPIO, false);
+        DHTMon_readings_clear(index);
+        DHTMon_scheduler_push(index, furi_get_tick() + DHTMon_scheduler_jitter());
+        DHTMon_poller_wake();
+    }
+    furi_mutex_release(app->sensors_mutex);
+    if(added) DHTMon_logger_requestSave();
+    return added;
+}
+
+bool DHTMon_sensor_update(DHT_sensor* sensor, const DHT_sensor* config) {
+    if(sensor == NULL || !DHTMon_sensor_check(config)) return false;
+    furi_mutex_acquire(app->sensors_mutex, FuriWaitForever);
+    uint16_t index = sensor - app->sensors;
+    const GpioPin* oldGPIO = sensor->GPIO;
+    //Датчик на другом порту или другого типа - это уже другой датчик
+    bool replaced = oldGPIO != config->GPIO || sensor->type != config->type;
+    bool reschedule = replaced || sensor->pollingInterval != config->pollingInterval;
+    //Тревоги по прежним порогам снимаются, новые пороги проверяются со следующего опроса
+    bool rearm = replaced ||
+                 memcmp(&sensor->thresholds, &config->thresholds, sizeof(DHT_thresholds)) != 0;
+    DHTMon_sensor_setConfig(sensor, config);
+    if(oldGPIO != sensor->GPIO) {
+        if(!DHTMon_GPIO_isUsed(oldGPIO)) DHTMon_sensor_deinitGPIO(oldGPIO);
+        DHTMon_sensor_initGPIO(sensor->GPIO);
+        if(!DHTMon_power_isOn()) furi_hal_gpio_write(sensor->GPIO, false);
+    }
+    if(rearm) DHTMon_alarm_reset(index);
+    if(replaced) {
+        DHT_resetState(sensor);
+        DHTMon_readings_clear(index);
+    } else {
+        //Показания остаются, меняется только имя в строке экрана
+        furi_mutex_acquire(app->readings_mutex, FuriWaitForever);
+        memcpy(app->readings[index].name, sensor->name, sizeof(sensor->name));
+        if(rearm) app->readings[index].alarms = 0;
+        furi_mutex_release(app->readings_mutex);
+    }
+    //Опрос по новым параметрам сразу, частоту опроса по-прежнему ограничивает драйвер
+    if(reschedule) {
+        DHTMon_scheduler_update(index, furi_get_tick() + DHTMon_scheduler_jitter());
+        DHTMon_poller_wake();
+    }
+    furi_mutex_release(app->sensors_mutex);
+    DHTMon_logger_requestSave();
+    return true;
+}
+
 void DHTMon_sensor_delete(DHT_sensor* sensor) {
     if(sensor == NULL) return;
-    //Делаем параметры датчика неверными
-    sensor->name[0] = '\0';
-    sensor->type = 255;
-    //Теперь сохраняем текущие датчики. Сохранятор не сохранит неисправный датчик
-    DHTMon_sensors_save();
-    //Перезагружаемся с SD-карты
-    DHTMon_sensors_reload();
+    furi_mutex_acquire(app->sensors_mutex, FuriWaitForever);
+    uint16_t index = sensor - app->sensors;
+    bool deleted = index < app->sensors_count;
+    if(deleted) {
+        const GpioPin* gpio = sensor->GPIO;
+        //Следующие датчики сдвигаются на место удалённого вместе с показаниями и историей
+        uint16_t tail = app->sensors_count - index - 1;
+        memmove(&app->sensors[index], &app->sensors[index + 1], tail * sizeof(DHT_sensor));
+        app->sensors_count--;
+        memset(&app->sensors[app->sensors_count], 0, sizeof(DHT_sensor));
+        if(!DHTMon_GPIO_isUsed(gpio)) DHTMon_sensor_deinitGPIO(gpio);
+
+        furi_mutex_acquire(app->readings_mutex, FuriWaitForever);
+        memmove(&app->readings[index], &app->readings[index + 1], tail * sizeof(DHTMon_reading));
+        app->readings[app->sensors_count] = (DHTMon_reading){.data.status = DHT_NO_RESPONSE};
+        furi_mutex_release(app->readings_mutex);
+
+        DHTMon_history_remove(index);
+        DHTMon_scheduler_remove(index);
+        DHTMon_alarm_remove(index);
+        DHTMon_poller_wake();
+    }
+    furi_mutex_release(app->sensors_mutex);
+    if(deleted) DHTMon_logger_requestSave();
 }
 
-uint8_t DHTMon_sensors_save(void) {
+bool DHTMon_sensor_captureWave(DHT_sensor* sensor) {
+    if(sensor == NULL) return false;
+    furi_mutex_acquire(app->sensors_mutex, FuriWaitForever);
+    uint16_t index = sensor - app->sensors;
+    bool armed = index < app->sensors_count &&
+                 DHTMon_wave_arm(app->sensors, app->sensors_count, sensor);
+    if(armed) {
+        //Не дожидаясь интервала опроса. Слишком ранний опрос драйвер всё равно отложит
+        DHTMon_scheduler_update(index, furi_get_tick());
+        DHTMon_poller_wake();
+    }
+    furi_mutex_release(app->sensors_mutex);
+    return armed;
+}
+
+uint16_t DHTMon_sensors_save(void) {
+    //Снимок берётся под мутексом, а SD-карта пишется уже без него, чтобы не задерживать опрос
+    furi_mutex_acquire(app->sensors_mutex, FuriWaitForever);
+    uint16_t count = app->sensors_count > 0 ? app->sensors_count : 0;
+    DHT_sensor* saveSnapshot = malloc(count * sizeof(DHT_sensor) + 1);
+    memcpy(saveSnapshot, app->sensors, count * sizeof(DHT_sensor));
+    furi_mutex_release(app->sensors_mutex);
+
     //Выделение памяти для потока
-    app->file_stream = file_stream_alloc(app->storage);
-    uint8_t savedSensorsCount = 0;
-    //Переменная пути к файлу
-    FuriString* filepath = furi_string_alloc();
-    //Составление пути к файлу
-    furi_string_printf(filepath, "%s/%s", APP_PATH_FOLDER, APP_FILENAME);
-
-    //Открытие потока. Если поток открылся, то выполнение сохранения датчиков
-    if(file_stream_open(
-           app->file_stream, furi_string_get_cstr(filepath), FSAM_READ_WRITE, FSOM_CREATE_ALWAYS)) {
+    Stream* stream = file_stream_alloc(app->storage);
+    uint16_t savedSensorsCount = 0;
+    bool written = false;
+
+    //Датчики пишутся во временный файл, прежний файл остаётся целым при сбое посреди записи
+    if(file_stream_open(stream, APP_FILEPATH_TMP, FSAM_READ_WRITE, FSOM_CREATE_ALWAYS)) {
         const char template[] =
-            "#DHT monitor sensors file\n#Name - name of sensor. Up to 10 sumbols\n#Type - type of sensor. DHT11 - 0, DHT22 - 1\n#GPIO - connection port. May being 2-7, 10, 12-17\n#Name Type GPIO\n";
-        stream_write(app->file_stream, (uint8_t*)template, strlen(template));
+            "#DHT monitor sensors file\n#Name - name of sensor. Up to 10 sumbols\n#Type - type of sensor.";
+        written = stream_write(stream, (uint8_t*)template, strlen(template)) == strlen(template);
+        //Перечень типов берётся из драйверов
+        for(uint8_t type = 0; type < DHT_TYPES_COUNT && written; type++) {
+            written = stream_write_format(
+                          stream,
+                          "%s %s - %u",
+                          type == 0 ? "" : ",",
+                          DHT_getDriver(type)->name,
+                          type) > 0;
+        }
+        const char legend[] =
+            "\n#GPIO - connection port. May being 2-7, 10, 12-17\n#Interval - polling interval in seconds. 0 - minimal for sensor type\n#TempLow TempHigh HumLow HumHigh - alarm thresholds in *C and %. \"-\" - disabled\n#Name Type GPIO Interval TempLow TempHigh HumLow HumHigh\n";
+        written = written &&
+                  stream_write(stream, (uint8_t*)legend, strlen(legend)) == strlen(legend);
         //Сохранение датчиков
-        for(uint8_t i = 0; i < app->sensors_count; i++) {
+        for(uint16_t i = 0; i < count && written; i++) {
             //Если параметры датчика верны, то сохраняемся
-            if(DHTMon_sensor_check(&app->sensors[i])) {
-                stream_write_format(
-                    app->file_stream,
-                    "%s %d %d\n",
-                    app->sensors[i].name,
-                    app->sensors[i].type,
-                    DHTMon_GPIO_to_int(app->sensors[i].GPIO));
+            if(DHTMon_sensor_check(&saveSnapshot[i])) {
+                written = stream_write_format(
+                              stream,
+                              "%s %d %d %lu",
+                              saveSnapshot[i].name,
+                              saveSnapshot[i].type,
+                              gpio_item[DHTMon_sensor_GPIOIndex(&saveSnapshot[i])].num,
+                              saveSnapshot[i].pollingInterval / 1000) > 0;
+                const DHT_thresholds* thresholds = &saveSnapshot[i].thresholds;
+                for(uint8_t alarm = 0; alarm < DHT_ALARMS_COUNT && written; alarm++) {
+                    written = thresholds->enabled & (1 << alarm) ?
+                                  stream_write_format(
+                                      stream, " %d", thresholds->limit[alarm] / 10) > 0 :
+                                  stream_write_format(stream, " -") > 0;
+                }
+                written = written && stream_write_format(stream, "\n") > 0;
                 savedSensorsCount++;
             }
         }
@@ -184,27 +417,172 @@ uint8_t DHTMon_sensors_save(void) {
         //TODO: печать ошибки на экран
         FURI_LOG_E(APP_NAME, "cannot create sensors file\r\n");
     }
-    stream_free(app->file_stream);
+    stream_free(stream);
+    free(saveSnapshot);
+
+    if(written) {
+        //Замена файла датчиков. Если сбой случится между удалением и переименованием,
+        //временный файл будет подхвачен при загрузке
+        storage_common_remove(app->storage, APP_FILEPATH);
+        if(storage_common_rename(app->storage, APP_FILEPATH_TMP, APP_FILEPATH) != FSE_OK) {
+            FURI_LOG_E(APP_NAME, "cannot replace sensors file\r\n");
+        }
+    } else {
+        FURI_LOG_E(APP_NAME, "sensors file write failed\r\n");
+    }
 
     return savedSensorsCount;
 }
 
-bool DHTMon_sensors_load(void) {
+//Состояние разбора строки файла датчиков
+typedef struct {
+    DHT_sensor sensor; //Собираемый датчик
+    uint32_t values[DHTMON_LINE_VALUES]; //Числовые поля: тип, порт, интервал, пороги тревог
+    uint8_t digits; //Битовая маска числовых полей, в которых есть цифры
+    uint8_t negative; //Битовая маска отрицательных числовых полей
+    uint8_t field; //Номер текущего поля
+    uint8_t length; //Длина текущего поля
+    bool comment; //Строка - комментарий
+    bool invalid; //В строке ошибка, датчик не будет добавлен
+} DHTMon_lineParser;
+
+/**
+ * @brief Подготовка к разбору новой строки
+ * 
+ * @param parser Состояние разбора
+ */
+static void DHTMon_lineParser_reset(DHTMon_lineParser* parser) {
+    memset(parser, 0, sizeof(DHTMon_lineParser));
+}
+
+/**
+ * @brief Добавление датчика из разобранной строки
+ * 
+ * @param parser Состояние разбора
+ */
+static void DHTMon_lineParser_commit(DHTMon_lineParser* parser) {
+    //Строка без имени, типа и порта не описывает датчик
+    uint8_t fields = parser->field + (parser->length > 0 ? 1 : 0);
+    if(parser->comment || parser->invalid || fields < 3) return;
+    if(app->sensors_count >= INT16_MAX) return;
+
+    DHT_sensor* s = &parser->sensor;
+    //Неизвестный тип отсекается здесь: DHT_getDriver принимает uint8_t, и тип 256 стал бы DHT11
+    s->type = parser->values[0] < DHT_TYPES_COUNT ? parser->values[0] : DHT_TYPES_COUNT;
+    DHTMon_sensor_setGPIO(
+        s, DHTMon_GPIO_form_int(parser->values[1] > 255 ? 255 : parser->values[1]));
+    //Интервал опроса необязателен, в старых файлах его нет
+    s->pollingInterval = parser->values[2] * 1000;
+    //Пороги тревог в целых градусах и процентах. "-" или отсутствие поля - порог выключен
+    for(uint8_t alarm = 0; alarm < DHT_ALARMS_COUNT; alarm++) {
+        uint8_t field = DHTMON_LINE_THRESHOLD + alarm;
+        if(!(parser->digits & (1 << field)) || parser->values[field] > 1000) continue;
+        int16_t limit = parser->values[field] * 10;
+        s->thresholds.limit[alarm] = parser->negative & (1 << field) ? -limit : limit;
+        s->thresholds.enabled |= 1 << alarm;
+    }
+    //Если данные корректны, то
+    if(DHTMon_sensor_check(s) == true) {
+        //Установка нуля при первом датчике
+        if(app->sensors_count == -1) app->sensors_count = 0;
+        //Добавление датчика в общий список
+        DHTMon_sensors_reserve(app->sensors_count + 1);
+        app->sensors[app->sensors_count] = *s;
+        //Увеличение количества загруженных датчиков
+        app->sensors_count++;
+    }
+}
+
+/**
+ * @brief Разбор очередного символа файла датчиков
+ * @details Строка имеет вид "Имя Тип Порт [Интервал [Пороги тревог]]". Имя складывается сразу в датчик,
+ * числа накапливаются по цифрам, поэтому строка никуда не копируется
+ * 
+ * @param parser Состояние разбора
+ * @param c Символ
+ */
+static void DHTMon_lineParser_feed(DHTMon_lineParser* parser, char c) {
+    if(c == '\n') {
+        DHTMon_lineParser_commit(parser);
+        DHTMon_lineParser_reset(parser);
+        return;
+    }
+    if(parser->comment || parser->invalid) return;
+
+    if(c == ' ' || c == '\t' || c == '\r') {
+        //Конец поля
+        if(parser->length > 0) {
+            parser->field++;
+            parser->length = 0;
+        }
+        return;
+    }
+    //Комментарий начинается с # в начале строки
+    if(c == '#' && parser->field == 0 && parser->length == 0) {
+        parser->comment = true;
+        return;
+    }
+
+    if(parser->field == 0) {
+        //Имя датчика не длиннее 10 символов
+        if(parser->length >= sizeof(parser->sensor.name) - 1) {
+            parser->invalid = true;
+            return;
+        }
+        parser->sensor.name[parser->length++] = c;
+    } else if(parser->field <= DHTMON_LINE_VALUES) {
+        //Числовые поля - только цифры с ограничением величины. Пороги могут быть отрицательными
+        uint8_t field = parser->field - 1;
+        if(c == '-' && parser->length == 0 && field >= DHTMON_LINE_THRESHOLD) {
+            parser->negative |= 1 << field;
+            parser->length++;
+            return;
+        }
+        uint32_t* value = &parser->values[field];
+        if(c < '0' || c > '9' || *value > 100000) {
+            parser->invalid = true;
+            return;
+        }
+        *value = *value * 10 + (c - '0');
+        parser->digits |= 1 << field;
+        parser->length++;
+    }
+    //Лишние поля пропускаются
+}
+
+/**
+ * @brief Загрузка датчиков с SD-карты. Вызывается под мутексом списка датчиков
+ * 
+ * @return true Был загружен хотя бы 1 датчик
+ * @return false Датчики отсутствуют
+ */
+static bool DHTMon_sensors_load_locked(void) {
     //Обнуление количества датчиков
     app->sensors_count = -1;
-    //Очистка предыдущих датчиков
-    memset(app->sensors, 0, sizeof(app->sensors));
+    //Очистка предыдущих датчиков. Пул не уменьшается
+    memset(app->sensors, 0, app->sensors_capacity * sizeof(DHT_sensor));
+    //Сброс показаний, оставшихся от предыдущих датчиков
+    furi_mutex_acquire(app->readings_mutex, FuriWaitForever);
+    for(uint16_t i = 0; i < app->sensors_capacity; i++) {
+        app->readings[i] = (DHTMon_reading){.data.status = DHT_NO_RESPONSE};
+    }
+    furi_mutex_release(app->readings_mutex);
+    //Индексы датчиков могли поменяться, старая история и тревоги к ним не относятся
+    DHTMon_history_reset();
+    DHTMon_alarm_resetAll();
+
+    //Восстановление после сбоя во время замены файла датчиков
+    if(!storage_file_exists(app->storage, APP_FILEPATH) &&
+       storage_file_exists(app->storage, APP_FILEPATH_TMP)) {
+        FURI_LOG_W(APP_NAME, "Restoring sensors file from temporary copy\r\n");
+        storage_common_rename(app->storage, APP_FILEPATH_TMP, APP_FILEPATH);
+    }
 
     //Открытие файла на SD-карте
     //Выделение памяти для потока
     app->file_stream = file_stream_alloc(app->storage);
-    //Переменная пути к файлу
-    FuriString* filepath = furi_string_alloc();
-    //Составление пути к файлу
-    furi_string_printf(filepath, "%s/%s", APP_PATH_FOLDER, APP_FILENAME);
     //Открытие потока к файлу
-    if(!file_stream_open(
-           app->file_stream, furi_string_get_cstr(filepath), FSAM_READ_WRITE, FSOM_OPEN_EXISTING)) {
+    if(!file_stream_open(app->file_stream, APP_FILEPATH, FSAM_READ_WRITE, FSOM_OPEN_EXISTING)) {
         //Если файл отсутствует, то создание болванки
         FURI_LOG_W(APP_NAME, "Missing sensors file. Creating new file\r\n");
         app->sensors_count = 0;
@@ -212,61 +590,43 @@ bool DHTMon_sensors_load(void) {
         DHTMon_sensors_save();
         return false;
     }
-    //Вычисление размера файла
-    size_t file_size = stream_size(app->file_stream);
-    if(file_size == (size_t)0) {
-        //Выход если файл пустой
-        FURI_LOG_W(APP_NAME, "Sensors file is empty\r\n");
-        app->sensors_count = 0;
-        stream_free(app->file_stream);
-        return false;
-    }
 
-    //Выделение памяти под загрузку файла
-    uint8_t* file_buf = malloc(file_size);
-    //Опустошение буфера файла
-    memset(file_buf, 0, file_size);
-    //Загрузка файла
-    if(stream_read(app->file_stream, file_buf, file_size) != file_size) {
-        //Выход при ошибке чтения
-        FURI_LOG_E(APP_NAME, "Error reading sensor file\r\n");
-        app->sensors_count = 0;
-        stream_free(app->file_stream);
-        return false;
-    }
-    //Построчное чтение файла
-    //Указатель на начало строки
-    FuriString* file = furi_string_alloc_set_str((char*)file_buf);
-    //Сколько байт до конца строки
-    size_t line_end = 0;
-    while(line_end != STRING_FAILURE && app->sensors_count < MAX_SENSORS) {
-        if(((char*)(file_buf + line_end))[1] != '#') {
-            DHT_sensor s = {0};
-            int type, port;
-            char name[11] = {0};
-            sscanf(((char*)(file_buf + line_end)), "%s %d %d", name, &type, &port);
-            s.type = type;
-            s.GPIO = DHTMon_GPIO_form_int(port);
-
-            name[10] = '\0';
-            strcpy(s.name, name);
-            //Если данные корректны, то
-            if(DHTMon_sensor_check(&s) == true) {
-                //Установка нуля при первом датчике
-                if(app->sensors_count == -1) app->sensors_count = 0;
-                //Добавление датчика в общий список
-                app->sensors[app->sensors_count] = s;
-                //Увеличение количества загруженных датчиков
-                app->sensors_count++;
-            }
+    //Замер времени загрузки, чтобы следить за его ростом при увеличении числа датчиков
+    uint32_t loadStart = DWT->CYCCNT;
+    size_t loadSize = 0;
+
+    //Файл читается небольшими порциями, строки разбираются по мере поступления символов
+    DHTMon_lineParser parser;
+    DHTMon_lineParser_reset(&parser);
+    uint8_t chunk[DHTMON_LOAD_CHUNK];
+    size_t chunk_size;
+    while((chunk_size = stream_read(app->file_stream, chunk, sizeof(chunk))) > 0) {
+        loadSize += chunk_size;
+        for(size_t i = 0; i < chunk_size; i++) {
+            DHTMon_lineParser_feed(&parser, chunk[i]);
         }
-        line_end = furi_string_search_char(file, '\n', line_end + 1);
     }
+    //Последняя строка может быть без перевода строки
+    DHTMon_lineParser_feed(&parser, '\n');
     stream_free(app->file_stream);
-    free(file_buf);
+    FURI_LOG_I(
+        APP_NAME,
+        "Sensors file: %u bytes parsed in %lu us\r\n",
+        loadSize,
+        (DWT->CYCCNT - loadStart) / furi_hal_cortex_instructions_per_microsecond());
 
     //Обнуление количества датчиков если ни один из них не был загружен
     if(app->sensors_count == -1) app->sensors_count = 0;
+    //Имена датчиков для строк главного экрана
+    for(uint16_t i = 0; i < app->sensors_count; i++) {
+        DHTMon_readings_clear(i);
+    }
+    FURI_LOG_I(
+        APP_NAME,
+        "%d sensors, pool for %u, %u bytes per sensor\r\n",
+        app->sensors_count,
+        app->sensors_capacity,
+        app->sensor_memory);
 
     //Инициализация портов датчиков если таковые есть
     if(app->sensors_count > 0) {
@@ -278,9 +638,216 @@ bool DHTMon_sensors_load(void) {
     return false;
 }
 
-bool DHTMon_sensors_reload(void) {
-    DHTMon_sensors_deinit();
-    return DHTMon_sensors_load();
+bool DHTMon_sensors_load(void) {
+    furi_mutex_acquire(app->sensors_mutex, FuriWaitForever);
+    bool loaded = DHTMon_sensors_load_locked();
+    DHTMon_poller_reschedule();
+    furi_mutex_release(app->sensors_mutex);
+    return loaded;
+}
+
+/**
+ * @brief Проверка, изменит ли новое показание строку на экране
+ * 
+ * @param old Показание, которое сейчас на экране
+ * @param new Новое показание
+ * @return true Строку нужно перерисовать
+ */
+static bool DHTMon_reading_changed(const DHT_data* old, const DHT_data* new) {
+    bool oldValid = DHT_isValid(old), newValid = DHT_isValid(new);
+    if(oldValid != newValid) return true;
+    if(!newValid) return old->status != new->status;
+    //Устаревшие показания помечаются на экране
+    if((old->status == DHT_STALE) != (new->status == DHT_STALE)) return true;
+    //Производные величины зависят и от десятых долей влажности
+    return old->temp != new->temp || old->hum != new->hum;
+}
+
+/**
+ * @brief Поток опроса датчиков
+ * @details Единственный владелец шины датчиков. Спит до времени опроса ближайшего
+ * датчика, опрашивает подошедшие датчики одной пачкой и публикует показания
+ * в снимок, который экран только копирует
+ * 
+ * @param context Не используется
+ * @return Код завершения
+ */
+static int32_t DHTMon_poller(void* context) {
+    UNUSED(context);
+    uint32_t flags = DHTMON_POLLER_FLAG_RESCHEDULE;
+    for(;;) {
+        furi_mutex_acquire(app->sensors_mutex, FuriWaitForever);
+        uint16_t count = app->sensors_count > 0 ? app->sensors_count : 0;
+        if(!(flags & FuriFlagError) && (flags & DHTMON_POLLER_FLAG_RESCHEDULE)) {
+            DHTMon_scheduler_reset(count);
+        }
+
+        //Питание датчиков. В режиме экономии 5V подаётся заранее, чтобы датчики успели
+        //установиться к ближайшему опросу. Всё, что подойдёт за время установления,
+        //опрашивается за одно включение
+        bool saver = DHTMon_power_isSaver();
+        uint32_t settle = saver ? DHTMon_power_settle(app->sensors, count) : 0;
+        uint32_t next;
+        bool pending = DHTMon_scheduler_peek(&next);
+        if(!saver || (!DHTMon_power_isOn() && pending &&
+                      (int32_t)(next - furi_get_tick()) <= (int32_t)settle)) {
+            DHTMon_power_on(app->sensors, count);
+        }
+        //До окончания установления датчики не опрашиваются
+        uint32_t ready = DHTMon_power_readyTick(app->sensors, count);
+        bool powered = DHTMon_power_isOn() && (int32_t)(furi_get_tick() - ready) >= 0;
+
+        //Сбор датчиков, которых пора опрашивать. Пачка ограничена числом стартовых
+        //импульсов внахлёст, остальные датчики дождутся следующего прохода
+        DHT_sensor* batch[DHT_BATCH_MAX];
+        DHT_data data[DHT_BATCH_MAX];
+        uint16_t indexes[DHT_BATCH_MAX];
+        uint16_t deferred[DHT_BATCH_MAX];
+        uint8_t due = 0, deferredCount = 0;
+        uint16_t index;
+        while(powered && due < DHT_BATCH_MAX && deferredCount < DHT_BATCH_MAX &&
+              DHTMon_scheduler_popDue(furi_get_tick(), &index)) {
+            //Датчики на одном порту нельзя опрашивать внахлёст, они переносятся на следующую пачку
+            bool busy = false;
+            for(uint8_t i = 0; i < due && !busy; i++) {
+                busy = batch[i]->GPIO == app->sensors[index].GPIO;
+            }
+            if(busy) {
+                deferred[deferredCount++] = index;
+                continue;
+            }
+            indexes[due] = index;
+            batch[due] = &app->sensors[index];
+            due++;
+        }
+        for(uint8_t i = 0; i < deferredCount; i++) {
+            DHTMon_scheduler_push(deferred[i], furi_get_tick());
+        }
+
+        if(due > 0) {
+            //Опрос всех подошедших датчиков одной пачкой со стартовыми импульсами внахлёст
+            DHT_getDataBatch(batch, data, due);
+
+            //Запись свежих показаний в буфер журнала. SD-карта пишется отдельным потоком
+            for(uint8_t i = 0; i < due; i++) {
+                //Прежние показания в ожидании повторного опроса тоже не новые
+                if(data[i].status != DHT_CACHED && data[i].status != DHT_STALE) {
+                    DHTMon_history_push(indexes[i], &data[i]);
+                    DHTMon_logger_add(indexes[i], batch[i], &data[i]);
+                }
+            }
+
+            //Следующий опрос каждого датчика через его собственный интервал. В режиме
+            //экономии без разброса, чтобы датчики с равными интервалами оставались в одной пачке
+            uint32_t now = furi_get_tick();
+            for(uint8_t i = 0; i < due; i++) {
+                DHTMon_scheduler_push(
+                    indexes[i],
+                    now + DHT_getInterval(batch[i]) + (saver ? 0 : DHTMon_scheduler_jitter()));
+            }
+
+            //Производные величины считаются один раз на свежие показания, а не на каждый кадр.
+            //Пороги проверяются здесь же, независимо от того, что сейчас на экране
+            DHTMon_metrics metrics[DHT_BATCH_MAX];
+            uint8_t alarmMask[DHT_BATCH_MAX];
+            for(uint8_t i = 0; i < due; i++) {
+                if(data[i].status == DHT_OK) DHTMon_metrics_calc(&data[i], &metrics[i]);
+                alarmMask[i] = DHTMon_alarm_check(indexes[i], &batch[i]->thresholds, &data[i]);
+            }
+
+            //Публикация показаний. Экран перерисовывается, только если
+            //на нём будет видна разница
+            furi_mutex_acquire(app->readings_mutex, FuriWaitForever);
+            bool visible = false;
+            uint16_t first = app->monitor_first;
+            for(uint8_t i = 0; i < due; i++) {
+                DHTMon_reading* reading = &app->readings[indexes[i]];
+                if(DHTMon_reading_changed(&reading->data, &data[i]) ||
+                   reading->alarms != alarmMask[i]) {
+                    visible |= indexes[i] >= first && indexes[i] < first + DHTMON_MONITOR_ROWS;
+                }
+                reading->data = data[i];
+                reading->alarms = alarmMask[i];
+                //Прежние показания сохраняют свои величины, ошибка их сбрасывает
+                if(data[i].status == DHT_OK) {
+                    reading->metrics = metrics[i];
+                } else if(!DHT_isValid(&data[i])) {
+                    reading->metrics.valid = false;
+                }
+            }
+            furi_mutex_release(app->readings_mutex);
+
+            //Запрос перерисовки, если изменилась хоть одна строка на экране
+            if(visible) {
+                PluginEvent event = {.type = EventTypeTick};
+                furi_message_queue_put(app->event_queue, &event, 0);
+            }
+        }
+
+        //Заказанная запись ответа датчика сохраняется в фоне
+        if(DHTMon_wave_collect()) DHTMon_logger_requestWave();
+
+        //Снятие питания, если до следующего опроса дольше, чем его установление
+        pending = DHTMon_scheduler_peek(&next);
+        if(saver && powered &&
+           (!pending || (int32_t)(next - furi_get_tick()) > (int32_t)settle)) {
+            DHTMon_power_off(app->sensors, count);
+        }
+
+        //Сон до опроса ближайшего датчика, до подачи питания перед ним
+        //или до окончания установления датчиков
+        uint32_t timeout = FuriWaitForever;
+        if(pending) {
+            uint32_t wake = next;
+            if(saver && !DHTMon_power_isOn()) wake = next - settle;
+            if(DHTMon_power_isOn() && (int32_t)(wake - ready) < 0) wake = ready;
+            int32_t delay = (int32_t)(wake - furi_get_tick());
+            timeout = delay > 0 ? (uint32_t)delay : 0;
+        }
+        furi_mutex_release(app->sensors_mutex);
+
+        //Ожидание следующего опроса или команды потоку
+        flags = furi_thread_flags_wait(
+            DHTMON_POLLER_FLAG_STOP | DHTMON_POLLER_FLAG_RESCHEDULE | DHTMON_POLLER_FLAG_WAKE,
+            FuriFlagWaitAny,
+            timeout);
+        if(!(flags & FuriFlagError) && (flags & DHTMON_POLLER_FLAG_STOP)) break;
+    }
+    return 0;
+}
+
+void DHTMon_poller_start(void) {
+    app->poller_thread = furi_thread_alloc();
+    furi_thread_set_name(app->poller_thread, "DHTMonPoller");
+    furi_thread_set_stack_size(app->poller_thread, 2048);
+    furi_thread_set_callback(app->poller_thread, DHTMon_poller);
+    furi_thread_start(app->poller_thread);
+}
+
+void DHTMon_poller_stop(void) {
+    if(app->poller_thread == NULL) return;
+    furi_thread_flags_set(furi_thread_get_id(app->poller_thread), DHTMON_POLLER_FLAG_STOP);
+    furi_thread_join(app->poller_thread);
+    furi_thread_free(app->poller_thread);
+    app->poller_thread = NULL;
+}
+
+void DHTMon_poller_reschedule(void) {
+    if(app->poller_thread == NULL) return;
+    furi_thread_flags_set(furi_thread_get_id(app->poller_thread), DHTMON_POLLER_FLAG_RESCHEDULE);
+}
+
+void DHTMon_poller_wake(void) {
+    if(app->poller_thread == NULL) return;
+    furi_thread_flags_set(furi_thread_get_id(app->poller_thread), DHTMON_POLLER_FLAG_WAKE);
+}
+
+void DHTMon_readings_get(DHTMon_reading* readings, uint16_t first, uint8_t count) {
+    furi_mutex_acquire(app->readings_mutex, FuriWaitForever);
+    for(uint8_t i = 0; i < count && first + i < app->sensors_count; i++) {
+        readings[i] = app->readings[first + i];
+    }
+    furi_mutex_release(app->readings_mutex);
 }
 
 /**
@@ -327,6 +894,16 @@ static bool DHTMon_alloc(void) {
 
     //Обнуление количества датчиков
     app->sensors_count = -1;
+    app->sensors_capacity = 0;
+    app->sensor_memory = 0;
+    app->sensors = NULL;
+    app->readings = NULL;
+    app->monitor_first = 0;
+    app->monitor_view = DHTMON_MONITOR_RAW;
+    app->poller_thread = NULL;
+    app->sensors_mutex = furi_mutex_alloc(FuriMutexTypeRecursive);
+    app->readings_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    DHTMon_history_init();
 
     //Инициализация мутекса
     if(!init_mutex(&app->state_mutex, app, sizeof(PluginData))) {
@@ -347,6 +924,7 @@ static bool DHTMon_alloc(void) {
 
     sensorActions_sceneCreate(app);
     sensorEdit_sceneCreate(app);
+    sensorGraph_sceneCreate(app);
 
     app->widget = widget_alloc();
     view_dispatcher_add_view(app->view_dispatcher, WIDGET_VIEW, widget_get_view(app->widget));
@@ -360,6 +938,7 @@ static bool DHTMon_alloc(void) {
 
     //Уведомления
     app->notifications = furi_record_open(RECORD_NOTIFICATION);
+    DHTMon_alarm_init(app->notifications);
 
     //Подготовка хранилища
     app->storage = furi_record_open(RECORD_STORAGE);
@@ -375,6 +954,7 @@ static bool DHTMon_alloc(void) {
 static void DHTMon_free(void) {
     //Автоматическое управление подсветкой
     notification_message(app->notifications, &sequence_display_backlight_enforce_auto);
+    DHTMon_alarm_free();
 
     furi_record_close(RECORD_STORAGE);
     furi_record_close(RECORD_NOTIFICATION);
@@ -383,6 +963,7 @@ static void DHTMon_free(void) {
     widget_free(app->widget);
     sensorEdit_sceneRemove();
     sensorActions_screneRemove();
+    sensorGraph_sceneRemove(app);
     view_dispatcher_free(app->view_dispatcher);
 
     furi_record_close(RECORD_GUI);
@@ -393,6 +974,12 @@ static void DHTMon_free(void) {
     view_port_free(app->view_port);
     furi_message_queue_free(app->event_queue);
     delete_mutex(&app->state_mutex);
+    furi_mutex_free(app->readings_mutex);
+    furi_mutex_free(app->sensors_mutex);
+    DHTMon_history_free();
+    DHTMon_scheduler_free();
+    free(app->sensors);
+    free(app->readings);
 
     free(app);
 }
@@ -412,14 +999,20 @@ int32_t quenon_dht_mon_app() {
     //Сохранение состояния наличия 5V на порту 1 FZ
     app->last_OTG_State = furi_hal_power_is_otg_enabled();
 
+    //Поток журнала запускается до загрузки: пул датчиков растёт и в журнале
+    DHTMon_logger_start(app->storage);
     //Загрузка датчиков с SD-карты
     DHTMon_sensors_load();
+    //Запуск фонового опроса датчиков
+    DHTMon_poller_start();
 
     app->currentSensorEdit = &app->sensors[0];
 
     PluginEvent event;
     for(bool processing = true; processing;) {
-        FuriStatus event_status = furi_message_queue_get(app->event_queue, &event, 100);
+        //Экран перерисовывается только по нажатию кнопок и при появлении новых показаний
+        FuriStatus event_status =
+            furi_message_queue_get(app->event_queue, &event, FuriWaitForever);
 
         acquire_mutex_block(&app->state_mutex);
 
@@ -429,12 +1022,21 @@ int32_t quenon_dht_mon_app() {
                 if(event.input.type == InputTypePress) {
                     switch(event.input.key) {
                     case InputKeyUp:
+                        //Прокрутка списка датчиков на главном экране
+                        if(app->monitor_first > 0) app->monitor_first--;
                         break;
                     case InputKeyDown:
+                        if(app->monitor_first + DHTMON_MONITOR_ROWS < app->sensors_count) {
+                            app->monitor_first++;
+                        }
                         break;
                     case InputKeyRight:
+                        //Переключение показываемой величины
+                        app->monitor_view = (app->monitor_view + 1) % DHTMON_MONITOR_COUNT;
                         break;
                     case InputKeyLeft:
+                        app->monitor_view =
+                            (app->monitor_view + DHTMON_MONITOR_COUNT - 1) % DHTMON_MONITOR_COUNT;
                         break;
                     case InputKeyMAX:
                         break;
@@ -449,15 +1051,14 @@ int32_t quenon_dht_mon_app() {
                     }
                 }
             }
-        } else {
-            FURI_LOG_D(APP_NAME, "FuriMessageQueue: event timeout");
-            // event timeout
         }
 
         view_port_update(app->view_port);
         release_mutex(&app->state_mutex, app);
     }
     //Освобождение памяти и деинициализация
+    DHTMon_poller_stop();
+    DHTMon_logger_stop();
     DHTMon_sensors_deinit();
     DHTMon_free();
 
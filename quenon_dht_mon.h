@@ -26,7 +26,13 @@
 #define APP_NAME "DHT monitor"
 #define APP_PATH_FOLDER "/ext/DHT monitor"
 #define APP_FILENAME "sensors.txt"
-#define MAX_SENSORS 5
+#define APP_FILEPATH APP_PATH_FOLDER "/" APP_FILENAME
+#define APP_FILEPATH_TMP APP_FILEPATH ".tmp" //Файл, в который сохраняются датчики перед заменой
+#define DHTMON_LOAD_CHUNK 64 //Размер порции чтения файла датчиков, байт
+#define DHTMON_LINE_VALUES 7 //Количество числовых полей строки файла датчиков
+#define DHTMON_LINE_THRESHOLD 3 //Номер первого числового поля с порогом тревоги
+#define DHTMON_POOL_STEP 4 //Шаг увеличения пула датчиков
+#define DHTMON_MONITOR_ROWS 5 //Строк датчиков на главном экране
 
 // //Виды менюшек
 typedef enum {
@@ -35,6 +41,7 @@ typedef enum {
     TEXTINPUT_VIEW,
     SENSOR_ACTIONS_VIEW,
     WIDGET_VIEW,
+    GRAPH_VIEW,
 } MENU_VIEWS;
 
 typedef enum {
@@ -42,11 +49,127 @@ typedef enum {
     EventTypeKey,
 } EventType;
 
+//Флаги потока опроса датчиков
+#define DHTMON_POLLER_FLAG_STOP (1UL << 0) //Завершение работы потока
+#define DHTMON_POLLER_FLAG_RESCHEDULE (1UL << 1) //Список датчиков изменился
+#define DHTMON_POLLER_FLAG_WAKE (1UL << 2) //Очередь опроса изменилась, пересчёт времени сна
+#define DHTMON_POLL_JITTER 100 //Наибольший случайный сдвиг времени опроса, мс
+
+//Журнал показаний
+#define DHTMON_LOG_PATH APP_PATH_FOLDER "/log.bin"
+#define DHTMON_LOG_CSV_PATH APP_PATH_FOLDER "/log.csv" //Журнал, преобразованный в CSV
+#define DHTMON_LOG_MAGIC 0xD7 //Первый байт блока журнала
+#define DHTMON_LOG_BLOCK 128 //Наибольшая длина блока журнала одного датчика, байт
+#define DHTMON_LOG_BUFFER 4096 //Размер буфера журнала в ОЗУ, байт
+#define DHTMON_LOG_SECTOR 512 //Размер сектора SD-карты, байт
+#define DHTMON_LOG_FLUSH_THRESHOLD (DHTMON_LOG_BUFFER / 2) //Заполненность буфера для выгрузки, байт
+#define DHTMON_LOG_FLUSH_INTERVAL 60000 //Наибольший интервал выгрузки буфера на карту, мс
+#define DHTMON_LOG_LINE 48 //Наибольшая длина строки журнала в CSV
+//Флаги потока записи журнала
+#define DHTMON_LOGGER_FLAG_FLUSH (1UL << 0) //Буфер заполнен, пора выгружать
+#define DHTMON_LOGGER_FLAG_STOP (1UL << 1) //Выгрузка остатка и завершение работы потока
+#define DHTMON_LOGGER_FLAG_EXPORT (1UL << 2) //Преобразование журнала в CSV
+#define DHTMON_LOGGER_FLAG_SAVE (1UL << 3) //Сохранение списка датчиков
+#define DHTMON_LOGGER_FLAG_WAVE (1UL << 4) //Сохранение записи ответа датчика
+
+//Запись ответа датчика для анализа сигнала
+#define DHTMON_WAVE_PATH APP_PATH_FOLDER "/wave.csv"
+
+//Воспроизведение эталонных ответов через декодер
+#define DHTMON_REPLAY_ROUNDS 100 //Сколько раз прогоняются ответы для замера скорости
+
+//Результат воспроизведения эталонных ответов
+typedef struct {
+    uint16_t frames; //Ответов из 5 байт
+    uint16_t framesPassed; //Ответов, сконвертированных в ожидаемые показания
+    uint16_t traces; //Осциллограмм
+    uint16_t tracesPassed; //Осциллограмм, декодированных в ожидаемые показания
+    uint32_t frameRate; //Скорость конвертации, ответов в секунду
+    uint32_t traceRate; //Скорость декодирования, осциллограмм в секунду
+    const char* failed; //Первый непрошедший ответ или NULL
+} DHTMon_replayResult;
+
+//Состояние записи ответа датчика
+typedef enum {
+    DHTMON_WAVE_IDLE, //Запись не заказана
+    DHTMON_WAVE_ARMED, //Ожидание ближайшего опроса датчика
+    DHTMON_WAVE_CAPTURED, //Ответ записан, ожидает сохранения
+    DHTMON_WAVE_SAVED, //Запись сохранена на SD-карту
+    DHTMON_WAVE_FAILED, //Запись не удалось сохранить
+} DHTMon_waveState;
+
+//Разбор записи ответа: длительности импульсов и запас до порогов декодера, мкс
+typedef struct {
+    uint8_t bits; //Принято бит
+    uint8_t ackLow; //Низкий импульс подтверждения
+    uint8_t ackHigh; //Высокий импульс подтверждения
+    uint8_t zeroMin, zeroMax; //Импульсы нулей
+    uint8_t oneMin, oneMax; //Импульсы единиц
+    uint8_t lowMin, lowMax; //Низкий уровень перед битами
+    int16_t zeroMargin; //Запас самого длинного нуля до порога DHT_BIT_THRESHOLD
+    int16_t oneMargin; //Запас самой короткой единицы до порога DHT_BIT_THRESHOLD
+    int16_t timeoutMargin; //Запас самого длинного уровня до таймаута DHT_TIMEOUT_BIT
+} DHTMon_waveReport;
+
 typedef struct {
     EventType type;
     InputEvent input;
 } PluginEvent;
 
+//Тревоги по порогам показаний
+#define DHTMON_ALARM_HYST_TEMP 5 //Гистерезис снятия тревоги по температуре, десятые доли градуса
+#define DHTMON_ALARM_HYST_HUM 20 //Гистерезис снятия тревоги по влажности, десятые доли процента
+#define DHTMON_ALARM_HOLD 10000 //Сколько должно держаться условие, чтобы тревога сработала или снялась, мс
+
+//История показаний и график
+#define DHTMON_HISTORY_LEN 128 //Отсчётов в истории датчика, степень двойки. Равно ширине графика
+#define DHTMON_GRAPH_TOP 12 //Верхняя строка области графика
+#define DHTMON_GRAPH_HEIGHT 52 //Высота области графика
+#define DHTMON_GRAPH_NONE 0xFF //Столбец графика без значения
+
+//Отображаемая на графике величина
+typedef enum {
+    DHTMON_GRAPH_TEMP,
+    DHTMON_GRAPH_HUM,
+} DHTMon_graphMode;
+
+//Снимок графика для отрисовки
+typedef struct {
+    uint8_t columns[DHTMON_HISTORY_LEN]; //Строки экрана столбцов по ячейкам кольца истории
+    uint8_t first; //Ячейка самого старого отсчёта
+    uint8_t count; //Количество отсчётов
+    int16_t min; //Наименьшее значение в истории, десятые доли
+    int16_t max; //Наибольшее значение в истории
+    int16_t last; //Последнее значение, INT16_MIN - датчик не ответил
+} DHTMon_graph;
+
+typedef void (*DHTMon_historyCallback)(void* context);
+
+//Величины, вычисляемые по температуре и влажности
+typedef struct {
+    int16_t dewPoint; //Точка росы в десятых долях градуса
+    uint16_t absHum; //Абсолютная влажность в десятых долях г/м3
+    int16_t heatIndex; //Индекс жары (ощущаемая температура) в десятых долях градуса
+    bool valid; //Величины посчитаны по пригодным показаниям
+} DHTMon_metrics;
+
+//Величина, показываемая на главном экране
+typedef enum {
+    DHTMON_MONITOR_RAW, //Температура и влажность
+    DHTMON_MONITOR_DEW, //Точка росы
+    DHTMON_MONITOR_ABS, //Абсолютная влажность
+    DHTMON_MONITOR_HEAT, //Индекс жары
+    DHTMON_MONITOR_COUNT,
+} DHTMon_monitorView;
+
+//Показания датчика для отрисовки
+typedef struct {
+    char name[11]; //Имя датчика, чтобы отрисовка не обращалась к списку датчиков
+    DHT_data data; //Последние показания
+    DHTMon_metrics metrics; //Производные величины последних свежих показаний
+    uint8_t alarms; //Битовая маска сработавших тревог (DHT_alarm)
+} DHTMon_reading;
+
 typedef struct {
     const uint8_t num;
     const char* name;
@@ -74,10 +197,18 @@ typedef struct {
     bool last_OTG_State; //Состояние OTG до запуска приложения
     Storage* storage; //Хранилище датчиков
     Stream* file_stream; //Поток файла с датчиками
-    int8_t sensors_count; // Количество загруженных датчиков
-    DHT_sensor sensors[MAX_SENSORS]; //Сохранённые датчики
-    DHT_data data; //Инфа из датчика
-    DHT_sensor* currentSensorEdit; //Указатель на редактируемый датчик
+    int16_t sensors_count; // Количество загруженных датчиков
+    uint16_t sensors_capacity; //Количество датчиков, под которое выделена память
+    size_t sensor_memory; //Память на один датчик во всех модулях, байт
+    DHT_sensor* sensors; //Сохранённые датчики
+    FuriMutex* sensors_mutex; //Мутекс доступа к списку датчиков
+    FuriThread* poller_thread; //Поток опроса датчиков
+    FuriMutex* readings_mutex; //Мутекс снимка показаний
+    DHTMon_reading* readings; //Последние показания датчиков для отрисовки
+    uint16_t monitor_first; //Первый датчик, видимый на главном экране
+    DHTMon_monitorView monitor_view; //Величина, показываемая на главном экране
+    DHT_sensor* currentSensorEdit; //Указатель на выбранный датчик, NULL - добавление нового
+    DHT_sensor sensorEdit; //Копия редактируемого датчика. В список попадает только при сохранении
 
 } PluginData;
 
@@ -135,19 +266,42 @@ void DHTMon_sensors_deinit(void);
  * @return true Параметры датчика корректные
  * @return false Параметры датчика некорректные
  */
-bool DHTMon_sensor_check(DHT_sensor* sensor);
+bool DHTMon_sensor_check(const DHT_sensor* sensor);
 /**
- * @brief Удаление датчика из списка и перезагрузка
+ * @brief Добавление датчика в список
+ * @details Настраивается только порт нового датчика, файл датчиков сохраняется в фоне
+ * 
+ * @param sensor Параметры нового датчика
+ * @return true Датчик добавлен
+ * @return false Параметры неверны или список заполнен
+ */
+bool DHTMon_sensor_add(const DHT_sensor* sensor);
+/**
+ * @brief Изменение параметров датчика из списка
+ * @details Состояние опроса и история сохраняются, если не поменялись порт и тип.
+ * Файл датчиков сохраняется в фоне
+ * 
+ * @param sensor Указатель на датчик в списке
+ * @param config Новые параметры датчика
+ * @return true Параметры применены
+ * @return false Параметры неверны
+ */
+bool DHTMon_sensor_update(DHT_sensor* sensor, const DHT_sensor* config);
+/**
+ * @brief Удаление датчика из списка
+ * @details Следующие датчики сдвигаются вместе с показаниями и историей,
+ * файл датчиков сохраняется в фоне
  * 
  * @param sensor Указатель на удаляемый датчик
  */
 void DHTMon_sensor_delete(DHT_sensor* sensor);
 /**
- * @brief Сохранение датчиков на SD-карту
+ * @brief Сохранение датчиков на SD-карту через временный файл
+ * @details Выполняется потоком журнала, см. DHTMon_logger_requestSave
  * 
  * @return Количество сохранённых датчиков
  */
-uint8_t DHTMon_sensors_save(void);
+uint16_t DHTMon_sensors_save(void);
 /**
  * @brief Загрузка датчиков с SD-карты
  * 
@@ -156,12 +310,383 @@ uint8_t DHTMon_sensors_save(void);
  */
 bool DHTMon_sensors_load(void);
 /**
- * @brief Перезагрузка датчиков с SD-карты
+ * @brief Заказ записи ответа датчика при ближайшем опросе
+ * @details Датчик опрашивается сразу, как только позволит его минимальный интервал.
+ * Запись разбирается потоком опроса и сохраняется в фоне в DHTMON_WAVE_PATH
+ * 
+ * @param sensor Указатель на датчик в списке
+ * @return true Запись заказана
+ * @return false Предыдущая запись ещё не сохранена
+ */
+bool DHTMon_sensor_captureWave(DHT_sensor* sensor);
+
+/* ================== Опрос датчиков ================== */
+/**
+ * @brief Запуск потока опроса датчиков
+ */
+void DHTMon_poller_start(void);
+/**
+ * @brief Остановка потока опроса датчиков с ожиданием его завершения
+ */
+void DHTMon_poller_stop(void);
+/**
+ * @brief Перестроение очереди опроса после изменения списка датчиков
+ */
+void DHTMon_poller_reschedule(void);
+/**
+ * @brief Пересчёт времени сна потока опроса после изменения очереди опроса
+ */
+void DHTMon_poller_wake(void);
+/**
+ * @brief Копирование снимка показаний видимых датчиков
+ * 
+ * @param readings Массив на count элементов, куда будут скопированы показания
+ * @param first Индекс первого видимого датчика
+ * @param count Количество видимых датчиков
+ */
+void DHTMon_readings_get(DHTMon_reading* readings, uint16_t first, uint8_t count);
+
+/* ================== Производные величины ================== */
+/**
+ * @brief Расчёт точки росы, абсолютной влажности и индекса жары в фиксированной точке
+ * 
+ * @param data Показания датчика
+ * @param metrics Рассчитанные величины. Если показания непригодны, сбрасывается только valid
+ */
+void DHTMon_metrics_calc(const DHT_data* data, DHTMon_metrics* metrics);
+
+/* ================== Тревоги по порогам ================== */
+/**
+ * @brief Подготовка тревог
+ * 
+ * @param notifications Уведомления, через которые подаются сигналы тревоги
+ */
+void DHTMon_alarm_init(NotificationApp* notifications);
+/**
+ * @brief Освобождение памяти тревог и остановка мигания светодиода
+ */
+void DHTMon_alarm_free(void);
+/**
+ * @brief Изменение размера таблицы состояний тревог. Вызывается под мутексом списка датчиков
+ * 
+ * @param capacity Количество датчиков
+ * @return Память тревог на один датчик, байт
+ */
+size_t DHTMon_alarm_resize(uint16_t capacity);
+/**
+ * @brief Проверка свежих показаний по порогам датчика
+ * @details Вызывается потоком опроса сразу после получения показаний, поэтому работает
+ * при любом открытом экране. Тревога срабатывает и снимается, только если условие
+ * продержалось DHTMON_ALARM_HOLD, снимается после возврата за гистерезис.
+ * Время проверки не зависит от количества датчиков
+ * 
+ * @param index Индекс датчика в списке
+ * @param thresholds Пороги датчика
+ * @param data Показания датчика. Несвежие показания состояние не меняют
+ * @return Битовая маска сработавших тревог (DHT_alarm)
+ */
+uint8_t DHTMon_alarm_check(uint16_t index, const DHT_thresholds* thresholds, const DHT_data* data);
+/**
+ * @brief Снятие тревог датчика, например, после изменения его порогов
+ * 
+ * @param index Индекс датчика в списке
+ */
+void DHTMon_alarm_reset(uint16_t index);
+/**
+ * @brief Снятие тревог всех датчиков
+ */
+void DHTMon_alarm_resetAll(void);
+/**
+ * @brief Удаление тревог датчика со сдвигом следующих датчиков
+ * 
+ * @param index Индекс удалённого из списка датчика
+ */
+void DHTMon_alarm_remove(uint16_t index);
+
+/* ================== Запись ответа датчика ================== */
+/**
+ * @brief Заказ записи ответа датчика. Вызывается под мутексом списка датчиков
+ * 
+ * @param sensors Список датчиков. Запись, заказанная другому датчику, отменяется
+ * @param count Количество датчиков
+ * @param sensor Датчик, ответ которого нужно записать
+ * @return true Запись заказана
+ * @return false Предыдущая запись ещё не сохранена
+ */
+bool DHTMon_wave_arm(DHT_sensor* sensors, uint16_t count, DHT_sensor* sensor);
+/**
+ * @brief Разбор законченной записи. Вызывается потоком опроса после каждой пачки
+ * 
+ * @return true Появилась запись, которую нужно сохранить
+ */
+bool DHTMon_wave_collect(void);
+/**
+ * @brief Сохранение разобранной записи на SD-карту. Вызывается потоком журнала
+ * 
+ * @param storage Хранилище
+ */
+void DHTMon_wave_save(Storage* storage);
+/**
+ * @brief Состояние записи ответа
+ */
+DHTMon_waveState DHTMon_wave_state(void);
+/**
+ * @brief Имя датчика, ответ которого записывается
+ */
+const char* DHTMon_wave_sensorName(void);
+/**
+ * @brief Разбор последней сохранённой записи
+ * 
+ * @param report Разбор записи
+ * @return true Запись есть
+ */
+bool DHTMon_wave_report(DHTMon_waveReport* report);
+/**
+ * @brief Разбор записи: длительности импульсов и запас до порогов декодера
+ * @details Подтверждение датчика ищется по уровням линии, поэтому подходят записи
+ * обоих способов приёма и записи, прочитанные из файла
+ * 
+ * @param waveform Запись ответа
+ * @param report Разбор записи
+ */
+void DHTMon_wave_analyze(const DHT_waveform* waveform, DHTMon_waveReport* report);
+
+/* ================== Воспроизведение записей ================== */
+/**
+ * @brief Прогон встроенного набора эталонных ответов DHT11, ASAIR DHT11 и DHT22
+ * через декодер и конвертацию драйвера со сверкой результатов и замером скорости
+ * @details К датчикам не обращается, результат не зависит от подключённых датчиков
+ * 
+ * @param result Результат проверки
+ */
+void DHTMon_replay_run(DHTMon_replayResult* result);
+
+/* ================== Питание датчиков ================== */
+/**
+ * @brief Переключение режима экономии питания
+ * @details В режиме экономии 5V подаётся на датчики только на время опроса.
+ * Вызывается под мутексом списка датчиков, применяется потоком опроса
+ * 
+ * @param saver true - режим экономии, false - питание включено постоянно
+ */
+void DHTMon_power_setSaver(bool saver);
+/**
+ * @brief Включён ли режим экономии питания
+ */
+bool DHTMon_power_isSaver(void);
+/**
+ * @brief Подано ли питание на датчики
+ */
+bool DHTMon_power_isOn(void);
+/**
+ * @brief Подача питания на датчики с подъёмом линий данных
+ * 
+ * @param sensors Список датчиков
+ * @param count Количество датчиков
+ */
+void DHTMon_power_on(DHT_sensor* sensors, uint16_t count);
+/**
+ * @brief Отключение питания датчиков. Линии данных прижимаются к земле
+ * 
+ * @param sensors Список датчиков
+ * @param count Количество датчиков
+ */
+void DHTMon_power_off(DHT_sensor* sensors, uint16_t count);
+/**
+ * @brief Наибольшее среди датчиков время установления после подачи питания
+ * 
+ * @param sensors Список датчиков
+ * @param count Количество датчиков
+ * @return Время установления, мс
+ */
+uint32_t DHTMon_power_settle(DHT_sensor* sensors, uint16_t count);
+/**
+ * @brief Момент, с которого датчики готовы к опросу после подачи питания
+ * 
+ * @param sensors Список датчиков
+ * @param count Количество датчиков
+ * @return Время в тиках системы
+ */
+uint32_t DHTMon_power_readyTick(DHT_sensor* sensors, uint16_t count);
+/**
+ * @brief Доля времени, в течение которой датчики были запитаны в режиме экономии
+ * 
+ * @return Скважность в десятых долях процента. 1000 вне режима экономии
+ */
+uint16_t DHTMon_power_duty(void);
+
+/* ================== Планировщик опроса ================== */
+/**
+ * @brief Заполнение очереди опроса датчиками с разбросом времени первого опроса
+ * 
+ * @param count Количество датчиков
+ */
+void DHTMon_scheduler_reset(uint16_t count);
+/**
+ * @brief Добавление датчика в очередь опроса
+ * 
+ * @param index Индекс датчика в списке
+ * @param due Время, когда датчик нужно опросить
+ */
+void DHTMon_scheduler_push(uint16_t index, uint32_t due);
+/**
+ * @brief Время опроса ближайшего датчика
+ * 
+ * @param due Время ближайшего опроса
+ * @return true Очередь не пуста
+ * @return false В очереди нет датчиков
+ */
+bool DHTMon_scheduler_peek(uint32_t* due);
+/**
+ * @brief Извлечение из очереди датчика, которого пора опрашивать
+ * 
+ * @param now Текущее время
+ * @param index Индекс извлечённого датчика
+ * @return true Датчик извлечён
+ * @return false Опрашивать пока некого
+ */
+bool DHTMon_scheduler_popDue(uint32_t now, uint16_t* index);
+/**
+ * @brief Случайный сдвиг времени опроса
+ * 
+ * @return Сдвиг от 0 до DHTMON_POLL_JITTER, мс
+ */
+uint32_t DHTMon_scheduler_jitter(void);
+/**
+ * @brief Изменение времени опроса датчика, который уже есть в очереди
+ * 
+ * @param index Индекс датчика в списке
+ * @param due Новое время опроса
+ */
+void DHTMon_scheduler_update(uint16_t index, uint32_t due);
+/**
+ * @brief Удаление датчика из очереди со сдвигом индексов следующих датчиков
+ * 
+ * @param index Индекс удалённого из списка датчика
+ */
+void DHTMon_scheduler_remove(uint16_t index);
+/**
+ * @brief Изменение размера очереди опроса. Вызывается под мутексом списка датчиков
+ * 
+ * @param capacity Количество датчиков
+ * @return Память очереди на один датчик, байт
+ */
+size_t DHTMon_scheduler_resize(uint16_t capacity);
+/**
+ * @brief Освобождение памяти очереди опроса
+ */
+void DHTMon_scheduler_free(void);
+
+/* ================== История показаний ================== */
+/**
+ * @brief Выделение ресурсов истории показаний
+ */
+void DHTMon_history_init(void);
+/**
+ * @brief Освобождение ресурсов истории показаний
+ */
+void DHTMon_history_free(void);
+/**
+ * @brief Очистка истории всех датчиков
+ */
+void DHTMon_history_reset(void);
+/**
+ * @brief Добавление показаний в историю датчика
+ * 
+ * @param index Индекс датчика в списке
+ * @param data Показания. Неудачные попадают в историю как пропуск
+ */
+void DHTMon_history_push(uint16_t index, const DHT_data* data);
+/**
+ * @brief Выбор датчика для графика
+ * @details Минимум и максимум поддерживаются монотонными очередями только для
+ * этого датчика, каждый новый отсчёт обновляет один столбец графика
+ * 
+ * @param index Индекс датчика в списке
+ * @param mode Отображаемая величина
+ * @param callback Вызывается из потока опроса после добавления отсчёта
+ * @param context Контекст для callback
+ */
+void DHTMon_history_watch(
+    uint16_t index,
+    DHTMon_graphMode mode,
+    DHTMon_historyCallback callback,
+    void* context);
+/**
+ * @brief Прекращение построения графика
+ */
+void DHTMon_history_unwatch(void);
+/**
+ * @brief Копирование снимка графика
+ * 
+ * @param graph Снимок графика
+ * @return true В истории есть хотя бы одно удачное показание
+ */
+bool DHTMon_history_graph(DHTMon_graph* graph);
+/**
+ * @brief Удаление истории датчика со сдвигом истории следующих датчиков
+ * 
+ * @param index Индекс удалённого из списка датчика
+ */
+void DHTMon_history_remove(uint16_t index);
+/**
+ * @brief Изменение количества колец истории
  * 
- * @return true Когда был загружен хотя бы 1 датчик
- * @return false Ни один из датчиков не был загружен
+ * @param capacity Количество датчиков
+ * @return Память истории на один датчик, байт
  */
-bool DHTMon_sensors_reload(void);
+size_t DHTMon_history_resize(uint16_t capacity);
+
+/* ================== Журнал показаний ================== */
+/**
+ * @brief Запуск потока записи журнала на SD-карту
+ *
+ * @param storage Хранилище, в которое пишется журнал
+ */
+void DHTMon_logger_start(Storage* storage);
+/**
+ * @brief Выгрузка остатка буфера и остановка потока записи журнала
+ */
+void DHTMon_logger_stop(void);
+/**
+ * @brief Включение и выключение записи показаний в журнал
+ *
+ * @param enable true - писать показания в журнал
+ */
+void DHTMon_logger_enable(bool enable);
+/**
+ * @brief Состояние записи журнала
+ *
+ * @return true Показания пишутся в журнал
+ */
+bool DHTMon_logger_isEnabled(void);
+/**
+ * @brief Запрос преобразования журнала в CSV. Выполняется потоком записи журнала
+ */
+void DHTMon_logger_exportCsv(void);
+/**
+ * @brief Запрос сохранения списка датчиков. Выполняется потоком журнала
+ */
+void DHTMon_logger_requestSave(void);
+/**
+ * @brief Запрос сохранения записи ответа датчика. Выполняется потоком журнала
+ */
+void DHTMon_logger_requestWave(void);
+/**
+ * @brief Добавление показаний в блок журнала датчика. Не обращается к SD-карте
+ *
+ * @param index Индекс датчика в списке
+ * @param sensor Датчик, с которого получены показания
+ * @param data Показания
+ */
+void DHTMon_logger_add(uint16_t index, const DHT_sensor* sensor, const DHT_data* data);
+/**
+ * @brief Изменение количества открытых блоков журнала
+ * 
+ * @param capacity Количество датчиков
+ * @return Память журнала на один датчик, байт
+ */
+size_t DHTMon_logger_resize(uint16_t capacity);
 
 void scene_main(Canvas* const canvas, PluginData* app);
 void mainMenu_scene(PluginData* app);
@@ -173,4 +698,8 @@ void sensorEdit_sceneRemove(void);
 void sensorActions_sceneCreate(PluginData* app);
 void sensorActions_scene(PluginData* app);
 void sensorActions_screneRemove(void);
+
+void sensorGraph_sceneCreate(PluginData* app);
+void sensorGraph_scene(PluginData* app);
+void sensorGraph_sceneRemove(PluginData* app);
 #endif
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include <gui/view.h>
+#include "../quenon_dht_mon.h"
+
+//Модель вида графика
+typedef struct {
+    DHTMon_graphMode mode; //Отображаемая величина
+    uint16_t index; //Индекс датчика в списке
+} GraphModel;
+
+//Текущий вид
+static View* view;
+//Снимок графика для отрисовки. Используется только потоком GUI
+static DHTMon_graph graph;
+
+static const char* const graphNames[2] = {
+    "Temp, *C",
+    "Hum, %",
+};
+
+/**
+ * @brief Запрос перерисовки после появления нового отсчёта
+ *
+ * @param context Не используется
+ */
+static void graph_updateCallback(void* context) {
+    UNUSED(context);
+    view_get_model(view);
+    view_commit_model(view, true);
+}
+
+/**
+ * @brief Отрисовка графика
+ * @details Столбцы уже пересчитаны в строки экрана при добавлении отсчётов,
+ * здесь они только соединяются линиями
+ *
+ * @param canvas Указатель на холст
+ * @param model Модель вида
+ */
+static void graph_drawCallback(Canvas* canvas, void* model) {
+    GraphModel* graphModel = model;
+    canvas_clear(canvas);
+    canvas_set_font(canvas, FontSecondary);
+    if(!DHTMon_history_graph(&graph)) {
+        canvas_draw_str(canvas, 0, 8, graphNames[graphModel->mode]);
+        canvas_draw_str_aligned(canvas, 64, 38, AlignCenter, AlignCenter, "No data yet");
+        return;
+    }
+
+    //Заголовок: величина, последнее значение и диапазон истории
+    char str[32], last[8], min[8], max[8];
+    if(graph.last == INT16_MIN) {
+        strcpy(last, "--");
+    } else {
+        DHT_formatTenths(last, sizeof(last), graph.last);
+    }
+    DHT_formatTenths(min, sizeof(min), graph.min);
+    DHT_formatTenths(max, sizeof(max), graph.max);
+    canvas_draw_str(canvas, 0, 8, graphNames[graphModel->mode]);
+    snprintf(str, sizeof(str), "%s [%s..%s]", last, min, max);
+    canvas_draw_str_aligned(canvas, 128, 8, AlignRight, AlignBottom, str);
+
+    //Самый новый отсчёт у правого края экрана
+    uint8_t x = DHTMON_HISTORY_LEN - graph.count;
+    uint8_t prev = DHTMON_GRAPH_NONE;
+    for(uint8_t i = 0; i < graph.count; i++, x++) {
+        uint8_t row = graph.columns[(graph.first + i) & (DHTMON_HISTORY_LEN - 1)];
+        if(row != DHTMON_GRAPH_NONE) {
+            if(prev != DHTMON_GRAPH_NONE) {
+                canvas_draw_line(canvas, x - 1, prev, x, row);
+            } else {
+                canvas_draw_dot(canvas, x, row);
+            }
+        }
+        prev = row;
+    }
+}
+
+/**
+ * @brief Переключение величины кнопками влево и вправо
+ *
+ * @param event Событие кнопки
+ * @param context Не используется
+ * @return true Событие обработано
+ */
+static bool graph_inputCallback(InputEvent* event, void* context) {
+    UNUSED(context);
+    if(event->type != InputTypeShort ||
+       (event->key != InputKeyLeft && event->key != InputKeyRight)) {
+        return false;
+    }
+    GraphModel* model = view_get_model(view);
+    model->mode = model->mode == DHTMON_GRAPH_TEMP ? DHTMON_GRAPH_HUM : DHTMON_GRAPH_TEMP;
+    DHTMon_history_watch(model->index, model->mode, graph_updateCallback, NULL);
+    view_commit_model(view, true);
+    return true;
+}
+
+/**
+ * @brief Функция обработки нажатия кнопки "Назад"
+ *
+ * @param context Указатель на данные приложения
+ * @return ID вида в который нужно переключиться
+ */
+static uint32_t graph_exitCallback(void* context) {
+    UNUSED(context);
+    return SENSOR_ACTIONS_VIEW;
+}
+
+/**
+ * @brief Прекращение построения графика при уходе с вида
+ *
+ * @param context Не используется
+ */
+static void graph_leaveCallback(void* context) {
+    UNUSED(context);
+    DHTMon_history_unwatch();
+}
+
+/**
+ * @brief Создание вида графика показаний
+ *
+ * @param app Указатель на данные плагина
+ */
+void sensorGraph_sceneCreate(PluginData* app) {
+    view = view_alloc();
+    view_allocate_model(view, ViewModelTypeLocking, sizeof(GraphModel));
+    view_set_context(view, app);
+    view_set_draw_callback(view, graph_drawCallback);
+    view_set_input_callback(view, graph_inputCallback);
+    view_set_previous_callback(view, graph_exitCallback);
+    view_set_exit_callback(view, graph_leaveCallback);
+    view_dispatcher_add_view(app->view_dispatcher, GRAPH_VIEW, view);
+}
+
+/**
+ * @brief Показ графика редактируемого датчика
+ *
+ * @param app Указатель на данные плагина
+ */
+void sensorGraph_scene(PluginData* app) {
+    GraphModel* model = view_get_model(view);
+    model->mode = DHTMON_GRAPH_TEMP;
+    model->index = app->currentSensorEdit - app->sensors;
+    DHTMon_history_watch(model->index, model->mode, graph_updateCallback, NULL);
+    view_commit_model(view, false);
+    view_dispatcher_switch_to_view(app->view_dispatcher, GRAPH_VIEW);
+}
+
+void sensorGraph_sceneRemove(PluginData* app) {
+    view_dispatcher_remove_view(app->view_dispatcher, GRAPH_VIEW);
+    view_free(view);
+}
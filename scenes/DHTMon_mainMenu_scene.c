@@ -4,6 +4,23 @@ static View* view;
 //Список
 static VariableItemList* variable_item_list;
 
+//Индекс пункта выгрузки журнала в CSV
+static uint32_t exportIndex;
+//Индекс пункта проверки декодера
+static uint32_t selfTestIndex;
+//Текст результата проверки декодера
+static char selfTestText[160];
+
+static const char* const loggingNames[2] = {
+    "Off",
+    "On",
+};
+
+static const char* const powerNames[2] = {
+    "Always on",
+    "Saver",
+};
+
 /**
  * @brief Функция обработки нажатия кнопки "Назад"
  * 
@@ -16,6 +33,41 @@ static uint32_t actions_exitCallback(void* context) {
     //Возвращаем ID вида, в который нужно вернуться
     return VIEW_NONE;
 }
+/**
+ * @brief Возврат из результата проверки декодера в меню
+ */
+static uint32_t selfTest_exitCallback(void* context) {
+    UNUSED(context);
+    return MAIN_MENU_VIEW;
+}
+
+/**
+ * @brief Проверка декодера на встроенных записях ответов и показ результата
+ * 
+ * @param app Указатель на данные плагина
+ */
+static void selfTest_widget(PluginData* app) {
+    DHTMon_replayResult result;
+    DHTMon_replay_run(&result);
+    snprintf(
+        selfTestText,
+        sizeof(selfTestText),
+        "\e#Decoder self-test\e#\nFrames: %u/%u OK\nTraces: %u/%u OK\n%s%s\n"
+        "Frames/s: %lu\nTraces/s: %lu",
+        result.framesPassed,
+        result.frames,
+        result.tracesPassed,
+        result.traces,
+        result.failed != NULL ? "Failed: " : "All passed",
+        result.failed != NULL ? result.failed : "",
+        result.frameRate,
+        result.traceRate);
+    widget_reset(app->widget);
+    widget_add_text_scroll_element(app->widget, 0, 0, 128, 64, selfTestText);
+    view_set_previous_callback(widget_get_view(app->widget), selfTest_exitCallback);
+    view_dispatcher_switch_to_view(app->view_dispatcher, WIDGET_VIEW);
+}
+
 /**
  * @brief Функция обработки нажатия средней кнопки
  * 
@@ -24,17 +76,53 @@ static uint32_t actions_exitCallback(void* context) {
  */
 static void enterCallback(void* context, uint32_t index) {
     PluginData* app = context;
-    if((uint8_t)index < (uint8_t)app->sensors_count) {
+    if(index < (uint32_t)app->sensors_count) {
         app->currentSensorEdit = &app->sensors[index];
         sensorActions_scene(app);
     }
-    if((uint8_t)index == (uint8_t)app->sensors_count) {
-        app->currentSensorEdit = &app->sensors[app->sensors_count++];
-        strcpy(app->currentSensorEdit->name, "NewSensor");
-        app->currentSensorEdit->GPIO = DHTMon_GPIO_from_index(0);
-        app->currentSensorEdit->type = DHT11;
+    if(index == (uint32_t)app->sensors_count) {
+        //Новый датчик попадёт в список только при сохранении
+        app->currentSensorEdit = NULL;
         sensorEdit_scene(app);
     }
+    if(index == exportIndex) {
+        DHTMon_logger_exportCsv();
+    }
+    if(index == selfTestIndex) {
+        selfTest_widget(app);
+    }
+}
+
+/**
+ * @brief Переключение записи журнала показаний
+ * 
+ * @param item Указатель на элемент списка
+ */
+static void loggingChanged(VariableItem* item) {
+    uint8_t index = variable_item_get_current_value_index(item);
+    variable_item_set_current_value_text(item, loggingNames[index]);
+    DHTMon_logger_enable(index == 1);
+}
+
+/**
+ * @brief Переключение режима питания датчиков
+ * @details В режиме экономии датчики запитываются только на время опроса,
+ * а подсветка гаснет как обычно
+ * 
+ * @param item Указатель на элемент списка
+ */
+static void powerChanged(VariableItem* item) {
+    PluginData* app = variable_item_get_context(item);
+    uint8_t index = variable_item_get_current_value_index(item);
+    variable_item_set_current_value_text(item, powerNames[index]);
+    furi_mutex_acquire(app->sensors_mutex, FuriWaitForever);
+    DHTMon_power_setSaver(index == 1);
+    furi_mutex_release(app->sensors_mutex);
+    DHTMon_poller_wake();
+    notification_message(
+        app->notifications,
+        index == 1 ? &sequence_display_backlight_enforce_auto :
+                     &sequence_display_backlight_enforce_on);
 }
 
 /**
@@ -47,12 +135,26 @@ void mainMenu_scene(PluginData* app) {
     //Сброс всех элементов меню
     variable_item_list_reset(variable_item_list);
     //Добавление названий датчиков в качестве элементов списка
-    for(uint8_t i = 0; i < app->sensors_count; i++) {
+    for(uint16_t i = 0; i < app->sensors_count; i++) {
         variable_item_list_add(variable_item_list, app->sensors[i].name, 1, NULL, NULL);
     }
-    if(app->sensors_count < (uint8_t)MAX_SENSORS) {
-        variable_item_list_add(variable_item_list, "       + Add new sensor +", 1, NULL, NULL);
-    }
+    variable_item_list_add(variable_item_list, "       + Add new sensor +", 1, NULL, NULL);
+    //Запись показаний в журнал на SD-карте
+    app->item = variable_item_list_add(variable_item_list, "Logging:", 2, loggingChanged, app);
+    uint8_t logging = DHTMon_logger_isEnabled() ? 1 : 0;
+    variable_item_set_current_value_index(app->item, logging);
+    variable_item_set_current_value_text(app->item, loggingNames[logging]);
+    //Питание датчиков
+    app->item = variable_item_list_add(variable_item_list, "Power:", 2, powerChanged, app);
+    uint8_t saver = DHTMon_power_isSaver() ? 1 : 0;
+    variable_item_set_current_value_index(app->item, saver);
+    variable_item_set_current_value_text(app->item, powerNames[saver]);
+    //Преобразование журнала в CSV для просмотра на компьютере
+    exportIndex = app->sensors_count + 3;
+    variable_item_list_add(variable_item_list, "Export log to CSV", 1, NULL, NULL);
+    //Прогон эталонных ответов через декодер
+    selfTestIndex = app->sensors_count + 4;
+    variable_item_list_add(variable_item_list, "Decoder self-test", 1, NULL, NULL);
 
     //Добавление колбека на нажатие средней кнопки
     variable_item_list_set_enter_callback(variable_item_list, enterCallback, app);
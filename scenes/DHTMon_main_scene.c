@@ -1,5 +1,56 @@
+#include <gui/elements.h>
 #include "../quenon_dht_mon.h"
 
+/**
+ * @brief Текст ошибки опроса датчика
+ * 
+ * @param status Состояние показаний
+ * @return Строка для вывода вместо показаний
+ */
+static const char* scene_main_errorText(uint8_t status) {
+    switch(status) {
+    case DHT_CHECKSUM_ERROR:
+        return "crc err";
+    case DHT_OUT_OF_RANGE:
+        return "range";
+    default:
+        return "timeout";
+    }
+}
+
+/**
+ * @brief Печать выбранной производной величины в буфер строк
+ * 
+ * @param app Указатель на данные плагина
+ * @param reading Показания датчика
+ */
+static void scene_main_metric(PluginData* app, const DHTMon_reading* reading) {
+    const DHTMon_metrics* metrics = &reading->metrics;
+    if(!metrics->valid) {
+        snprintf(app->txtbuff, sizeof(app->txtbuff), "--");
+        return;
+    }
+    const char* prefix = "dp ";
+    int16_t value = metrics->dewPoint;
+    const char* unit = "*C";
+    if(app->monitor_view == DHTMON_MONITOR_ABS) {
+        prefix = "ah ";
+        value = metrics->absHum;
+        unit = "g/m3";
+    } else if(app->monitor_view == DHTMON_MONITOR_HEAT) {
+        prefix = "hi ";
+        value = metrics->heatIndex;
+    }
+    uint8_t len = snprintf(app->txtbuff, sizeof(app->txtbuff), "%s", prefix);
+    len += DHT_formatTenths(app->txtbuff + len, sizeof(app->txtbuff) - len, value);
+    snprintf(
+        app->txtbuff + len,
+        sizeof(app->txtbuff) - len,
+        "%s%s",
+        unit,
+        reading->data.status == DHT_STALE ? "?" : "");
+}
+
 /* ============== Главный экран ============== */
 void scene_main(Canvas* const canvas, PluginData* app) {
     //Рисование бара
@@ -7,31 +58,54 @@ void scene_main(Canvas* const canvas, PluginData* app) {
     canvas_set_color(canvas, ColorWhite);
     canvas_set_font(canvas, FontPrimary);
     canvas_draw_str(canvas, 32, 11, "DHT Monitor");
+    //Доля времени с питанием датчиков в режиме экономии
+    if(DHTMon_power_isSaver()) {
+        canvas_set_font(canvas, FontSecondary);
+        snprintf(app->txtbuff, sizeof(app->txtbuff), "%u%%", (DHTMon_power_duty() + 5) / 10);
+        canvas_draw_str_aligned(canvas, 126, 11, AlignRight, AlignBottom, app->txtbuff);
+    }
 
     canvas_set_color(canvas, ColorBlack);
     if(app->sensors_count > 0) {
-        if(!furi_hal_power_is_otg_enabled()) {
-            furi_hal_power_enable_otg();
-        }
-        for(uint8_t i = 0; i < app->sensors_count; i++) {
-            app->data = DHT_getData(&app->sensors[i]);
+        //После удаления датчиков окно может оказаться за концом списка
+        uint16_t count = app->sensors_count;
+        uint16_t last = count > DHTMON_MONITOR_ROWS ? count - DHTMON_MONITOR_ROWS : 0;
+        if(app->monitor_first > last) app->monitor_first = last;
 
+        //Опрос идёт в отдельном потоке, здесь только копия показаний видимых строк
+        DHTMon_reading readings[DHTMON_MONITOR_ROWS];
+        uint8_t rows = MIN(count - app->monitor_first, DHTMON_MONITOR_ROWS);
+        DHTMon_readings_get(readings, app->monitor_first, rows);
+        for(uint8_t i = 0; i < rows; i++) {
             canvas_set_font(canvas, FontPrimary);
-            canvas_draw_str(canvas, 0, 24 + 10 * i, app->sensors[i].name);
+            canvas_draw_str(canvas, 0, 24 + 10 * i, readings[i].name);
+
+            //Отметка сработавшей тревоги
+            if(readings[i].alarms) canvas_draw_str(canvas, 58, 24 + 10 * i, "!");
 
             canvas_set_font(canvas, FontSecondary);
-            if(app->data.hum == -128.0f && app->data.temp == -128.0f) {
-                canvas_draw_str(canvas, 96, 24 + 10 * i, "timeout");
-            } else {
+            const DHT_data* data = &readings[i].data;
+            if(!DHT_isValid(data)) {
+                canvas_draw_str(canvas, 96, 24 + 10 * i, scene_main_errorText(data->status));
+            } else if(app->monitor_view == DHTMON_MONITOR_RAW) {
+                uint8_t len = DHT_formatTenths(app->txtbuff, sizeof(app->txtbuff), data->temp);
+                //Знак вопроса - прежние показания, свежий ответ был повреждён
                 snprintf(
-                    app->txtbuff,
-                    sizeof(app->txtbuff),
-                    "%2.1f*C/%d%%",
-                    (double)app->data.temp,
-                    (int8_t)app->data.hum);
+                    app->txtbuff + len,
+                    sizeof(app->txtbuff) - len,
+                    "*C/%d%%%s",
+                    data->hum / 10,
+                    data->status == DHT_STALE ? "?" : "");
+                canvas_draw_str(canvas, 64, 24 + 10 * i, app->txtbuff);
+            } else {
+                scene_main_metric(app, &readings[i]);
                 canvas_draw_str(canvas, 64, 24 + 10 * i, app->txtbuff);
             }
         }
+        //Полоса прокрутки, если датчики не помещаются на экран
+        if(count > DHTMON_MONITOR_ROWS) {
+            elements_scrollbar_pos(canvas, 128, 15, 49, app->monitor_first, last + 1);
+        }
     } else {
         canvas_set_font(canvas, FontSecondary);
         if(app->sensors_count == 0) canvas_draw_str(canvas, 0, 24, "Sensors not found");
@@ -46,11 +46,157 @@ static void sensorInfo_widget(PluginData* app) {
     char str[32];
     snprintf(str, sizeof(str), "\e#%s\e#", app->currentSensorEdit->name);
     widget_add_text_box_element(app->widget, 0, 0, 128, 23, AlignCenter, AlignCenter, str, false);
-    snprintf(str, sizeof(str), "\e#Type:\e# %s", app->currentSensorEdit->type ? "DHT22" : "DHT11");
+    const DHT_driver* driver = DHT_getDriver(app->currentSensorEdit->type);
+    snprintf(
+        str,
+        sizeof(str),
+        "\e#Type:\e# %s, %u s min",
+        driver->name,
+        driver->minInterval / 1000);
     widget_add_text_box_element(app->widget, 0, 0, 128, 47, AlignLeft, AlignCenter, str, false);
     snprintf(
         str, sizeof(str), "\e#GPIO:\e# %s", DHTMon_GPIO_getName(app->currentSensorEdit->GPIO));
     widget_add_text_box_element(app->widget, 0, 0, 128, 72, AlignLeft, AlignCenter, str, false);
+
+    //Производные величины по последним свежим показаниям
+    uint16_t index = app->currentSensorEdit - app->sensors;
+    furi_mutex_acquire(app->readings_mutex, FuriWaitForever);
+    DHTMon_metrics metrics = app->readings[index].metrics;
+    furi_mutex_release(app->readings_mutex);
+    if(metrics.valid) {
+        char dew[8], abs[8], heat[8];
+        DHT_formatTenths(dew, sizeof(dew), metrics.dewPoint);
+        DHT_formatTenths(abs, sizeof(abs), metrics.absHum);
+        DHT_formatTenths(heat, sizeof(heat), metrics.heatIndex);
+        snprintf(str, sizeof(str), "Dp %s AH %s HI %s", dew, abs, heat);
+    } else {
+        snprintf(str, sizeof(str), "Dp -- AH -- HI --");
+    }
+    widget_add_text_box_element(app->widget, 0, 0, 128, 96, AlignLeft, AlignCenter, str, false);
+    view_set_previous_callback(widget_get_view(app->widget), infoWidget_exitCallback);
+    view_dispatcher_switch_to_view(app->view_dispatcher, WIDGET_VIEW);
+}
+
+/* ================== Диагностика опроса ================== */
+//Текст экрана диагностики
+static char diagText[512];
+
+static void sensorDiag_widget(PluginData* app);
+
+/**
+ * @brief Обработчик нажатий на кнопку в виджете
+ * 
+ * @param result Какая из кнопок была нажата
+ * @param type Тип нажатия
+ * @param context Указатель на данные плагина
+ */
+static void diagWidget_callback(GuiButtonType result, InputType type, void* context) {
+    PluginData* app = context;
+    if(type != InputTypeShort) return;
+    //Коротко нажата левая кнопка (Back)
+    if(result == GuiButtonTypeLeft) {
+        view_dispatcher_switch_to_view(app->view_dispatcher, SENSOR_ACTIONS_VIEW);
+    }
+    //Коротко нажата правая кнопка (Reset) - счётчики начинаются заново
+    if(result == GuiButtonTypeRight) {
+        furi_mutex_acquire(app->sensors_mutex, FuriWaitForever);
+        memset(&app->currentSensorEdit->stats, 0, sizeof(DHT_stats));
+        furi_mutex_release(app->sensors_mutex);
+        sensorDiag_widget(app);
+    }
+    //Коротко нажата центральная кнопка - заказ записи ответа датчика. Пока ответ
+    //не записан, повторное нажатие заказывает запись заново и обновляет экран
+    if(result == GuiButtonTypeCenter) {
+        DHTMon_sensor_captureWave(app->currentSensorEdit);
+        sensorDiag_widget(app);
+    }
+}
+
+/**
+ * @brief Печать состояния записи ответа датчика в конец текста диагностики
+ * 
+ * @param len Длина уже напечатанного текста
+ */
+static void sensorDiag_waveText(size_t len) {
+    if(len >= sizeof(diagText)) return;
+    char* str = diagText + len;
+    size_t size = sizeof(diagText) - len;
+    DHTMon_waveState state = DHTMon_wave_state();
+    DHTMon_waveReport report;
+    if(state == DHTMON_WAVE_IDLE) {
+        snprintf(str, size, "\nWave: press Wave to capture");
+    } else if(state == DHTMON_WAVE_ARMED || state == DHTMON_WAVE_CAPTURED) {
+        snprintf(str, size, "\nWave: waiting for %s", DHTMon_wave_sensorName());
+    } else if(DHTMon_wave_report(&report)) {
+        //Запас до порога в мкс: отрицательный - бит уже декодируется неверно
+        snprintf(
+            str,
+            size,
+            "\nWave of %s: %s\nBits: %u, ack %u/%u us\nZero %u us, margin %d\n"
+            "One %u us, margin %d\nTimeout margin: %d us",
+            DHTMon_wave_sensorName(),
+            state == DHTMON_WAVE_SAVED ? "saved" : "not saved",
+            report.bits,
+            report.ackLow,
+            report.ackHigh,
+            report.zeroMax,
+            report.zeroMargin,
+            report.oneMax > 0 ? report.oneMin : 0,
+            report.oneMargin,
+            report.timeoutMargin);
+    }
+}
+
+/**
+ * @brief Создание виджета со счётчиками опроса датчика
+ * 
+ * @param app Указатель на данные плагина
+ */
+static void sensorDiag_widget(PluginData* app) {
+    //Снимок датчика, чтобы не держать мутекс опроса во время печати
+    furi_mutex_acquire(app->sensors_mutex, FuriWaitForever);
+    DHT_sensor sensor = *app->currentSensorEdit;
+    furi_mutex_release(app->sensors_mutex);
+    const DHT_stats* stats = &sensor.stats;
+
+    char okRate[8] = "--";
+    if(stats->polls > 0) {
+        DHT_formatTenths(okRate, sizeof(okRate), (uint64_t)stats->ok * 1000 / stats->polls);
+    }
+    uint32_t frames = stats->ok + stats->checksumErrors + stats->rangeErrors;
+    int len = snprintf(
+        diagText,
+        sizeof(diagText),
+        "\e#%s\e#\nPolls: %lu, OK %s%%\nCRC errors: %lu\nOut of range: %lu\n"
+        "Timeouts: %lu/%lu/%lu/%lu\n(release/response/ack/data)\nRetries: %lu\n"
+        "Read: %u/%lu/%u us\n(min/avg/max)\nIRQ off: %u us max\nInterval now: %lu ms",
+        sensor.name,
+        stats->polls,
+        okRate,
+        stats->checksumErrors,
+        stats->rangeErrors,
+        stats->timeouts[DHT_PHASE_RELEASE],
+        stats->timeouts[DHT_PHASE_RESPONSE],
+        stats->timeouts[DHT_PHASE_ACK],
+        stats->timeouts[DHT_PHASE_DATA],
+        stats->retries,
+        stats->timeMin,
+        frames > 0 ? stats->timeSum / frames : 0,
+        stats->timeMax,
+        stats->irqMax,
+        DHT_getInterval(&sensor));
+    if(len > 0) sensorDiag_waveText(len);
+
+    widget_reset(app->widget);
+    widget_add_text_scroll_element(app->widget, 0, 0, 128, 50, diagText);
+    widget_add_button_element(app->widget, GuiButtonTypeLeft, "Back", diagWidget_callback, app);
+    widget_add_button_element(app->widget, GuiButtonTypeRight, "Reset", diagWidget_callback, app);
+    widget_add_button_element(
+        app->widget,
+        GuiButtonTypeCenter,
+        DHTMon_wave_state() == DHTMON_WAVE_ARMED ? "Refresh" : "Wave",
+        diagWidget_callback,
+        app);
     view_set_previous_callback(widget_get_view(app->widget), infoWidget_exitCallback);
     view_dispatcher_switch_to_view(app->view_dispatcher, WIDGET_VIEW);
 }
@@ -111,7 +257,7 @@ static void sensorDelete_widget(PluginData* app) {
         delete_str,
         sizeof(delete_str),
         "\e#Type:\e# %s",
-        app->currentSensorEdit->type ? "DHT22" : "DHT11");
+        DHT_getDriver(app->currentSensorEdit->type)->name);
     widget_add_text_box_element(
         app->widget, 0, 0, 128, 47, AlignLeft, AlignCenter, delete_str, false);
     snprintf(
@@ -138,9 +284,15 @@ static void enterCallback(void* context, uint32_t index) {
         sensorInfo_widget(app);
     }
     if(index == 1) {
-        sensorEdit_scene(app);
+        sensorGraph_scene(app);
     }
     if(index == 2) {
+        sensorDiag_widget(app);
+    }
+    if(index == 3) {
+        sensorEdit_scene(app);
+    }
+    if(index == 4) {
         sensorDelete_widget(app);
     }
 }
@@ -169,6 +321,8 @@ void sensorActions_sceneCreate(PluginData* app) {
     variable_item_list_reset(variable_item_list);
     //Добавление элементов в список
     variable_item_list_add(variable_item_list, "Info", 0, NULL, NULL);
+    variable_item_list_add(variable_item_list, "Graph", 0, NULL, NULL);
+    variable_item_list_add(variable_item_list, "Diagnostics", 0, NULL, NULL);
     variable_item_list_add(variable_item_list, "Edit", 0, NULL, NULL);
     variable_item_list_add(variable_item_list, "Delete", 0, NULL, NULL);
 
@@ -3,42 +3,171 @@
 static VariableItem* nameItem;
 static VariableItemList* variable_item_list;
 
-static const char* const sensorsTypes[2] = {
-    "DHT11",
-    "DHT22",
-};
+//Варианты интервала опроса, с. 0 - минимальный для типа датчика
+#define INTERVALS_COUNT 7
+static const uint16_t intervalsValues[INTERVALS_COUNT] = {0, 5, 10, 30, 60, 300, 600};
+static const char* const intervalsNames[INTERVALS_COUNT] =
+    {"Auto", "5 s", "10 s", "30 s", "1 min", "5 min", "10 min"};
+
+//Варианты порогов тревог в целых градусах и процентах. Нулевой вариант - порог выключен
+#define TEMP_LIMIT_MIN -40
+#define TEMP_LIMIT_MAX 80
+#define HUM_LIMIT_MIN 0
+#define HUM_LIMIT_MAX 100
+//Пункты порогов в меню по типам тревог (DHT_alarm)
+static const char* const thresholdsNames[DHT_ALARMS_COUNT] =
+    {"Temp low:", "Temp high:", "Hum low:", "Hum high:"};
+
+//Значения из файла, которых нет среди вариантов меню. Показываются последним вариантом,
+//чтобы сохранение без изменений не округляло их
+static uint32_t customInterval; //Интервал опроса, мс. 0 - заданный интервал есть в меню
+static int16_t customLimits[DHT_ALARMS_COUNT]; //Пороги в десятых долях
+static uint8_t customMask; //Битовая маска порогов с особым значением (DHT_alarm)
 
 // /* ============== Добавление датчика ============== */
 static uint32_t addSensor_exitCallback(void* context) {
     UNUSED(context);
-    DHTMon_sensors_reload();
+    //Изменения были только в копии датчика, список не тронут
     return VIEW_NONE;
 }
 
 static void addSensor_sensorTypeChanged(VariableItem* item) {
     uint8_t index = variable_item_get_current_value_index(item);
     PluginData* app = variable_item_get_context(item);
-    variable_item_set_current_value_text(item, sensorsTypes[index]);
-    app->currentSensorEdit->type = index;
+    variable_item_set_current_value_text(item, DHT_getDriver(index)->name);
+    app->sensorEdit.type = index;
 }
 
 static void addSensor_GPIOChanged(VariableItem* item) {
     uint8_t index = variable_item_get_current_value_index(item);
     variable_item_set_current_value_text(item, DHTMon_GPIO_getName(DHTMon_GPIO_from_index(index)));
     PluginData* app = variable_item_get_context(item);
-    app->currentSensorEdit->GPIO = DHTMon_GPIO_from_index(index);
+    app->sensorEdit.GPIO = DHTMon_GPIO_from_index(index);
+}
+
+/**
+ * @brief Печать варианта интервала опроса в пункт меню
+ * 
+ * @param item Пункт меню
+ * @param index Номер варианта, INTERVALS_COUNT - интервал из файла
+ */
+static void addSensor_intervalText(VariableItem* item, uint8_t index) {
+    char str[16];
+    if(index < INTERVALS_COUNT) {
+        variable_item_set_current_value_text(item, intervalsNames[index]);
+        return;
+    }
+    snprintf(str, sizeof(str), "%lu s", customInterval / 1000);
+    variable_item_set_current_value_text(item, str);
+}
+
+static void addSensor_intervalChanged(VariableItem* item) {
+    uint8_t index = variable_item_get_current_value_index(item);
+    PluginData* app = variable_item_get_context(item);
+    addSensor_intervalText(item, index);
+    app->sensorEdit.pollingInterval =
+        index < INTERVALS_COUNT ? intervalsValues[index] * 1000 : customInterval;
+}
+
+/**
+ * @brief Наименьший порог тревоги, доступный в меню
+ * 
+ * @param alarm Тип тревоги (DHT_alarm)
+ * @return Порог в целых градусах или процентах
+ */
+static int16_t addSensor_thresholdMin(uint8_t alarm) {
+    return alarm <= DHT_ALARM_TEMP_HIGH ? TEMP_LIMIT_MIN : HUM_LIMIT_MIN;
+}
+
+/**
+ * @brief Номер варианта порога, заданного в файле, за всеми вариантами меню
+ * 
+ * @param alarm Тип тревоги (DHT_alarm)
+ * @return Номер варианта
+ */
+static uint8_t addSensor_thresholdCustom(uint8_t alarm) {
+    int16_t max = alarm <= DHT_ALARM_TEMP_HIGH ? TEMP_LIMIT_MAX : HUM_LIMIT_MAX;
+    return max - addSensor_thresholdMin(alarm) + 2;
+}
+
+/**
+ * @brief Печать варианта порога тревоги в пункт меню
+ * 
+ * @param item Пункт меню
+ * @param alarm Тип тревоги (DHT_alarm)
+ * @param index Номер варианта, 0 - порог выключен
+ */
+static void addSensor_thresholdText(VariableItem* item, uint8_t alarm, uint8_t index) {
+    char str[12];
+    if(index == 0) {
+        variable_item_set_current_value_text(item, "Off");
+        return;
+    }
+    if(index == addSensor_thresholdCustom(alarm)) {
+        uint8_t len = DHT_formatTenths(str, sizeof(str) - 2, customLimits[alarm]);
+        strcpy(str + len, alarm <= DHT_ALARM_TEMP_HIGH ? "*C" : "%");
+        variable_item_set_current_value_text(item, str);
+        return;
+    }
+    snprintf(
+        str,
+        sizeof(str),
+        alarm <= DHT_ALARM_TEMP_HIGH ? "%d*C" : "%d%%",
+        addSensor_thresholdMin(alarm) + index - 1);
+    variable_item_set_current_value_text(item, str);
+}
+
+/**
+ * @brief Применение выбранного порога тревоги к копии датчика
+ * 
+ * @param item Пункт меню
+ * @param alarm Тип тревоги (DHT_alarm)
+ */
+static void addSensor_thresholdChanged(VariableItem* item, uint8_t alarm) {
+    uint8_t index = variable_item_get_current_value_index(item);
+    PluginData* app = variable_item_get_context(item);
+    addSensor_thresholdText(item, alarm, index);
+    DHT_thresholds* thresholds = &app->sensorEdit.thresholds;
+    if(index == 0) {
+        thresholds->enabled &= ~(1 << alarm);
+    } else if(index == addSensor_thresholdCustom(alarm)) {
+        thresholds->enabled |= 1 << alarm;
+        thresholds->limit[alarm] = customLimits[alarm];
+    } else {
+        thresholds->enabled |= 1 << alarm;
+        thresholds->limit[alarm] = (addSensor_thresholdMin(alarm) + index - 1) * 10;
+    }
 }
 
+static void addSensor_tempLowChanged(VariableItem* item) {
+    addSensor_thresholdChanged(item, DHT_ALARM_TEMP_LOW);
+}
+static void addSensor_tempHighChanged(VariableItem* item) {
+    addSensor_thresholdChanged(item, DHT_ALARM_TEMP_HIGH);
+}
+static void addSensor_humLowChanged(VariableItem* item) {
+    addSensor_thresholdChanged(item, DHT_ALARM_HUM_LOW);
+}
+static void addSensor_humHighChanged(VariableItem* item) {
+    addSensor_thresholdChanged(item, DHT_ALARM_HUM_HIGH);
+}
+static const VariableItemChangeCallback thresholdsCallbacks[DHT_ALARMS_COUNT] = {
+    addSensor_tempLowChanged,
+    addSensor_tempHighChanged,
+    addSensor_humLowChanged,
+    addSensor_humHighChanged,
+};
+
 static void addSensor_sensorNameChanged(void* context) {
     PluginData* app = context;
-    variable_item_set_current_value_text(nameItem, app->currentSensorEdit->name);
+    variable_item_set_current_value_text(nameItem, app->sensorEdit.name);
     view_dispatcher_switch_to_view(app->view_dispatcher, ADDSENSOR_MENU_VIEW);
 }
 static void addSensor_sensorNameChange(PluginData* app) {
     text_input_set_header_text(app->text_input, "Sensor name");
     //По неясной мне причине в длину строки входит терминатор. Поэтому при длине 10 приходится указывать 11
     text_input_set_result_callback(
-        app->text_input, addSensor_sensorNameChanged, app, app->currentSensorEdit->name, 11, true);
+        app->text_input, addSensor_sensorNameChanged, app, app->sensorEdit.name, 11, true);
     view_dispatcher_switch_to_view(app->view_dispatcher, TEXTINPUT_VIEW);
 }
 
@@ -47,10 +176,12 @@ static void addSensor_enterCallback(void* context, uint32_t index) {
     if(index == 0) {
         addSensor_sensorNameChange(app);
     }
-    if(index == 3) {
-        //Сохранение датчика
-        DHTMon_sensors_save();
-        DHTMon_sensors_reload();
+    if(index == 4 + DHT_ALARMS_COUNT) {
+        //Применение копии к списку датчиков. Файл сохраняется в фоне
+        bool saved = app->currentSensorEdit == NULL ?
+                         DHTMon_sensor_add(&app->sensorEdit) :
+                         DHTMon_sensor_update(app->currentSensorEdit, &app->sensorEdit);
+        if(!saved) FURI_LOG_W(APP_NAME, "Sensor [%s] not saved\r\n", app->sensorEdit.name);
         view_dispatcher_switch_to_view(app->view_dispatcher, VIEW_NONE);
     }
 }
@@ -69,28 +200,81 @@ void sensorEdit_sceneCreate(PluginData* app) {
     view_dispatcher_add_view(app->view_dispatcher, ADDSENSOR_MENU_VIEW, app->view);
 }
 void sensorEdit_scene(PluginData* app) {
+    //Редактируется копия датчика, чтобы поток опроса не видел недоделанных изменений
+    if(app->currentSensorEdit == NULL) {
+        memset(&app->sensorEdit, 0, sizeof(DHT_sensor));
+        strcpy(app->sensorEdit.name, "NewSensor");
+        app->sensorEdit.GPIO = DHTMon_GPIO_from_index(0);
+        app->sensorEdit.type = DHT11;
+    } else {
+        furi_mutex_acquire(app->sensors_mutex, FuriWaitForever);
+        app->sensorEdit = *app->currentSensorEdit;
+        furi_mutex_release(app->sensors_mutex);
+    }
+
     //Очистка списка
     variable_item_list_reset(variable_item_list);
 
     //Имя редактируемого датчика
     nameItem = variable_item_list_add(variable_item_list, "Name: ", 1, NULL, NULL);
     variable_item_set_current_value_index(nameItem, 0);
-    variable_item_set_current_value_text(nameItem, app->currentSensorEdit->name);
+    variable_item_set_current_value_text(nameItem, app->sensorEdit.name);
 
-    //Тип датчика
-    app->item =
-        variable_item_list_add(variable_item_list, "Type:", 2, addSensor_sensorTypeChanged, app);
+    //Тип датчика. Варианты - все известные драйверу типы
+    app->item = variable_item_list_add(
+        variable_item_list, "Type:", DHT_TYPES_COUNT, addSensor_sensorTypeChanged, app);
 
-    variable_item_set_current_value_index(app->item, app->currentSensorEdit->type);
-    variable_item_set_current_value_text(app->item, sensorsTypes[app->currentSensorEdit->type]);
+    variable_item_set_current_value_index(app->item, app->sensorEdit.type);
+    variable_item_set_current_value_text(app->item, DHT_getDriver(app->sensorEdit.type)->name);
 
     //GPIO
     app->item =
         variable_item_list_add(variable_item_list, "GPIO:", 13, addSensor_GPIOChanged, app);
     variable_item_set_current_value_index(
-        app->item, DHTMon_GPIO_to_index(app->currentSensorEdit->GPIO));
+        app->item, DHTMon_GPIO_to_index(app->sensorEdit.GPIO));
     variable_item_set_current_value_text(
-        app->item, DHTMon_GPIO_getName(app->currentSensorEdit->GPIO));
+        app->item, DHTMon_GPIO_getName(app->sensorEdit.GPIO));
+
+    //Интервал опроса. Интервал из файла, которого нет в меню, становится последним вариантом
+    uint8_t intervalIndex = INTERVALS_COUNT;
+    for(uint8_t i = 0; i < INTERVALS_COUNT; i++) {
+        if(intervalsValues[i] * 1000 == app->sensorEdit.pollingInterval) intervalIndex = i;
+    }
+    customInterval = intervalIndex == INTERVALS_COUNT ? app->sensorEdit.pollingInterval : 0;
+    app->item = variable_item_list_add(
+        variable_item_list,
+        "Interval:",
+        INTERVALS_COUNT + (customInterval != 0),
+        addSensor_intervalChanged,
+        app);
+    variable_item_set_current_value_index(app->item, intervalIndex);
+    addSensor_intervalText(app->item, intervalIndex);
+
+    //Пороги тревог. Порог не из целых значений в пределах меню тоже становится последним вариантом
+    customMask = 0;
+    for(uint8_t alarm = 0; alarm < DHT_ALARMS_COUNT; alarm++) {
+        int16_t min = addSensor_thresholdMin(alarm);
+        uint8_t custom = addSensor_thresholdCustom(alarm);
+        uint8_t index = 0;
+        if(app->sensorEdit.thresholds.enabled & (1 << alarm)) {
+            int16_t limit = app->sensorEdit.thresholds.limit[alarm];
+            if(limit % 10 == 0 && limit / 10 >= min && limit / 10 - min + 1 < custom) {
+                index = limit / 10 - min + 1;
+            } else {
+                index = custom;
+                customLimits[alarm] = limit;
+                customMask |= 1 << alarm;
+            }
+        }
+        app->item = variable_item_list_add(
+            variable_item_list,
+            thresholdsNames[alarm],
+            custom + ((customMask >> alarm) & 1),
+            thresholdsCallbacks[alarm],
+            app);
+        variable_item_set_current_value_index(app->item, index);
+        addSensor_thresholdText(app->item, alarm, index);
+    }
     variable_item_list_add(variable_item_list, "Save", 1, NULL, app);
 
     //Сброс выбранного пункта в ноль